@@ -0,0 +1,26 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "alloc.h"
+
+typedef struct arena_chunk_s arena_chunk_t;
+
+typedef struct arena_s {
+	arena_chunk_t *first;
+	arena_chunk_t *cur;
+	size_t chunk_size;
+	size_t used;
+	alloc_t alloc;
+} arena_t;
+
+arena_t *arena_init(arena_t *arena, size_t chunk_size, alloc_t alloc);
+void arena_free(arena_t *arena);
+
+void arena_reset(arena_t *arena);
+
+void *arena_alloc(arena_t *arena, size_t size);
+
+// Allocates from the arena, frees are no-ops, everything is released by arena_reset or arena_free
+alloc_t arena_to_alloc(arena_t *arena);
+
+#endif
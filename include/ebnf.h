@@ -10,6 +10,8 @@ typedef struct ebnf_s {
 	stx_node_t ebnf;
 	stx_node_t rules;
 	stx_node_t rule;
+	stx_node_t attrs;
+	stx_node_t attr;
 	stx_node_t rname;
 	stx_node_t alt;
 	stx_node_t concat;
@@ -20,6 +22,16 @@ typedef struct ebnf_s {
 	stx_node_t tdouble;
 	stx_node_t tsingle;
 	stx_node_t group;
+	stx_node_t set;
+	stx_node_t sitems;
+	stx_node_t sitem;
+	stx_node_t srange;
+	stx_node_t schar;
+	stx_node_t list;
+	stx_node_t lsep;
+	stx_node_t lmin;
+	stx_node_t lkeep;
+	stx_node_t cut;
 	stx_node_t opt;
 	stx_node_t rep;
 	stx_node_t opt_rep;
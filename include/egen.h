@@ -0,0 +1,9 @@
+#ifndef EGEN_H
+#define EGEN_H
+
+#include "estx.h"
+
+size_t egen_c(const estx_t *estx, estx_node_t rule, strv_t name, dst_t dst);
+size_t egen_estx(const estx_t *estx, strv_t name, alloc_t alloc, dst_t dst);
+
+#endif
@@ -7,28 +7,124 @@
 
 typedef tree_node_t eprs_node_t;
 
-typedef struct eprs_s {
+typedef struct eprs_err_s {
+	estx_node_t rule;
+	uint tok;
+	estx_node_t exp;
+} eprs_err_t;
+
+typedef struct eprs_edit_s {
+	uint start;
+	uint old_len;
+	uint new_len;
+} eprs_edit_t;
+
+typedef struct eprs_s eprs_t;
+typedef struct eprs_piece_s eprs_piece_t;
+typedef struct eprs_memo_s eprs_memo_t;
+typedef struct eprs_chr_s eprs_chr_t;
+typedef struct eprs_frame_s eprs_frame_t;
+
+typedef enum eprs_event_type_e {
+	EPRS_EVENT_ENTER,
+	EPRS_EVENT_EXIT,
+	EPRS_EVENT_TOKEN,
+	EPRS_EVENT_LITERAL,
+	EPRS_EVENT_OP,
+} eprs_event_type_t;
+
+typedef struct eprs_event_s {
+	eprs_event_type_t type;
+	estx_node_t id;
+	tok_t tok;
+} eprs_event_t;
+
+typedef int (*eprs_event_cb)(const eprs_t *eprs, eprs_event_t event, void *priv);
+
+typedef void (*eprs_split_run_fn)(eprs_piece_t *pieces, uint cnt, void *priv);
+
+struct eprs_s {
 	const estx_t *estx;
 	const lex_t *lex;
 	tree_t nodes;
-} eprs_t;
+	eprs_piece_t *pieces;
+	uint pieces_cnt;
+	eprs_split_run_fn run;
+	void *priv;
+	const tree_t *prev;
+	eprs_edit_t edit;
+	eprs_memo_t *memo;
+	uint memo_cap;
+	uint memo_cnt;
+	uint memo_kept;
+	uint memo_gen;
+	uint memo_serial;
+	tree_t memo_nodes;
+	uint memo_hits;
+	uint memo_stores;
+	eprs_chr_t *chrs;
+	uint chrs_cap;
+	uint chrs_cnt;
+	const estx_t *chrs_estx;
+	const uint *chrs_chars;
+	eprs_frame_t *frame;
+	uint choices;
+	uint choices_open;
+	uint choice_off;
+	uint rule_choices;
+	eprs_event_cb event;
+	void *event_priv;
+	int event_err;
+	int recognize;
+	int guided;
+};
+
+struct eprs_piece_s {
+	eprs_t eprs;
+	estx_node_t rule;
+	uint start;
+	uint end;
+	uint off;
+	uint look;
+	eprs_node_t root;
+	eprs_err_t err;
+	int failed;
+	int cut;
+};
 
 eprs_t *eprs_init(eprs_t *eprs, uint nodes_cap, alloc_t alloc);
 void eprs_free(eprs_t *eprs);
 
 void eprs_reset(eprs_t *eprs, uint cnt);
 
+void eprs_set_split(eprs_t *eprs, eprs_piece_t *pieces, uint pieces_cnt, eprs_split_run_fn run, void *priv);
+
 int eprs_node_rule(eprs_t *eprs, estx_node_t rule, eprs_node_t *node);
 int eprs_node_tok(eprs_t *eprs, tok_t tok, eprs_node_t *node);
 int eprs_node_lit(eprs_t *eprs, size_t start, uint len, eprs_node_t *node);
+int eprs_node_op(eprs_t *eprs, estx_node_t op, size_t start, uint len, eprs_node_t *node);
 
 int eprs_add_node(eprs_t *eprs, eprs_node_t parent, eprs_node_t node);
 int eprs_remove_node(eprs_t *eprs, eprs_node_t node);
 
+int eprs_set_span(eprs_t *eprs, eprs_node_t node, uint start, uint len);
+
 int eprs_get_rule(const eprs_t *eprs, eprs_node_t parent, estx_node_t rule, eprs_node_t *node);
+int eprs_get_node_rule(const eprs_t *eprs, eprs_node_t node, estx_node_t *rule);
 int eprs_get_str(const eprs_t *eprs, eprs_node_t parent, tok_t *out);
+int eprs_get_op(const eprs_t *eprs, eprs_node_t node, estx_node_t *op);
 
 int eprs_parse(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_node_t *root, dst_t dst);
+int eprs_reparse(eprs_t *eprs, const lex_t *lex, estx_node_t rule, eprs_edit_t edit, eprs_node_t *root, dst_t dst);
+int eprs_recognize(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, dst_t dst);
+int eprs_parse_two_phase(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_node_t *root, dst_t dst);
+int eprs_parse_events(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_event_cb cb, void *priv, dst_t dst);
+int eprs_parse_errs(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_err_t *errs, uint errs_cap, uint *errs_cnt,
+		    dst_t dst);
+
+int eprs_parse_piece(eprs_piece_t *piece);
+
+size_t eprs_print_err(const eprs_t *eprs, eprs_err_t err, dst_t dst);
 
 size_t eprs_print(const eprs_t *eprs, eprs_node_t node, dst_t dst);
 
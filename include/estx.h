@@ -16,6 +16,11 @@ typedef enum estx_node_type_e {
 	ESTX_TERM_ALT,
 	ESTX_TERM_CON,
 	ESTX_TERM_GROUP,
+	ESTX_TERM_EXPR,
+	ESTX_TERM_CUT,
+	ESTX_OP,
+	ESTX_TERM_SET,
+	ESTX_TERM_LIST,
 } estx_node_type_t;
 
 typedef enum estx_node_occ_e {
@@ -24,45 +29,118 @@ typedef enum estx_node_occ_e {
 	ESTX_TERM_OCC_REP = 1 << 1,
 } estx_node_occ_t;
 
+typedef enum estx_op_type_e {
+	ESTX_OP_PREFIX,
+	ESTX_OP_LEFT,
+	ESTX_OP_RIGHT,
+} estx_op_type_t;
+
+typedef enum estx_rule_flag_e {
+	ESTX_RULE_FLAG_NONE   = 0,
+	ESTX_RULE_FLAG_SPLIT  = 1 << 0,
+	ESTX_RULE_FLAG_LEX    = 1 << 1,
+	ESTX_RULE_FLAG_INLINE = 1 << 2,
+} estx_rule_flag_t;
+
 typedef struct estx_term_data_s {
 	estx_node_type_t type;
 	estx_node_occ_t occ;
+	estx_rule_flag_t flags;
 	union {
 		size_t name;
 		estx_node_t rule;
 		tok_type_t tok;
 		size_t lit;
+		size_t set;
 		estx_node_t terms;
+		struct {
+			estx_node_t rule;
+			estx_node_t ops;
+		} expr;
+		struct {
+			size_t lit;
+			uint prec;
+			estx_op_type_t type;
+		} op;
+		struct {
+			estx_node_t terms;
+			uint min;
+			int keep;
+		} list;
 	} val;
 } estx_node_data_t;
 
+typedef struct estx_toks_s {
+	uint types;
+	uint chars[8];
+} estx_toks_t;
+
+typedef struct estx_info_s {
+	estx_node_t rule;
+	estx_toks_t first;
+	estx_toks_t follow;
+	estx_node_t exp_rule;
+	estx_node_t exp;
+	byte nullable : 1;
+	byte empty : 1;
+	byte cut : 1;
+	byte has_exp : 1;
+	byte left_rec : 1;
+	byte reachable : 1;
+} estx_info_t;
+
 typedef struct estx_s {
 	list_t nodes;
 	strvbuf_t strs;
+	estx_node_t *rules;
+	uint rules_cap;
+	uint rules_cnt;
+	estx_info_t *infos;
+	uint infos_cnt;
 } estx_t;
 
 estx_t *estx_init(estx_t *estx, uint nodes_cap, alloc_t alloc);
 void estx_free(estx_t *estx);
 
 int estx_rule(estx_t *estx, strv_t name, estx_node_t *rule);
+int estx_rule_set_flags(estx_t *estx, estx_node_t rule, estx_rule_flag_t flags);
 int estx_term_rule(estx_t *estx, estx_node_t rule, estx_node_occ_t occ, estx_node_t *term);
 int estx_term_tok(estx_t *estx, tok_type_t tok, estx_node_occ_t occ, estx_node_t *term);
 int estx_term_lit(estx_t *estx, strv_t str, estx_node_occ_t occ, estx_node_t *term);
 int estx_term_alt(estx_t *estx, estx_node_t terms, estx_node_t *term);
 int estx_term_con(estx_t *estx, estx_node_t terms, estx_node_t *term);
 int estx_term_group(estx_t *estx, estx_node_t terms, estx_node_occ_t occ, estx_node_t *term);
+int estx_term_expr(estx_t *estx, estx_node_t rule, estx_node_t ops, estx_node_occ_t occ, estx_node_t *term);
+int estx_term_cut(estx_t *estx, estx_node_t *term);
+int estx_term_set(estx_t *estx, const tok_set_t *set, estx_node_occ_t occ, estx_node_t *term);
+int estx_term_list(estx_t *estx, estx_node_t elem, estx_node_t sep, uint min, int keep, estx_node_occ_t occ, estx_node_t *term);
+
+int estx_op(estx_t *estx, strv_t str, estx_op_type_t type, uint prec, estx_node_t *op);
 
 int estx_find_rule(estx_t *estx, strv_t name, estx_node_t *rule);
 
 estx_node_data_t *estx_get_node(const estx_t *estx, estx_node_t node);
 
 strv_t estx_data_lit(const estx_t *estx, const estx_node_data_t *data);
+const tok_set_t *estx_data_set(const estx_t *estx, const estx_node_data_t *data);
 
 int estx_add_term(estx_t *estx, estx_node_t node, estx_node_t term);
 
 size_t estx_print(const estx_t *estx, dst_t dst);
 size_t estx_print_tree(const estx_t *estx, dst_t dst);
 
+int estx_analyze(estx_t *estx, estx_node_t root, dst_t dst);
+const estx_info_t *estx_get_info(const estx_t *estx, estx_node_t node);
+
+int estx_toks_has(const estx_toks_t *toks, tok_t tok, strv_t val);
+size_t estx_toks_print(const estx_toks_t *toks, dst_t dst);
+size_t estx_print_info(const estx_t *estx, dst_t dst);
+
+int estx_optimize(estx_t *estx);
+
+size_t estx_save(const estx_t *estx, void *buf, size_t size);
+int estx_load(estx_t *estx, const void *data, size_t size);
+
 #define estx_node_foreach     list_foreach
 #define estx_node_foreach_all list_foreach_all
 
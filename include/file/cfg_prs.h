@@ -4,6 +4,14 @@
 #include "cfg.h"
 #include "eprs.h"
 
+#define CFG_PRS_PIECES 8
+
+typedef struct cfg_prs_ctx_s {
+	lex_t lex;
+	eprs_t eprs;
+	eprs_piece_t pieces[CFG_PRS_PIECES];
+} cfg_prs_ctx_t;
+
 typedef struct cfg_prs_s {
 	estx_t estx;
 	estx_node_t file;
@@ -22,13 +30,21 @@ typedef struct cfg_prs_s {
 	estx_node_t tbl;
 	estx_node_t name;
 	estx_node_t ent;
-	lex_t lex;
-	eprs_t eprs;
+	cfg_prs_ctx_t ctx;
 } cfg_prs_t;
 
+estx_t *cfg_prs_estx(estx_t *estx, alloc_t alloc);
+
 cfg_prs_t *cfg_prs_init(cfg_prs_t *cfg_prs, alloc_t alloc);
 void cfg_prs_free(cfg_prs_t *cfg_prs);
 
+cfg_prs_ctx_t *cfg_prs_ctx_init(cfg_prs_ctx_t *ctx, alloc_t alloc);
+void cfg_prs_ctx_free(cfg_prs_ctx_t *ctx);
+
+void cfg_prs_ctx_set_split(cfg_prs_ctx_t *ctx, uint pieces_cnt, eprs_split_run_fn run, void *priv);
+
 int cfg_prs_parse(cfg_prs_t *cfg_prs, strv_t str, cfg_t *cfg, cfg_var_t *root, dst_t dst);
+int cfg_prs_parse_ctx(const cfg_prs_t *cfg_prs, cfg_prs_ctx_t *ctx, strv_t str, cfg_t *cfg, cfg_var_t *root, dst_t dst);
+int cfg_prs_parse_batch(const cfg_prs_t *cfg_prs, cfg_prs_ctx_t *ctx, const strv_t *strs, uint cnt, cfg_t *cfgs, cfg_var_t *roots, dst_t dst);
 
 #endif
@@ -16,6 +16,7 @@ typedef struct prs_diag_s {
 	uint term_tok_calls;
 	uint term_lit_calls;
 	uint term_or_calls;
+	uint term_set_calls;
 	uint backtracks;
 	uint max_off;
 	uint memo_hits;
@@ -31,8 +32,15 @@ typedef struct prs_s {
 	size_t parse_fail_size;
 	uint parse_fail_stride;
 	size_t parse_fail_bits;
+	uint *parse_fail_gens;
+	size_t parse_fail_blocks;
+	uint parse_fail_gen;
+	int recognize;
+	int guided;
 } prs_t;
 
+typedef void (*prs_batch_cb)(const prs_t *prs, uint index, int ret, prs_node_t root, void *priv);
+
 prs_t *prs_init(prs_t *prs, uint nodes_cap, alloc_t alloc);
 void prs_free(prs_t *prs);
 
@@ -49,6 +57,10 @@ int prs_get_rule(const prs_t *prs, prs_node_t parent, stx_node_t rule, prs_node_
 int prs_get_str(const prs_t *prs, prs_node_t parent, tok_t *out);
 
 int prs_parse(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, dst_t dst);
+int prs_recognize(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, dst_t dst);
+int prs_parse_two_phase(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, dst_t dst);
+int prs_parse_batch(prs_t *prs, lex_t *lex, const stx_t *stx, stx_node_t rule, const strv_t *srcs, uint srcs_cnt, prs_batch_cb cb, void *priv,
+		    dst_t dst);
 
 size_t prs_print(const prs_t *prs, prs_node_t node, dst_t dst);
 
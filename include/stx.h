@@ -14,6 +14,7 @@ typedef enum stx_node_type_e {
 	STX_TERM_TOK,
 	STX_TERM_LIT,
 	STX_TERM_OR,
+	STX_TERM_SET,
 } stx_node_type_t;
 
 typedef struct stx_node_data_s {
@@ -23,6 +24,7 @@ typedef struct stx_node_data_s {
 		stx_node_t rule;
 		tok_type_t tok;
 		size_t lit;
+		size_t set;
 		struct {
 			stx_node_t l;
 			stx_node_t r;
@@ -33,6 +35,9 @@ typedef struct stx_node_data_s {
 typedef struct stx_s {
 	list_t nodes;
 	strvbuf_t strs;
+	stx_node_t *rules;
+	uint rules_cap;
+	uint rules_cnt;
 } stx_t;
 
 stx_t *stx_init(stx_t *stx, uint nodes_cap, alloc_t alloc);
@@ -43,12 +48,14 @@ int stx_term_rule(stx_t *stx, stx_node_t rule, stx_node_t *term);
 int stx_term_tok(stx_t *stx, tok_type_t tok, stx_node_t *term);
 int stx_term_lit(stx_t *stx, strv_t str, stx_node_t *term);
 int stx_term_or(stx_t *stx, stx_node_t l, stx_node_t r, stx_node_t *term);
+int stx_term_set(stx_t *stx, const tok_set_t *set, stx_node_t *term);
 
 int stx_find_rule(stx_t *stx, strv_t name, stx_node_t *rule);
 
 stx_node_data_t *stx_get_node(const stx_t *stx, stx_node_t node);
 
 strv_t stx_data_lit(const stx_t *stx, const stx_node_data_t *data);
+const tok_set_t *stx_data_set(const stx_t *stx, const stx_node_data_t *data);
 
 int stx_add_term(stx_t *stx, stx_node_t node, stx_node_t term);
 
@@ -59,6 +66,9 @@ int stx_rule_add_arr_sep(stx_t *stx, stx_node_t rule, stx_node_t term, stx_node_
 size_t stx_print(const stx_t *stx, dst_t dst);
 size_t stx_print_tree(const stx_t *stx, dst_t dst);
 
+size_t stx_save(const stx_t *stx, void *buf, size_t size);
+int stx_load(stx_t *stx, const void *data, size_t size);
+
 #define stx_node_foreach     list_foreach
 #define stx_node_foreach_all list_foreach_all
 
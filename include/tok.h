@@ -30,6 +30,10 @@ typedef struct tok_s {
 	size_t start;
 } tok_t;
 
+typedef struct tok_set_s {
+	byte bits[32];
+} tok_set_t;
+
 typedef struct tok_loc_s {
 	uint line_off;
 	uint line_len;
@@ -40,4 +44,8 @@ typedef struct tok_loc_s {
 size_t tok_type_print(uint type, dst_t dst);
 tok_type_t tok_type_enum(strv_t str);
 
+void tok_set_add(tok_set_t *set, byte from, byte to);
+int tok_set_has(const tok_set_t *set, byte c);
+size_t tok_set_print(const tok_set_t *set, dst_t dst);
+
 #endif
@@ -0,0 +1,154 @@
+#include "arena.h"
+
+#include "log.h"
+#include "mem.h"
+
+#define ARENA_ALIGN 16
+#define ARENA_ALIGN_UP(_size) (((_size) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))
+
+struct arena_chunk_s {
+	arena_chunk_t *next;
+	size_t size;
+};
+
+#define ARENA_CHUNK_HDR ARENA_ALIGN_UP(sizeof(arena_chunk_t))
+
+arena_t *arena_init(arena_t *arena, size_t chunk_size, alloc_t alloc)
+{
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	arena->first	  = NULL;
+	arena->cur	  = NULL;
+	arena->chunk_size = ARENA_ALIGN_UP(chunk_size);
+	arena->used	  = 0;
+	arena->alloc	  = alloc;
+
+	return arena;
+}
+
+void arena_free(arena_t *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	arena_chunk_t *chunk = arena->first;
+	while (chunk) {
+		arena_chunk_t *next = chunk->next;
+		alloc_free(&arena->alloc, chunk, ARENA_CHUNK_HDR + chunk->size);
+		chunk = next;
+	}
+
+	arena->first = NULL;
+	arena->cur   = NULL;
+	arena->used  = 0;
+}
+
+void arena_reset(arena_t *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	// chunks are kept and refilled from the first one
+	arena->cur  = arena->first;
+	arena->used = 0;
+}
+
+static arena_chunk_t *arena_chunk(arena_t *arena, size_t size)
+{
+	// reuse the next kept chunk if it is large enough, otherwise insert a new one before it
+	arena_chunk_t *next = arena->cur ? arena->cur->next : arena->first;
+	if (next && next->size >= size) {
+		return next;
+	}
+
+	if (size < arena->chunk_size) {
+		size = arena->chunk_size;
+	}
+
+	arena_chunk_t *chunk = alloc_alloc(&arena->alloc, ARENA_CHUNK_HDR + size);
+	if (chunk == NULL) {
+		log_error("cparse", "arena", NULL, "failed to allocate chunk");
+		return NULL;
+	}
+
+	chunk->next = next;
+	chunk->size = size;
+
+	if (arena->cur) {
+		arena->cur->next = chunk;
+	} else {
+		arena->first = chunk;
+	}
+
+	return chunk;
+}
+
+void *arena_alloc(arena_t *arena, size_t size)
+{
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	size = ARENA_ALIGN_UP(size);
+
+	if (arena->cur == NULL || arena->used + size > arena->cur->size) {
+		arena_chunk_t *chunk = arena_chunk(arena, size);
+		if (chunk == NULL) {
+			return NULL;
+		}
+
+		arena->cur  = chunk;
+		arena->used = 0;
+	}
+
+	void *ptr = (byte *)arena->cur + ARENA_CHUNK_HDR + arena->used;
+	arena->used += size;
+
+	return ptr;
+}
+
+static void *arena_alloc_alloc(alloc_t *alloc, size_t size)
+{
+	return arena_alloc(alloc->priv, size);
+}
+
+static void *arena_alloc_realloc(alloc_t *alloc, void *ptr, size_t old_size, size_t new_size)
+{
+	arena_t *arena = alloc->priv;
+
+	// the last allocation grows in place while its chunk has room
+	size_t old_used = ARENA_ALIGN_UP(old_size);
+	if (ptr && arena && arena->cur && (byte *)ptr + old_used == (byte *)arena->cur + ARENA_CHUNK_HDR + arena->used &&
+	    arena->used - old_used + ARENA_ALIGN_UP(new_size) <= arena->cur->size) {
+		arena->used = arena->used - old_used + ARENA_ALIGN_UP(new_size);
+		return ptr;
+	}
+
+	void *data = arena_alloc(arena, new_size);
+	if (data && ptr) {
+		mem_cpy(data, new_size, ptr, old_size < new_size ? old_size : new_size);
+	}
+
+	return data;
+}
+
+static void arena_alloc_free(alloc_t *alloc, void *ptr, size_t size)
+{
+	(void)alloc;
+	(void)ptr;
+	(void)size;
+}
+
+alloc_t arena_to_alloc(arena_t *arena)
+{
+	return (alloc_t){
+		.alloc	 = arena_alloc_alloc,
+		.realloc = arena_alloc_realloc,
+		.free	 = arena_alloc_free,
+		.priv	 = arena,
+	};
+}
@@ -37,7 +37,9 @@ const stx_t *ebnf_get_stx(ebnf_t *ebnf, alloc_t alloc, dst_t dst)
 	strv_t sbnf = STRV("<file>    ::= <ebnf> EOF\n"
 			   "<ebnf>    ::= <rules>\n"
 			   "<rules>   ::= <rule> <rules> | <rule>\n"
-			   "<rule>    ::= <rname> <spaces> '=' <space> <alt> NL\n"
+			   "<rule>    ::= <attrs> <rname> <spaces> '=' <space> <alt> NL | <rname> <spaces> '=' <space> <alt> NL\n"
+			   "<attrs>   ::= <attr> <attrs> | <attr>\n"
+			   "<attr>    ::= '@' <rname> <space>\n"
 			   "<rname>   ::= LOWER <rchars> | LOWER\n"
 			   "<rchars>  ::= <rchar> <rchars> | <rchar>\n"
 			   "<rchar>   ::= LOWER | '_'\n"
@@ -47,10 +49,22 @@ const stx_t *ebnf_get_stx(ebnf_t *ebnf, alloc_t alloc, dst_t dst)
 			   "<opt>     ::= '?'\n"
 			   "<rep>     ::= '+'\n"
 			   "<opt-rep> ::= '*'\n"
-			   "<term>    ::= <literal> | <token> | <rname> | <group>\n"
+			   "<term>    ::= <literal> | <token> | <list> | <rname> | <group> | <set> | <cut>\n"
 			   "<literal> ::= \"'\" <tdouble> \"'\" | '\"' <tsingle> '\"'\n"
 			   "<token>   ::= UPPER <token> | UPPER\n"
 			   "<group>   ::= '(' <alt> ')'\n"
+			   "<list>    ::= 'list(' <alt> ', ' <lsep> ', ' <lmin> <lkeep> ')' | 'list(' <alt> ', ' <lsep> ', ' <lmin> ')'\n"
+			   "<lsep>    ::= <alt>\n"
+			   "<lmin>    ::= DIGIT <lmin> | DIGIT\n"
+			   "<lkeep>   ::= ', keep'\n"
+			   "<set>     ::= '[' <sitems> ']'\n"
+			   "<sitems>  ::= <sitem> <sitems> | <sitem>\n"
+			   "<sitem>   ::= <schar> <srange> | <schar>\n"
+			   "<srange>  ::= '-' <schar>\n"
+			   "<schar>   ::= '\\' SYMBOL | ALPHA | DIGIT | QUOTE | ' ' | <ssym>\n"
+			   "<ssym>    ::= '!' | '#' | '$' | '%' | '&' | '(' | ')' | '*' | '+' | ',' | '-' | '.' | '/' | ':' | ';' | '<' | '=' | '>'"
+			   " | '?' | '@' | '[' | '^' | '_' | '`' | '{' | '|' | '}' | '~'\n"
+			   "<cut>     ::= '~'\n"
 			   "<tdouble> ::= <cdouble> <tdouble> | <cdouble>\n"
 			   "<tsingle> ::= <csingle> <tsingle> | <csingle>\n"
 			   "<cdouble> ::= <char> | '\"'\n"
@@ -86,6 +100,8 @@ const stx_t *ebnf_get_stx(ebnf_t *ebnf, alloc_t alloc, dst_t dst)
 	stx_find_rule(&ebnf->stx, STRV("ebnf"), &ebnf->ebnf);
 	stx_find_rule(&ebnf->stx, STRV("rules"), &ebnf->rules);
 	stx_find_rule(&ebnf->stx, STRV("rule"), &ebnf->rule);
+	stx_find_rule(&ebnf->stx, STRV("attrs"), &ebnf->attrs);
+	stx_find_rule(&ebnf->stx, STRV("attr"), &ebnf->attr);
 	stx_find_rule(&ebnf->stx, STRV("rname"), &ebnf->rname);
 	stx_find_rule(&ebnf->stx, STRV("alt"), &ebnf->alt);
 	stx_find_rule(&ebnf->stx, STRV("concat"), &ebnf->concat);
@@ -96,6 +112,16 @@ const stx_t *ebnf_get_stx(ebnf_t *ebnf, alloc_t alloc, dst_t dst)
 	stx_find_rule(&ebnf->stx, STRV("tsingle"), &ebnf->tsingle);
 	stx_find_rule(&ebnf->stx, STRV("token"), &ebnf->tok);
 	stx_find_rule(&ebnf->stx, STRV("group"), &ebnf->group);
+	stx_find_rule(&ebnf->stx, STRV("set"), &ebnf->set);
+	stx_find_rule(&ebnf->stx, STRV("sitems"), &ebnf->sitems);
+	stx_find_rule(&ebnf->stx, STRV("sitem"), &ebnf->sitem);
+	stx_find_rule(&ebnf->stx, STRV("srange"), &ebnf->srange);
+	stx_find_rule(&ebnf->stx, STRV("schar"), &ebnf->schar);
+	stx_find_rule(&ebnf->stx, STRV("list"), &ebnf->list);
+	stx_find_rule(&ebnf->stx, STRV("lsep"), &ebnf->lsep);
+	stx_find_rule(&ebnf->stx, STRV("lmin"), &ebnf->lmin);
+	stx_find_rule(&ebnf->stx, STRV("lkeep"), &ebnf->lkeep);
+	stx_find_rule(&ebnf->stx, STRV("cut"), &ebnf->cut);
 	stx_find_rule(&ebnf->stx, STRV("opt"), &ebnf->opt);
 	stx_find_rule(&ebnf->stx, STRV("rep"), &ebnf->rep);
 	stx_find_rule(&ebnf->stx, STRV("opt-rep"), &ebnf->opt_rep);
@@ -108,6 +134,47 @@ const stx_t *ebnf_get_stx(ebnf_t *ebnf, alloc_t alloc, dst_t dst)
 
 static int alt_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, estx_t *estx, int is_alt, estx_node_t *term);
 
+// An escaped character is the last one of its string
+static byte schar_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node)
+{
+	prs_node_t prs_schar;
+	prs_get_rule(prs, node, ebnf->schar, &prs_schar);
+
+	tok_t str = {0};
+	prs_get_str(prs, prs_schar, &str);
+	strv_t val = lex_get_tok_val(prs->lex, str);
+
+	return (byte)val.data[val.len - 1];
+}
+
+static int set_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, tok_set_t *set)
+{
+	prs_node_t prs_sitem;
+	prs_get_rule(prs, node, ebnf->sitem, &prs_sitem);
+
+	byte from = schar_from_ebnf(ebnf, prs, prs_sitem);
+	byte to	  = from;
+
+	prs_node_t prs_srange;
+	if (prs_get_rule(prs, prs_sitem, ebnf->srange, &prs_srange) == 0) {
+		to = schar_from_ebnf(ebnf, prs, prs_srange);
+	}
+
+	if (from > to) {
+		log_error("cparse", "ebnf", NULL, "invalid set range: '%c-%c'", from, to);
+		return 1;
+	}
+
+	tok_set_add(set, from, to);
+
+	prs_node_t prs_sitems;
+	if (prs_get_rule(prs, node, ebnf->sitems, &prs_sitems)) {
+		return 0;
+	}
+
+	return set_from_ebnf(ebnf, prs, prs_sitems, set);
+}
+
 static int term_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, estx_t *estx, estx_node_occ_t occ, estx_node_t *term)
 {
 	prs_node_t prs_rname;
@@ -153,11 +220,51 @@ static int term_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node,
 		prs_get_rule(prs, prs_group, ebnf->alt, &prs_alt);
 
 		estx_node_t alt;
-		alt_from_ebnf(ebnf, prs, prs_alt, estx, 0, &alt);
+		if (alt_from_ebnf(ebnf, prs, prs_alt, estx, 0, &alt)) {
+			return 1;
+		}
 
 		return estx_term_group(estx, alt, occ, term);
 	}
 
+	prs_node_t prs_list;
+	if (prs_get_rule(prs, node, ebnf->list, &prs_list) == 0) {
+		prs_node_t prs_elem, prs_lsep, prs_sep, prs_lmin;
+		prs_get_rule(prs, prs_list, ebnf->alt, &prs_elem);
+		prs_get_rule(prs, prs_list, ebnf->lsep, &prs_lsep);
+		prs_get_rule(prs, prs_lsep, ebnf->alt, &prs_sep);
+		prs_get_rule(prs, prs_list, ebnf->lmin, &prs_lmin);
+
+		tok_t str = {0};
+		prs_get_str(prs, prs_lmin, &str);
+		int min = 0;
+		strv_to_int(lex_get_tok_val(prs->lex, str), &min);
+
+		estx_node_t elem, sep;
+		if (alt_from_ebnf(ebnf, prs, prs_elem, estx, 0, &elem) || alt_from_ebnf(ebnf, prs, prs_sep, estx, 0, &sep)) {
+			return 1;
+		}
+
+		return estx_term_list(estx, elem, sep, (uint)min, prs_get_rule(prs, prs_list, ebnf->lkeep, NULL) == 0, occ, term);
+	}
+
+	prs_node_t prs_set;
+	if (prs_get_rule(prs, node, ebnf->set, &prs_set) == 0) {
+		prs_node_t prs_sitems;
+		prs_get_rule(prs, prs_set, ebnf->sitems, &prs_sitems);
+
+		tok_set_t set = {0};
+		if (set_from_ebnf(ebnf, prs, prs_sitems, &set)) {
+			return 1;
+		}
+
+		return estx_term_set(estx, &set, occ, term);
+	}
+
+	if (prs_get_rule(prs, node, ebnf->cut, NULL) == 0) {
+		return estx_term_cut(estx, term);
+	}
+
 	return 1;
 }
 
@@ -191,7 +298,9 @@ static int concat_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t nod
 	if (prs_get_rule(prs, node, ebnf->concat, &prs_concat)) {
 		if (is_con) {
 			estx_node_t factor;
-			factor_from_ebnf(ebnf, prs, prs_factor, estx, &factor);
+			if (factor_from_ebnf(ebnf, prs, prs_factor, estx, &factor)) {
+				return 1;
+			}
 			return estx_add_term(estx, *term, factor);
 		} else {
 			return factor_from_ebnf(ebnf, prs, prs_factor, estx, term);
@@ -199,17 +308,20 @@ static int concat_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t nod
 	}
 
 	estx_node_t factor;
-	factor_from_ebnf(ebnf, prs, prs_factor, estx, &factor);
+	if (factor_from_ebnf(ebnf, prs, prs_factor, estx, &factor)) {
+		return 1;
+	}
 
 	if (is_con) {
 		estx_add_term(estx, *term, factor);
-		concat_from_ebnf(ebnf, prs, prs_concat, estx, 1, term);
-	} else {
-		concat_from_ebnf(ebnf, prs, prs_concat, estx, 1, &factor);
-		estx_term_con(estx, factor, term);
+		return concat_from_ebnf(ebnf, prs, prs_concat, estx, 1, term);
+	}
+
+	if (concat_from_ebnf(ebnf, prs, prs_concat, estx, 1, &factor)) {
+		return 1;
 	}
 
-	return 0;
+	return estx_term_con(estx, factor, term);
 }
 
 static int alt_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, estx_t *estx, int is_alt, estx_node_t *term)
@@ -221,7 +333,9 @@ static int alt_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node,
 	if (prs_get_rule(prs, node, ebnf->alt, &prs_alt)) {
 		if (is_alt) {
 			estx_node_t concat;
-			concat_from_ebnf(ebnf, prs, prs_concat, estx, 0, &concat);
+			if (concat_from_ebnf(ebnf, prs, prs_concat, estx, 0, &concat)) {
+				return 1;
+			}
 			return estx_add_term(estx, *term, concat);
 		} else {
 			return concat_from_ebnf(ebnf, prs, prs_concat, estx, 0, term);
@@ -229,17 +343,47 @@ static int alt_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node,
 	}
 
 	estx_node_t concat;
-	concat_from_ebnf(ebnf, prs, prs_concat, estx, 0, &concat);
+	if (concat_from_ebnf(ebnf, prs, prs_concat, estx, 0, &concat)) {
+		return 1;
+	}
 
 	if (is_alt) {
 		estx_add_term(estx, *term, concat);
-		alt_from_ebnf(ebnf, prs, prs_alt, estx, 1, term);
+		return alt_from_ebnf(ebnf, prs, prs_alt, estx, 1, term);
+	}
+
+	if (alt_from_ebnf(ebnf, prs, prs_alt, estx, 1, &concat)) {
+		return 1;
+	}
+
+	return estx_term_alt(estx, concat, term);
+}
+
+static int attrs_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, estx_t *estx, estx_node_t rule)
+{
+	prs_node_t prs_attr, prs_rname;
+	prs_get_rule(prs, node, ebnf->attr, &prs_attr);
+	prs_get_rule(prs, prs_attr, ebnf->rname, &prs_rname);
+
+	tok_t str = {0};
+	prs_get_str(prs, prs_rname, &str);
+	strv_t name = lex_get_tok_val(prs->lex, str);
+
+	if (strv_eq(name, STRV("lex"))) {
+		estx_rule_set_flags(estx, rule, ESTX_RULE_FLAG_LEX);
+	} else if (strv_eq(name, STRV("inline"))) {
+		estx_rule_set_flags(estx, rule, ESTX_RULE_FLAG_INLINE);
 	} else {
-		alt_from_ebnf(ebnf, prs, prs_alt, estx, 1, &concat);
-		estx_term_alt(estx, concat, term);
+		log_error("cparse", "ebnf", NULL, "unknown attribute: '%.*s'", name.len, name.data);
+		return 1;
+	}
+
+	prs_node_t attrs;
+	if (prs_get_rule(prs, node, ebnf->attrs, &attrs)) {
+		return 0;
 	}
 
-	return 0;
+	return attrs_from_ebnf(ebnf, prs, attrs, estx, rule);
 }
 
 static int rules_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node, estx_t *estx, estx_node_t *root)
@@ -257,10 +401,17 @@ static int rules_from_ebnf(const ebnf_t *ebnf, const prs_t *prs, prs_node_t node
 		estx_rule(estx, name, &rule);
 	}
 
+	prs_node_t prs_attrs;
+	if (prs_get_rule(prs, prs_rule, ebnf->attrs, &prs_attrs) == 0 && attrs_from_ebnf(ebnf, prs, prs_attrs, estx, rule)) {
+		return 1;
+	}
+
 	prs_node_t prs_alt;
 	prs_get_rule(prs, prs_rule, ebnf->alt, &prs_alt);
 	estx_node_t alt;
-	alt_from_ebnf(ebnf, prs, prs_alt, estx, 0, &alt);
+	if (alt_from_ebnf(ebnf, prs, prs_alt, estx, 0, &alt)) {
+		return 1;
+	}
 	estx_add_term(estx, rule, alt);
 
 	if (root) {
@@ -0,0 +1,660 @@
+#include "egen.h"
+
+#include "log.h"
+#include "mem.h"
+
+static size_t egen_name(strv_t name, dst_t dst)
+{
+	size_t off = dst.off;
+
+	for (size_t i = 0; i < name.len; i++) {
+		char c	= name.data[i];
+		int ok	= (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+		char id = ok ? c : '_';
+		dst.off += dputs(dst, STRVN(&id, 1));
+	}
+
+	return dst.off - off;
+}
+
+static size_t egen_rule_name(const estx_t *estx, strv_t name, estx_node_t rule, dst_t dst)
+{
+	size_t off = dst.off;
+
+	const estx_node_data_t *data = estx_get_node(estx, rule);
+	dst.off += dputf(dst, "%.*s_rule_", name.len, name.data);
+	dst.off += egen_name(strvbuf_get(&estx->strs, data->val.name), dst);
+
+	return dst.off - off;
+}
+
+static size_t egen_chr(char c, dst_t dst)
+{
+	if (c == '\'' || c == '\\') {
+		return dputf(dst, "'\\%c'", c);
+	}
+
+	if (c < ' ' || c > '~') {
+		return dputf(dst, "'\\x%02x'", (byte)c);
+	}
+
+	return dputf(dst, "'%c'", c);
+}
+
+// Terms which are not alternatives or concatenations and occur optionally or repeatedly are parsed by an occurrence function
+static int egen_occ(const estx_node_data_t *term)
+{
+	return term->type != ESTX_TERM_ALT && term->type != ESTX_TERM_CON && term->occ != ESTX_TERM_OCC_ONE;
+}
+
+static size_t egen_call(strv_t name, const estx_node_data_t *term, estx_node_t id, const char *cut, dst_t dst)
+{
+	return dputf(dst, "%.*s_%s_%d(eprs, off, node, %s)", name.len, name.data, egen_occ(term) ? "occ" : "term", id, cut);
+}
+
+static size_t egen_head(strv_t name, const char *kind, estx_node_t id, dst_t dst)
+{
+	return dputf(dst, "static int %.*s_%s_%d(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)\n{\n", name.len, name.data, kind, id);
+}
+
+// Mirrors the handling of optional and repeated terms in eprs_parse_terms
+static size_t egen_term_occ(const estx_node_data_t *term, strv_t name, estx_node_t id, dst_t dst)
+{
+	size_t off = dst.off;
+
+	dst.off += egen_head(name, "occ", id, dst);
+	dst.off += dputf(dst,
+			 "\t(void)cut;\n"
+			 "\tuint cur       = *off;\n"
+			 "\tuint nodes_cnt = eprs->nodes.cnt;\n"
+			 "\tint attempt    = 0;\n"
+			 "\n"
+			 "\tint ret = %.*s_term_%d(eprs, off, node, &attempt);\n"
+			 "\tif (ret && attempt) {\n"
+			 "\t\t*off = cur;\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n",
+			 name.len,
+			 name.data,
+			 id);
+
+	if ((term->occ & ESTX_TERM_OCC_OPT) && !(term->occ & ESTX_TERM_OCC_REP)) {
+		dst.off += dputs(dst,
+				 STRV("\tif (ret) {\n"
+				      "\t\t*off = cur;\n"
+				      "\t\treturn 0;\n"
+				      "\t}\n"
+				      "\n"));
+	} else if (!(term->occ & ESTX_TERM_OCC_OPT) && (term->occ & ESTX_TERM_OCC_REP)) {
+		dst.off += dputs(dst,
+				 STRV("\tif (ret) {\n"
+				      "\t\t*off = cur;\n"
+				      "\t\treturn 1;\n"
+				      "\t}\n"
+				      "\n"));
+	}
+
+	dst.off += dputf(dst,
+			 "\twhile (ret == 0) {\n"
+			 "\t\tif (cur == *off) {\n"
+			 "\t\t\tbreak;\n"
+			 "\t\t}\n"
+			 "\t\tcur     = *off;\n"
+			 "\t\tattempt = 0;\n"
+			 "\t\tret     = %.*s_term_%d(eprs, off, node, &attempt);\n"
+			 "\t\tif (ret && attempt) {\n"
+			 "\t\t\teprs_reset(eprs, nodes_cnt);\n"
+			 "\t\t\treturn 1;\n"
+			 "\t\t}\n"
+			 "\t}\n"
+			 "\n"
+			 "\t*off = cur;\n"
+			 "\treturn 0;\n"
+			 "}\n"
+			 "\n",
+			 name.len,
+			 name.data,
+			 id);
+
+	return dst.off - off;
+}
+
+// Children are generated before their parent, so that every term function is defined before it is called
+static size_t egen_term(const estx_t *estx, strv_t name, estx_node_t id, dst_t dst)
+{
+	size_t off = dst.off;
+
+	const estx_node_data_t *term = estx_get_node(estx, id);
+	const estx_node_data_t *data;
+	estx_node_t child;
+
+	if (term->type == ESTX_TERM_ALT || term->type == ESTX_TERM_CON || term->type == ESTX_TERM_GROUP || term->type == ESTX_TERM_LIST) {
+		child = term->val.terms;
+		estx_node_foreach(&estx->nodes, child, data)
+		{
+			dst.off += egen_term(estx, name, child, dst);
+		}
+	}
+
+	dst.off += egen_head(name, "term", id, dst);
+
+	switch (term->type) {
+	case ESTX_TERM_RULE:
+		if (estx_get_node(estx, term->val.rule)->flags & ESTX_RULE_FLAG_INLINE) {
+			// Inline rules add their children to the node of the calling rule, like in eprs_parse_inline
+			dst.off += dputs(dst,
+					 STRV("\t(void)cut;\n"
+					      "\tuint nodes_cnt = eprs->nodes.cnt;\n"
+					      "\tif ("));
+			dst.off += egen_rule_name(estx, name, term->val.rule, dst);
+			dst.off += dputs(dst,
+					 STRV("(eprs, off, node)) {\n"
+					      "\t\teprs_reset(eprs, nodes_cnt);\n"
+					      "\t\treturn 1;\n"
+					      "\t}\n"
+					      "\n"
+					      "\treturn 0;\n"));
+			break;
+		}
+
+		dst.off += dputf(dst,
+				 "\t(void)cut;\n"
+				 "\tuint nodes_cnt = eprs->nodes.cnt;\n"
+				 "\teprs_node_t child;\n"
+				 "\tif (eprs_node_rule(eprs, %d, &child) || ",
+				 term->val.rule);
+		dst.off += egen_rule_name(estx, name, term->val.rule, dst);
+		dst.off += dputs(dst,
+				 STRV("(eprs, off, child)) {\n"
+				      "\t\teprs_reset(eprs, nodes_cnt);\n"
+				      "\t\treturn 1;\n"
+				      "\t}\n"
+				      "\n"
+				      "\teprs_add_node(eprs, node, child);\n"
+				      "\treturn 0;\n"));
+		break;
+	case ESTX_TERM_TOK: {
+		char buf[32] = {0};
+		size_t len   = tok_type_print(1 << term->val.tok, DST_BUF(buf));
+		dst.off += dputf(dst, "\t(void)cut;\n\treturn %.*s_tok(eprs, off, node, TOK_%.*s);\n", name.len, name.data, (int)len, buf);
+		break;
+	}
+	case ESTX_TERM_LIT: {
+		strv_t literal = estx_data_lit(estx, term);
+		dst.off += dputs(dst, STRV("\t(void)cut;\n"));
+		if (literal.len > 0) {
+			dst.off += dputs(dst, STRV("\tif ("));
+			for (size_t i = 0; i < literal.len; i++) {
+				if (i > 0) {
+					dst.off += dputs(dst, STRV(" ||\n\t    "));
+				}
+				if (i == 0) {
+					dst.off += dputf(dst, "%.*s_chr(eprs->lex, *off, ", name.len, name.data);
+				} else {
+					dst.off += dputf(dst, "%.*s_chr(eprs->lex, *off + %d, ", name.len, name.data, (int)i);
+				}
+				dst.off += egen_chr(literal.data[i], dst);
+				dst.off += dputs(dst, STRV(")"));
+			}
+			dst.off += dputs(dst,
+					 STRV(") {\n"
+					      "\t\treturn 1;\n"
+					      "\t}\n"
+					      "\n"));
+		}
+		dst.off += dputf(dst, "\treturn %.*s_lit(eprs, off, node, %d);\n", name.len, name.data, (int)literal.len);
+		break;
+	}
+	case ESTX_TERM_SET: {
+		// The set is emitted as its bitmap, so a character is tested with a single lookup
+		const tok_set_t *set = estx_data_set(estx, term);
+		dst.off += dputs(dst, STRV("\t(void)cut;\n\tstatic const byte set[32] = {"));
+		for (size_t i = 0; i < sizeof(set->bits); i++) {
+			dst.off += dputf(dst, "%s0x%02x", i % 8 == 0 ? "\n\t\t" : " ", set->bits[i]);
+			if (i + 1 < sizeof(set->bits)) {
+				dst.off += dputs(dst, STRV(","));
+			}
+		}
+		dst.off += dputf(dst,
+				 "\n"
+				 "\t};\n"
+				 "\tif (%.*s_set(eprs->lex, *off, set)) {\n"
+				 "\t\treturn 1;\n"
+				 "\t}\n"
+				 "\n"
+				 "\treturn %.*s_lit(eprs, off, node, 1);\n",
+				 name.len,
+				 name.data,
+				 name.len,
+				 name.data);
+		break;
+	}
+	case ESTX_TERM_ALT: {
+		// Every alternative gets its own cut, a cut in a failed alternative fails the whole choice
+		dst.off += dputs(dst,
+				 STRV("\t(void)cut;\n"
+				      "\tuint cur       = *off;\n"
+				      "\tuint nodes_cnt = eprs->nodes.cnt;\n"
+				      "\tint alt;\n"));
+		child = term->val.terms;
+		estx_node_foreach(&estx->nodes, child, data)
+		{
+			dst.off += dputs(dst, STRV("\n\talt = 0;\n\tif ("));
+			dst.off += egen_call(name, data, child, "&alt", dst);
+			dst.off += dputs(dst,
+					 STRV(" == 0) {\n"
+					      "\t\treturn 0;\n"
+					      "\t}\n"
+					      "\teprs_reset(eprs, nodes_cnt);\n"
+					      "\t*off = cur;\n"));
+			if (list_get_next(&estx->nodes, child, NULL)) {
+				dst.off += dputs(dst,
+						 STRV("\tif (alt) {\n"
+						      "\t\treturn 1;\n"
+						      "\t}\n"));
+			}
+		}
+		dst.off += dputs(dst, STRV("\n\treturn 1;\n"));
+		break;
+	}
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP: {
+		// A failed term drops the nodes added by all terms before it, as eprs_parse_term does
+		dst.off += dputs(dst,
+				 STRV("\tuint cur       = *off;\n"
+				      "\tuint nodes_cnt = eprs->nodes.cnt;\n"));
+		child = term->val.terms;
+		estx_node_foreach(&estx->nodes, child, data)
+		{
+			dst.off += dputs(dst, STRV("\n\tif ("));
+			dst.off += egen_call(name, data, child, "cut", dst);
+			dst.off += dputs(dst,
+					 STRV(") {\n"
+					      "\t\teprs_reset(eprs, nodes_cnt);\n"
+					      "\t\t*off = cur;\n"
+					      "\t\treturn 1;\n"
+					      "\t}\n"));
+		}
+		dst.off += dputs(dst, STRV("\n\treturn 0;\n"));
+		break;
+	}
+	case ESTX_TERM_LIST: {
+		// Mirrors eprs_parse_list: a cut commits the attempt it is in, separators only get nodes when kept
+		estx_node_t elem = term->val.list.terms;
+		estx_node_t sep;
+		const estx_node_data_t *elem_data = estx_get_node(estx, elem);
+		const estx_node_data_t *sep_data  = list_get_next(&estx->nodes, elem, &sep);
+		dst.off += dputs(dst,
+				 STRV("\t(void)cut;\n"
+				      "\tuint cur       = *off;\n"
+				      "\tuint nodes_cnt = eprs->nodes.cnt;\n"
+				      "\tuint cnt       = 0;\n"
+				      "\n"
+				      "\tfor (;;) {\n"
+				      "\t\tuint at     = *off;\n"
+				      "\t\tuint at_cnt = eprs->nodes.cnt;\n"
+				      "\t\tint attempt = 0;\n"
+				      "\t\tint ret     = 0;\n"
+				      "\n"
+				      "\t\tif (cnt > 0) {\n"));
+		if (term->val.list.keep) {
+			dst.off += dputs(dst, STRV("\t\t\tret = "));
+			dst.off += egen_call(name, sep_data, sep, "&attempt", dst);
+			dst.off += dputs(dst, STRV(";\n"));
+		} else {
+			dst.off += dputs(dst,
+					 STRV("\t\t\tint recog       = eprs->recognize;\n"
+					      "\t\t\teprs->recognize = 1;\n"
+					      "\t\t\tret             = "));
+			dst.off += egen_call(name, sep_data, sep, "&attempt", dst);
+			dst.off += dputs(dst,
+					 STRV(";\n"
+					      "\t\t\teprs->recognize = recog;\n"));
+		}
+		dst.off += dputs(dst,
+				 STRV("\t\t}\n"
+				      "\t\tif (ret == 0) {\n"
+				      "\t\t\tret = "));
+		dst.off += egen_call(name, elem_data, elem, "&attempt", dst);
+		dst.off += dputs(dst,
+				 STRV(";\n"
+				      "\t\t}\n"
+				      "\n"
+				      "\t\tif (ret) {\n"
+				      "\t\t\teprs_reset(eprs, at_cnt);\n"
+				      "\t\t\t*off = at;\n"
+				      "\t\t\tif (attempt) {\n"
+				      "\t\t\t\teprs_reset(eprs, nodes_cnt);\n"
+				      "\t\t\t\t*off = cur;\n"
+				      "\t\t\t\treturn 1;\n"
+				      "\t\t\t}\n"
+				      "\t\t\tbreak;\n"
+				      "\t\t}\n"
+				      "\n"
+				      "\t\tif (cnt++ > 0 && *off == at) {\n"
+				      "\t\t\tbreak;\n"
+				      "\t\t}\n"
+				      "\t}\n"
+				      "\n"));
+		if (term->val.list.min > 0) {
+			dst.off += dputf(dst,
+					 "\tif (cnt < %d) {\n"
+					 "\t\teprs_reset(eprs, nodes_cnt);\n"
+					 "\t\t*off = cur;\n"
+					 "\t\treturn 1;\n"
+					 "\t}\n"
+					 "\n",
+					 term->val.list.min);
+		}
+		dst.off += dputs(dst, STRV("\treturn 0;\n"));
+		break;
+	}
+	case ESTX_TERM_CUT:
+		dst.off += dputs(dst,
+				 STRV("\t(void)eprs;\n"
+				      "\t(void)off;\n"
+				      "\t(void)node;\n"
+				      "\t*cut = 1;\n"
+				      "\treturn 0;\n"));
+		break;
+	default: dst.off += dputs(dst, STRV("\t(void)cut;\n\treturn 1;\n")); break;
+	}
+
+	dst.off += dputs(dst, STRV("}\n\n"));
+
+	if (egen_occ(term)) {
+		dst.off += egen_term_occ(term, name, id, dst);
+	}
+
+	return dst.off - off;
+}
+
+static size_t egen_rule(const estx_t *estx, strv_t name, estx_node_t rule, dst_t dst)
+{
+	size_t off = dst.off;
+
+	estx_node_t body;
+	const estx_node_data_t *term = list_get_next(&estx->nodes, rule, &body);
+	if (term) {
+		dst.off += egen_term(estx, name, body, dst);
+	}
+
+	dst.off += dputs(dst, STRV("static int "));
+	dst.off += egen_rule_name(estx, name, rule, dst);
+	dst.off += dputs(dst, STRV("(eprs_t *eprs, uint *off, eprs_node_t node)\n{\n"));
+
+	if (term == NULL) {
+		dst.off += dputs(dst,
+				 STRV("\t(void)eprs;\n"
+				      "\t(void)off;\n"
+				      "\t(void)node;\n"
+				      "\treturn 1;\n"
+				      "}\n"
+				      "\n"));
+		return dst.off - off;
+	}
+
+	if (estx_get_node(estx, rule)->flags & ESTX_RULE_FLAG_LEX) {
+		// Lexical rules are only recognized, like in eprs_parse_rule
+		dst.off += dputs(dst,
+				 STRV("\tuint cur  = *off;\n"
+				      "\tint cut   = 0;\n"
+				      "\tint recog = eprs->recognize;\n"
+				      "\n"
+				      "\teprs->recognize = 1;\n"
+				      "\tint ret\t\t= "));
+		dst.off += egen_call(name, term, body, "&cut", dst);
+		dst.off += dputs(dst,
+				 STRV(";\n"
+				      "\teprs->recognize = recog;\n"
+				      "\n"
+				      "\tif (ret"));
+	} else {
+		dst.off += dputs(dst,
+				 STRV("\tuint cur = *off;\n"
+				      "\tint cut  = 0;\n"
+				      "\n"
+				      "\tif ("));
+		dst.off += egen_call(name, term, body, "&cut", dst);
+	}
+	dst.off += dputs(dst,
+			 STRV(") {\n"
+			      "\t\t*off = cur;\n"
+			      "\t\treturn 1;\n"
+			      "\t}\n"
+			      "\n"));
+	if (!(estx_get_node(estx, rule)->flags & ESTX_RULE_FLAG_INLINE)) {
+		dst.off += dputs(dst, STRV("\teprs_set_span(eprs, node, cur, *off - cur);\n"));
+	}
+	dst.off += dputs(dst,
+			 STRV("\treturn 0;\n"
+			      "}\n"
+			      "\n"));
+
+	return dst.off - off;
+}
+
+static int egen_check(const estx_t *estx, estx_node_t rule)
+{
+	const estx_node_data_t *data = estx_get_node(estx, rule);
+	if (data == NULL || data->type != ESTX_RULE) {
+		log_error("cparse", "egen", NULL, "invalid rule: %d", rule);
+		return 1;
+	}
+
+	uint i = 0;
+	estx_node_foreach_all(&estx->nodes, i, data)
+	{
+		if (data->type == ESTX_TERM_EXPR) {
+			log_error("cparse", "egen", NULL, "expression terms are not supported: %d", i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Marks the rules reached from a rule, rules left unused by estx_optimize are not generated
+static void egen_reach(const estx_t *estx, byte *seen, estx_node_t node)
+{
+	const estx_node_data_t *data = estx_get_node(estx, node);
+
+	switch (data->type) {
+	case ESTX_RULE: {
+		if (seen[node]) {
+			break;
+		}
+
+		seen[node] = 1;
+
+		estx_node_t body;
+		if (list_get_next(&estx->nodes, node, &body)) {
+			egen_reach(estx, seen, body);
+		}
+		break;
+	}
+	case ESTX_TERM_RULE: egen_reach(estx, seen, data->val.rule); break;
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, data)
+		{
+			egen_reach(estx, seen, i);
+		}
+		break;
+	}
+	default: break;
+	}
+}
+
+// The generated parser defines int <name>_parse(eprs_t *eprs, const lex_t *lex, eprs_node_t *root) and is linked against cparse. Every
+// rule and term gets its own function, tokens and literals are tested inline, and no estx node is looked at while parsing.
+size_t egen_c(const estx_t *estx, estx_node_t rule, strv_t name, dst_t dst)
+{
+	if (estx == NULL || egen_check(estx, rule)) {
+		return 0;
+	}
+
+	alloc_t alloc = estx->nodes.alloc;
+	byte *seen    = alloc_alloc(&alloc, estx->nodes.cnt);
+	if (seen == NULL) {
+		log_error("cparse", "egen", NULL, "failed to allocate rules");
+		return 0;
+	}
+
+	mem_set(seen, 0, estx->nodes.cnt);
+	egen_reach(estx, seen, rule);
+
+	size_t off = dst.off;
+
+	dst.off += dputf(dst,
+			 "#include \"eprs.h\"\n"
+			 "\n"
+			 "static inline int %.*s_chr(const lex_t *lex, uint off, char c)\n"
+			 "{\n"
+			 "\ttok_t tok = lex_get_tok(lex, off);\n"
+			 "\tif (tok.type & (1 << TOK_EOF)) {\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n"
+			 "\tstrv_t val = lex_get_tok_val(lex, tok);\n"
+			 "\treturn val.len != 1 || val.data[0] != c;\n"
+			 "}\n"
+			 "\n"
+			 "static inline int %.*s_set(const lex_t *lex, uint off, const byte *set)\n"
+			 "{\n"
+			 "\ttok_t tok = lex_get_tok(lex, off);\n"
+			 "\tif (tok.type & (1 << TOK_EOF)) {\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n"
+			 "\tstrv_t val = lex_get_tok_val(lex, tok);\n"
+			 "\tif (val.len != 1) {\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n"
+			 "\tbyte c = (byte)val.data[0];\n"
+			 "\treturn !(set[c >> 3] >> (c & 7) & 1);\n"
+			 "}\n"
+			 "\n"
+			 "static inline int %.*s_tok(eprs_t *eprs, uint *off, eprs_node_t node, tok_type_t type)\n"
+			 "{\n"
+			 "\ttok_t tok = lex_get_tok(eprs->lex, *off);\n"
+			 "\tif (!(tok.type & (1 << type))) {\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n"
+			 "\teprs_node_t child;\n"
+			 "\teprs_node_tok(eprs, (tok_t){.type = type, .start = tok.start, .len = tok.len}, &child);\n"
+			 "\teprs_add_node(eprs, node, child);\n"
+			 "\t*off += tok.len;\n"
+			 "\treturn 0;\n"
+			 "}\n"
+			 "\n"
+			 "static inline int %.*s_lit(eprs_t *eprs, uint *off, eprs_node_t node, uint len)\n"
+			 "{\n"
+			 "\teprs_node_t child;\n"
+			 "\teprs_node_lit(eprs, *off, len, &child);\n"
+			 "\teprs_add_node(eprs, node, child);\n"
+			 "\t*off += len;\n"
+			 "\treturn 0;\n"
+			 "}\n"
+			 "\n",
+			 name.len,
+			 name.data,
+			 name.len,
+			 name.data,
+			 name.len,
+			 name.data,
+			 name.len,
+			 name.data);
+
+	uint i = 0;
+	const estx_node_data_t *data;
+	estx_node_foreach_all(&estx->nodes, i, data)
+	{
+		if (data->type != ESTX_RULE || !seen[i]) {
+			continue;
+		}
+
+		dst.off += dputs(dst, STRV("static int "));
+		dst.off += egen_rule_name(estx, name, i, dst);
+		dst.off += dputs(dst, STRV("(eprs_t *eprs, uint *off, eprs_node_t node);\n"));
+	}
+	dst.off += dputs(dst, STRV("\n"));
+
+	i = 0;
+	estx_node_foreach_all(&estx->nodes, i, data)
+	{
+		if (data->type == ESTX_RULE && seen[i]) {
+			dst.off += egen_rule(estx, name, i, dst);
+		}
+	}
+
+	dst.off += dputf(dst,
+			 "int %.*s_parse(eprs_t *eprs, const lex_t *lex, eprs_node_t *root)\n"
+			 "{\n"
+			 "\tif (eprs == NULL || lex == NULL) {\n"
+			 "\t\treturn 1;\n"
+			 "\t}\n"
+			 "\n"
+			 "\teprs->lex = lex;\n"
+			 "\teprs_reset(eprs, 0);\n"
+			 "\n"
+			 "\tuint off = 0;\n"
+			 "\teprs_node_t node;\n"
+			 "\tif (eprs_node_rule(eprs, %d, &node) || ",
+			 name.len,
+			 name.data,
+			 rule);
+	dst.off += egen_rule_name(estx, name, rule, dst);
+	dst.off += dputs(dst,
+			 STRV("(eprs, &off, node) || off != lex->toks.cnt) {\n"
+			      "\t\treturn 1;\n"
+			      "\t}\n"
+			      "\n"
+			      "\tif (root) {\n"
+			      "\t\t*root = node;\n"
+			      "\t}\n"
+			      "\n"
+			      "\treturn 0;\n"
+			      "}\n"));
+
+	alloc_free(&alloc, seen, estx->nodes.cnt);
+
+	return dst.off - off;
+}
+
+// The table holds the estx_save data of the grammar and is loaded with estx_load, so a grammar can be built once by a build step
+// and compiled into read-only data instead of being bootstrapped from its EBNF text at runtime.
+size_t egen_estx(const estx_t *estx, strv_t name, alloc_t alloc, dst_t dst)
+{
+	if (estx == NULL) {
+		return 0;
+	}
+
+	size_t size = estx_save(estx, NULL, 0);
+	byte *data  = alloc_alloc(&alloc, size);
+	if (data == NULL) {
+		log_error("cparse", "egen", NULL, "failed to allocate table");
+		return 0;
+	}
+
+	estx_save(estx, data, size);
+
+	size_t off = dst.off;
+
+	dst.off += dputf(dst, "static const unsigned char %.*s[%d] = {", name.len, name.data, size);
+	for (size_t i = 0; i < size; i++) {
+		dst.off += dputs(dst, i % 16 == 0 ? STRV("\n\t") : STRV(" "));
+		dst.off += dputf(dst, "0x%02x,", data[i]);
+	}
+	dst.off += dputs(dst, STRV("\n};\n"));
+
+	alloc_free(&alloc, data, size);
+
+	return dst.off - off;
+}
@@ -1,24 +1,94 @@
 #include "eprs.h"
 
 #include "log.h"
+#include "mem.h"
 
 typedef enum eprs_node_type_e {
 	EPRS_NODE_UNKNOWN,
 	EPRS_NODE_RULE,
 	EPRS_NODE_TOKEN,
 	EPRS_NODE_LITERAL,
+	EPRS_NODE_OP,
 } eprs_node_type_t;
 
 typedef struct eprs_node_data_s {
 	eprs_node_type_t type;
 	union {
-		estx_node_t rule;
+		struct {
+			estx_node_t id;
+			uint len;
+			size_t start;
+			uint look;
+			uint memo;
+		} rule;
 		tok_t literal;
 		tok_t tok;
-		int alt;
+		struct {
+			estx_node_t id;
+			uint len;
+			size_t start;
+		} op;
 	} val;
 } eprs_node_data_t;
 
+typedef struct eprs_parse_err_s {
+	estx_node_t rule;
+	uint tok;
+	estx_node_t exp;
+	uint look;
+	byte failed : 1;
+	byte cut : 1;
+} eprs_parse_err_t;
+
+#define EPRS_MEMO_CAP 64
+
+// A memo entry holds the result of a rule at an offset together with the errors and the look ahead of its parse. A successful
+// entry points to its rule node in nodes while the node is alive, which is checked with the serial stamped into the node. A result
+// asked for again after its node was dropped by backtracking is parsed once more and then kept in memo_nodes. While recognizing the
+// memo also records the alternative taken by every choice and the failed attempts of repeated groups, keyed by their term.
+struct eprs_memo_s {
+	uint gen;
+	estx_node_t rule;
+	uint off;
+	uint len;
+	uint alt;
+	uint serial;
+	eprs_node_t node;
+	eprs_parse_err_t err;
+	byte failed : 1;
+	byte saved : 1;
+};
+
+// The state of the choice points around a new one, restored when it is left
+typedef struct eprs_choice_s {
+	uint open;
+	uint off;
+} eprs_choice_t;
+
+// A frame is kept on the stack for every rule being parsed. Children of its node before from have already been streamed.
+struct eprs_frame_s {
+	eprs_frame_t *parent;
+	estx_node_t rule;
+	eprs_node_t node;
+	uint start;
+	eprs_node_t from;
+	int entered;
+};
+
+#define EPRS_CHRS_CAP 8
+
+typedef enum eprs_chr_kind_e {
+	EPRS_CHR_NONE,
+	EPRS_CHR_LIT,
+	EPRS_CHR_TOK,
+} eprs_chr_kind_t;
+
+// The node made by a character class for every character, EPRS_CHR_TOK plus the type of the token when it is matched by a token
+struct eprs_chr_s {
+	estx_node_t term;
+	byte kind[256];
+};
+
 eprs_t *eprs_init(eprs_t *eprs, uint nodes_cap, alloc_t alloc)
 {
 	if (eprs == NULL) {
@@ -30,6 +100,38 @@ eprs_t *eprs_init(eprs_t *eprs, uint nodes_cap, alloc_t alloc)
 		return NULL;
 	}
 
+	eprs->pieces	 = NULL;
+	eprs->pieces_cnt = 0;
+	eprs->run	 = NULL;
+	eprs->priv	 = NULL;
+	eprs->prev	 = NULL;
+
+	eprs->memo	  = NULL;
+	eprs->memo_cap	  = 0;
+	eprs->memo_cnt	  = 0;
+	eprs->memo_kept	  = 0;
+	eprs->memo_gen	  = 0;
+	eprs->memo_serial = 0;
+	eprs->memo_hits	  = 0;
+	eprs->memo_stores = 0;
+
+	eprs->chrs	 = NULL;
+	eprs->chrs_cap	 = 0;
+	eprs->chrs_cnt	 = 0;
+	eprs->chrs_estx	 = NULL;
+	eprs->chrs_chars = NULL;
+
+	eprs->frame	   = NULL;
+	eprs->choices	   = 0;
+	eprs->choices_open = 0;
+	eprs->choice_off   = 0;
+	eprs->rule_choices = 0;
+	eprs->event	   = NULL;
+	eprs->event_priv   = NULL;
+	eprs->event_err	   = 0;
+	eprs->recognize	   = 0;
+	eprs->guided	   = 0;
+
 	return eprs;
 }
 
@@ -39,6 +141,20 @@ void eprs_free(eprs_t *eprs)
 		return;
 	}
 
+	if (eprs->memo) {
+		alloc_free(&eprs->nodes.alloc, eprs->memo, eprs->memo_cap * sizeof(eprs_memo_t));
+		tree_free(&eprs->memo_nodes);
+		eprs->memo     = NULL;
+		eprs->memo_cap = 0;
+	}
+
+	if (eprs->chrs) {
+		alloc_free(&eprs->nodes.alloc, eprs->chrs, eprs->chrs_cap * sizeof(eprs_chr_t));
+		eprs->chrs     = NULL;
+		eprs->chrs_cap = 0;
+		eprs->chrs_cnt = 0;
+	}
+
 	tree_free(&eprs->nodes);
 }
 
@@ -51,12 +167,38 @@ void eprs_reset(eprs_t *eprs, uint cnt)
 	tree_reset(&eprs->nodes, cnt);
 }
 
+void eprs_set_split(eprs_t *eprs, eprs_piece_t *pieces, uint pieces_cnt, eprs_split_run_fn run, void *priv)
+{
+	if (eprs == NULL) {
+		return;
+	}
+
+	eprs->pieces	 = pieces;
+	eprs->pieces_cnt = pieces == NULL ? 0 : pieces_cnt;
+	eprs->run	 = run;
+	eprs->priv	 = priv;
+}
+
+// While recognizing no nodes are created, every node is reported as node 0 of the empty tree
+static int eprs_node_none(eprs_node_t *node)
+{
+	if (node) {
+		*node = 0;
+	}
+
+	return 0;
+}
+
 int eprs_node_rule(eprs_t *eprs, estx_node_t rule, eprs_node_t *node)
 {
 	if (eprs == NULL) {
 		return 1;
 	}
 
+	if (eprs->recognize) {
+		return eprs_node_none(node);
+	}
+
 	eprs_node_data_t *data = tree_node(&eprs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "eprs", NULL, "failed to add rule node");
@@ -64,8 +206,8 @@ int eprs_node_rule(eprs_t *eprs, estx_node_t rule, eprs_node_t *node)
 	}
 
 	*data = (eprs_node_data_t){
-		.type	  = EPRS_NODE_RULE,
-		.val.rule = rule,
+		.type	     = EPRS_NODE_RULE,
+		.val.rule.id = rule,
 	};
 
 	return 0;
@@ -77,6 +219,10 @@ int eprs_node_tok(eprs_t *eprs, tok_t tok, eprs_node_t *node)
 		return 1;
 	}
 
+	if (eprs->recognize) {
+		return eprs_node_none(node);
+	}
+
 	eprs_node_data_t *data = tree_node(&eprs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "eprs", NULL, "failed to add tok node");
@@ -97,6 +243,10 @@ int eprs_node_lit(eprs_t *eprs, size_t start, uint len, eprs_node_t *node)
 		return 1;
 	}
 
+	if (eprs->recognize) {
+		return eprs_node_none(node);
+	}
+
 	eprs_node_data_t *data = tree_node(&eprs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "eprs", NULL, "failed to add literal node");
@@ -111,12 +261,42 @@ int eprs_node_lit(eprs_t *eprs, size_t start, uint len, eprs_node_t *node)
 	return 0;
 }
 
+int eprs_node_op(eprs_t *eprs, estx_node_t op, size_t start, uint len, eprs_node_t *node)
+{
+	if (eprs == NULL) {
+		return 1;
+	}
+
+	if (eprs->recognize) {
+		return eprs_node_none(node);
+	}
+
+	eprs_node_data_t *data = tree_node(&eprs->nodes, node);
+	if (data == NULL) {
+		log_error("cparse", "eprs", NULL, "failed to add operator node");
+		return 1;
+	}
+
+	*data = (eprs_node_data_t){
+		.type	      = EPRS_NODE_OP,
+		.val.op.id    = op,
+		.val.op.start = start,
+		.val.op.len   = len,
+	};
+
+	return 0;
+}
+
 int eprs_add_node(eprs_t *eprs, eprs_node_t parent, eprs_node_t node)
 {
 	if (eprs == NULL) {
 		return 1;
 	}
 
+	if (eprs->recognize) {
+		return 0;
+	}
+
 	return tree_add(&eprs->nodes, parent, node);
 }
 
@@ -129,6 +309,27 @@ int eprs_remove_node(eprs_t *eprs, eprs_node_t node)
 	return tree_remove(&eprs->nodes, node);
 }
 
+int eprs_set_span(eprs_t *eprs, eprs_node_t node, uint start, uint len)
+{
+	if (eprs == NULL) {
+		return 1;
+	}
+
+	if (eprs->recognize) {
+		return 0;
+	}
+
+	eprs_node_data_t *data = tree_get(&eprs->nodes, node);
+	if (data == NULL || data->type != EPRS_NODE_RULE) {
+		return 1;
+	}
+
+	data->val.rule.start = start;
+	data->val.rule.len   = len;
+
+	return 0;
+}
+
 int eprs_get_rule(const eprs_t *eprs, eprs_node_t parent, estx_node_t rule, eprs_node_t *node)
 {
 	if (eprs == NULL) {
@@ -136,7 +337,7 @@ int eprs_get_rule(const eprs_t *eprs, eprs_node_t parent, estx_node_t rule, eprs
 	}
 
 	const eprs_node_data_t *data = tree_get(&eprs->nodes, parent);
-	if (data && data->type == EPRS_NODE_RULE && data->val.rule == rule) {
+	if (data && data->type == EPRS_NODE_RULE && data->val.rule.id == rule) {
 		if (node) {
 			*node = parent;
 		}
@@ -148,7 +349,7 @@ int eprs_get_rule(const eprs_t *eprs, eprs_node_t parent, estx_node_t rule, eprs
 	{
 		switch (data->type) {
 		case EPRS_NODE_RULE:
-			if (data->val.rule == rule) {
+			if (data->val.rule.id == rule) {
 				if (node) {
 					*node = child;
 				}
@@ -162,218 +363,1310 @@ int eprs_get_rule(const eprs_t *eprs, eprs_node_t parent, estx_node_t rule, eprs
 	return 1;
 }
 
-int eprs_get_str(const eprs_t *eprs, eprs_node_t parent, tok_t *out)
+int eprs_get_node_rule(const eprs_t *eprs, eprs_node_t node, estx_node_t *rule)
 {
-	if (eprs == NULL || out == NULL) {
+	if (eprs == NULL) {
 		return 1;
 	}
 
-	eprs_node_t child;
-	const eprs_node_data_t *data;
-	tree_foreach_child(&eprs->nodes, parent, child, data)
-	{
-		switch (data->type) {
-		case EPRS_NODE_RULE: eprs_get_str(eprs, child, out); break;
-		case EPRS_NODE_TOKEN: {
-			out->start = (out->len == 0 ? data->val.tok.start : out->start);
-			out->len += data->val.tok.len;
-			break;
-		}
-		case EPRS_NODE_LITERAL: {
-			out->start = (out->len == 0 ? data->val.literal.start : out->start);
-			out->len += data->val.literal.len;
-			break;
-		}
-		case EPRS_NODE_UNKNOWN:
-		default: log_error("cparse", "eprs", NULL, "unexpected node: %d", data->type); break;
-		}
+	const eprs_node_data_t *data = tree_get(&eprs->nodes, node);
+	if (data == NULL || data->type != EPRS_NODE_RULE) {
+		return 1;
+	}
+
+	if (rule) {
+		*rule = data->val.rule.id;
 	}
 
 	return 0;
 }
 
-typedef struct eprs_parse_err_s {
-	estx_node_t rule;
-	uint tok;
-	estx_node_t exp;
-	byte failed : 1;
-} eprs_parse_err_t;
-
-static int eprs_parse_rule(eprs_t *prs, const estx_node_t rule_id, uint *off, eprs_node_t node, eprs_parse_err_t *err);
-static int eprs_parse_terms(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
-			    const estx_node_data_t *term);
-
-static int eprs_parse_term(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
-			   const estx_node_data_t *term)
+int eprs_get_str(const eprs_t *eprs, eprs_node_t parent, tok_t *out)
 {
-	switch (term->type) {
-	case ESTX_RULE: {
-		estx_node_t terms;
-		estx_node_data_t *data = list_get_next(&eprs->estx->nodes, term_id, &terms);
-		return eprs_parse_terms(eprs, rule, terms, off, node, err, data);
+	if (eprs == NULL || out == NULL) {
+		return 1;
 	}
-	case ESTX_TERM_RULE: {
-		uint nodes_cnt = eprs->nodes.cnt;
-		eprs_node_t child;
-		uint cur = *off;
-		if (eprs_node_rule(eprs, term->val.rule, &child) || eprs_parse_rule(eprs, term->val.rule, off, child, err)) {
-			eprs_reset(eprs, nodes_cnt);
-			*off = cur;
-			return 1;
-		}
-		eprs_add_node(eprs, node, child);
-		return 0;
+
+	const eprs_node_data_t *data = tree_get(&eprs->nodes, parent);
+	if (data == NULL) {
+		return 1;
 	}
-	case ESTX_TERM_TOK: {
-		const tok_type_t tok_type = term->val.tok;
 
-		char buf[32] = {0};
+	tok_t span = {0};
+	switch (data->type) {
+	case EPRS_NODE_RULE: span = (tok_t){.start = data->val.rule.start, .len = data->val.rule.len}; break;
+	case EPRS_NODE_TOKEN: span = data->val.tok; break;
+	case EPRS_NODE_LITERAL: span = data->val.literal; break;
+	case EPRS_NODE_OP: span = (tok_t){.start = data->val.op.start, .len = data->val.op.len}; break;
+	case EPRS_NODE_UNKNOWN:
+	default: log_error("cparse", "eprs", NULL, "unexpected node: %d", data->type); return 1;
+	}
 
-		size_t len = tok_type_print(1 << tok_type, DST_BUF(buf));
+	if (span.len > 0) {
+		out->start = (out->len == 0 ? span.start : out->start);
+		out->len += span.len;
+	}
 
-		tok_t tok = lex_get_tok(eprs->lex, *off);
+	return 0;
+}
 
-		if (tok.type & (1 << tok_type)) {
-			eprs_node_t token;
-			eprs_node_tok(eprs, (tok_t){.type = tok_type, .start = tok.start, .len = tok.len}, &token);
-			eprs_add_node(eprs, node, token);
-			log_trace("cparse", "eprs", NULL, "%.*s: success +%d", len, buf, tok.len);
-			*off += tok.len;
-			return 0;
-		}
+int eprs_get_op(const eprs_t *eprs, eprs_node_t node, estx_node_t *op)
+{
+	if (eprs == NULL) {
+		return 1;
+	}
 
-		if (!err->failed || *off >= err->tok) {
-			err->rule   = rule;
-			err->tok    = *off;
-			err->exp    = term_id;
-			err->failed = 1;
-		}
-		char act[32]   = {0};
-		size_t act_len = lex_print_tok(eprs->lex, tok, DST_BUF(act));
-		log_trace("cparse", "eprs", NULL, "failed: expected %.*s, but got %.*s", len, buf, (int)act_len, act);
+	const eprs_node_data_t *data = tree_get(&eprs->nodes, node);
+	if (data == NULL || data->type != EPRS_NODE_OP) {
 		return 1;
 	}
-	case ESTX_TERM_LIT: {
-		strv_t literal = estx_data_lit(eprs->estx, term);
 
-		for (uint i = 0; i < (uint)literal.len; i++) {
-			tok_t tok = lex_get_tok(eprs->lex, *off + i);
+	if (op) {
+		*op = data->val.op.id;
+	}
 
-			if (tok.type & (1 << TOK_EOF)) {
-				err->rule   = rule;
-				err->tok    = *off + i;
-				err->exp    = term_id;
-				err->failed = 1;
-				log_trace("cparse", "eprs", NULL, "\'%*s\': failed: end of toks", literal.len, literal.data);
-				return 1;
-			}
+	return 0;
+}
 
-			strv_t c       = STRVN(&literal.data[i], 1);
-			strv_t tok_val = lex_get_tok_val(eprs->lex, tok);
-			if (!strv_eq(tok_val, c)) {
-				if (!err->failed || *off + i >= err->tok) {
-					err->rule   = rule;
-					err->tok    = *off + i;
-					err->exp    = term_id;
-					err->failed = 1;
-				}
+static void eprs_look(eprs_parse_err_t *err, uint tok)
+{
+	err->look = tok + 1 > err->look ? tok + 1 : err->look;
+}
 
-				char buf[256] = {0};
-				size_t len    = strv_print(tok_val, DST_BUF(buf));
-
-				log_trace("cparse",
-					  "eprs",
-					  NULL,
-					  "failed: expected \'%.*s\', but got \'%.*s\'",
-					  literal.len,
-					  literal.data,
-					  (int)len,
-					  buf);
-				return 1;
-			}
-		}
+static int eprs_copy(tree_t *dst, eprs_node_t parent, const tree_t *nodes, eprs_node_t src, int shift);
 
-		eprs_node_t lit;
-		eprs_node_lit(eprs, *off, (uint)literal.len, &lit);
-		eprs_add_node(eprs, node, lit);
-		log_trace("cparse", "eprs", NULL, "\'%*s\': success +%d", literal.len, literal.data, literal.len);
-		*off += (uint)literal.len;
-		return 0;
-	}
-	case ESTX_TERM_ALT: {
-		estx_node_t terms = term->val.terms;
-		estx_node_foreach(&eprs->estx->nodes, terms, term)
-		{
-			uint cur       = *off;
-			uint nodes_cnt = eprs->nodes.cnt;
-			if (eprs_parse_terms(eprs, rule, terms, off, node, err, term)) {
-				log_trace("cparse", "eprs", NULL, "alt: failed");
-				eprs_reset(eprs, nodes_cnt);
-				*off = cur;
-			} else {
-				log_trace("cparse", "eprs", NULL, "alt: success");
-				return 0;
-			}
-		}
+// Copies node src of nodes and its subtree into dst. Nodes and dst may be the same tree, so the data is read before dst grows.
+static int eprs_copy_node(tree_t *dst, const tree_t *nodes, eprs_node_t src, int shift, eprs_node_t *node)
+{
+	eprs_node_data_t val = *(const eprs_node_data_t *)tree_get(nodes, src);
+	switch (val.type) {
+	case EPRS_NODE_RULE:
+		val.val.rule.start = (size_t)((int)val.val.rule.start + shift);
+		val.val.rule.look  = (uint)((int)val.val.rule.look + shift);
+		val.val.rule.memo  = 0;
 		break;
+	case EPRS_NODE_TOKEN: val.val.tok.start = (size_t)((int)val.val.tok.start + shift); break;
+	case EPRS_NODE_LITERAL: val.val.literal.start = (size_t)((int)val.val.literal.start + shift); break;
+	case EPRS_NODE_OP: val.val.op.start = (size_t)((int)val.val.op.start + shift); break;
+	default: break;
 	}
-	case ESTX_TERM_CON: {
-		uint cur	  = *off;
-		estx_node_t terms = term->val.terms;
-		estx_node_foreach(&eprs->estx->nodes, terms, term)
-		{
-			uint nodes_cnt = eprs->nodes.cnt;
-			if (eprs_parse_terms(eprs, rule, terms, off, node, err, term)) {
-				log_trace("cparse", "eprs", NULL, "con: failed");
-				eprs_reset(eprs, nodes_cnt);
-				*off = cur;
-				return 1;
-			} else {
-				log_trace("cparse", "eprs", NULL, "con: success");
-			}
-		}
-		return 0;
+
+	eprs_node_data_t *copy = tree_node(dst, node);
+	if (copy == NULL) {
+		log_error("cparse", "eprs", NULL, "failed to copy node");
+		return 1;
 	}
-	case ESTX_TERM_GROUP: {
-		uint cur	  = *off;
-		estx_node_t terms = term->val.terms;
-		estx_node_foreach(&eprs->estx->nodes, terms, term)
-		{
-			uint nodes_cnt = eprs->nodes.cnt;
-			if (eprs_parse_terms(eprs, rule, terms, off, node, err, term)) {
-				log_trace("cparse", "eprs", NULL, "group: failed");
-				eprs_reset(eprs, nodes_cnt);
-				*off = cur;
-				return 1;
-			} else {
-				log_trace("cparse", "eprs", NULL, "group: success");
-			}
+
+	*copy = val;
+
+	return eprs_copy(dst, *node, nodes, src, shift);
+}
+
+static int eprs_copy(tree_t *dst, eprs_node_t parent, const tree_t *nodes, eprs_node_t src, int shift)
+{
+	eprs_node_t child;
+	const eprs_node_data_t *data;
+	tree_foreach_child(nodes, src, child, data)
+	{
+		eprs_node_t node;
+		if (eprs_copy_node(dst, nodes, child, shift, &node)) {
+			return 1;
 		}
+		tree_add(dst, parent, node);
+	}
+
+	return 0;
+}
+
+// Nodes are not stored in the order of their start, operator nodes are added after their operands, so the previous tree is walked
+// down from node along the rule nodes covering old. A rule node can be reused if the tokens it looked at during its parse do not
+// overlap the edited range.
+static int eprs_reuse_find(const eprs_t *eprs, eprs_node_t node, estx_node_t rule, uint old, eprs_node_t *found)
+{
+	const eprs_edit_t edit	     = eprs->edit;
+	const eprs_node_data_t *data = tree_get(eprs->prev, node);
+	if (data->val.rule.start == old && data->val.rule.id == rule && (old >= edit.start || data->val.rule.look <= edit.start)) {
+		*found = node;
 		return 0;
 	}
-	default: log_warn("cparse", "eprs", NULL, "unknown term type: %d", term->type); break;
+
+	eprs_node_t child;
+	const eprs_node_data_t *child_data;
+	tree_foreach_child(eprs->prev, node, child, child_data)
+	{
+		uint start = (uint)child_data->val.rule.start;
+		if (child_data->type != EPRS_NODE_RULE || start > old || (start < old && start + child_data->val.rule.len <= old)) {
+			continue;
+		}
+
+		if (eprs_reuse_find(eprs, child, rule, old, found) == 0) {
+			return 0;
+		}
 	}
 
 	return 1;
 }
 
-static int eprs_parse_terms(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
-			    const estx_node_data_t *term)
+static int eprs_reuse(eprs_t *eprs, estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err)
 {
-	if (term == NULL) {
+	const eprs_edit_t edit = eprs->edit;
+	const tree_t *prev     = eprs->prev;
+
+	if (*off >= edit.start && *off < edit.start + edit.new_len) {
 		return 1;
 	}
-	uint cur = *off;
 
-	int ret = eprs_parse_term(eprs, rule, term_id, off, node, err, term);
-	int one = term->occ == ESTX_TERM_OCC_ONE;
+	uint old  = *off < edit.start ? *off : *off - edit.new_len + edit.old_len;
+	int shift = *off < edit.start ? 0 : (int)edit.new_len - (int)edit.old_len;
 
-	if (term->type == ESTX_TERM_ALT || term->type == ESTX_TERM_CON || one) {
-		return ret;
+	eprs_node_t id;
+	if (eprs_reuse_find(eprs, 0, rule, old, &id)) {
+		return 1;
 	}
 
-	int opt = (term->occ & ESTX_TERM_OCC_OPT) && !(term->occ & ESTX_TERM_OCC_REP);
-	int rep = !(term->occ & ESTX_TERM_OCC_OPT) && (term->occ & ESTX_TERM_OCC_REP);
+	const eprs_node_data_t *data = tree_get(prev, id);
+	uint nodes_cnt		     = eprs->nodes.cnt;
+	uint look		     = (uint)((int)data->val.rule.look + shift);
+	uint len		     = data->val.rule.len;
+	eprs_node_t child;
+	if (eprs_copy_node(&eprs->nodes, prev, id, shift, &child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+	eprs_add_node(eprs, node, child);
+
+	err->look = look > err->look ? look : err->look;
+	*off += len;
+	log_trace("cparse", "eprs", NULL, "<%d>: reused +%d", rule, len);
+	return 0;
+}
+
+static void eprs_merge_err(eprs_parse_err_t *err, const eprs_parse_err_t *sub)
+{
+	if (sub->failed && (!err->failed || sub->tok >= err->tok)) {
+		err->rule   = sub->rule;
+		err->tok    = sub->tok;
+		err->exp    = sub->exp;
+		err->failed = 1;
+	}
+
+	err->look = sub->look > err->look ? sub->look : err->look;
+}
+
+static uint eprs_memo_hash(estx_node_t rule, uint off, uint cap)
+{
+	return ((uint)rule * 0x9e3779b1u ^ off * 0x85ebca77u) & (cap - 1);
+}
+
+static void eprs_memo_start(eprs_t *eprs)
+{
+	eprs->memo_cnt	  = 0;
+	eprs->memo_kept	  = 0;
+	eprs->memo_hits	  = 0;
+	eprs->memo_stores = 0;
+
+	if (eprs->memo == NULL) {
+		return;
+	}
+
+	tree_reset(&eprs->memo_nodes, 0);
+
+	eprs->memo_gen++;
+	if (eprs->memo_gen == 0) {
+		mem_set(eprs->memo, 0, eprs->memo_cap * sizeof(eprs_memo_t));
+		eprs->memo_gen = 1;
+	}
+}
+
+static int eprs_memo_grow(eprs_t *eprs)
+{
+	uint cap	  = eprs->memo_cap == 0 ? EPRS_MEMO_CAP : eprs->memo_cap * 2;
+	eprs_memo_t *memo = alloc_alloc(&eprs->nodes.alloc, cap * sizeof(eprs_memo_t));
+	if (memo == NULL) {
+		log_error("cparse", "eprs", NULL, "failed to allocate memo table");
+		return 1;
+	}
+
+	if (eprs->memo == NULL && tree_init(&eprs->memo_nodes, EPRS_MEMO_CAP, sizeof(eprs_node_data_t), eprs->nodes.alloc) == NULL) {
+		alloc_free(&eprs->nodes.alloc, memo, cap * sizeof(eprs_memo_t));
+		log_error("cparse", "eprs", NULL, "failed to initialize memo nodes tree");
+		return 1;
+	}
+
+	mem_set(memo, 0, cap * sizeof(eprs_memo_t));
+
+	uint gen = eprs->memo_gen == 0 ? 1 : eprs->memo_gen;
+	for (uint i = 0; i < eprs->memo_cap; i++) {
+		const eprs_memo_t *old = &eprs->memo[i];
+		if (old->gen != eprs->memo_gen) {
+			continue;
+		}
+
+		uint j = eprs_memo_hash(old->rule, old->off, cap);
+		while (memo[j].gen == gen) {
+			j = (j + 1) & (cap - 1);
+		}
+		memo[j] = *old;
+	}
+
+	alloc_free(&eprs->nodes.alloc, eprs->memo, eprs->memo_cap * sizeof(eprs_memo_t));
+	eprs->memo     = memo;
+	eprs->memo_cap = cap;
+	eprs->memo_gen = gen;
+	return 0;
+}
+
+static eprs_memo_t *eprs_memo_find(const eprs_t *eprs, estx_node_t rule, uint off)
+{
+	if (eprs->memo == NULL) {
+		return NULL;
+	}
+
+	for (uint i = eprs_memo_hash(rule, off, eprs->memo_cap);; i = (i + 1) & (eprs->memo_cap - 1)) {
+		eprs_memo_t *memo = &eprs->memo[i];
+		if (memo->gen != eprs->memo_gen) {
+			return NULL;
+		}
+
+		if (memo->rule == rule && memo->off == off) {
+			return memo;
+		}
+	}
+}
+
+static eprs_memo_t *eprs_memo_add(eprs_t *eprs, estx_node_t rule, uint off)
+{
+	eprs_memo_t *memo = eprs_memo_find(eprs, rule, off);
+	if (memo) {
+		return memo;
+	}
+
+	if ((eprs->memo_cnt + 1) * 4 > eprs->memo_cap * 3 && eprs_memo_grow(eprs)) {
+		return NULL;
+	}
+
+	uint i = eprs_memo_hash(rule, off, eprs->memo_cap);
+	while (eprs->memo[i].gen == eprs->memo_gen) {
+		i = (i + 1) & (eprs->memo_cap - 1);
+	}
+
+	memo  = &eprs->memo[i];
+	*memo = (eprs_memo_t){
+		.gen  = eprs->memo_gen,
+		.rule = rule,
+		.off  = off,
+	};
+	eprs->memo_cnt++;
+	return memo;
+}
+
+static void eprs_memo_store(eprs_t *eprs, estx_node_t rule, uint off, uint len, eprs_node_t node, const eprs_parse_err_t *err, int failed,
+			    int save)
+{
+	eprs_memo_t *memo = eprs_memo_add(eprs, rule, off);
+	if (memo == NULL) {
+		return;
+	}
+
+	memo->len    = failed ? 0 : len;
+	memo->serial = 0;
+	memo->node   = node;
+	memo->err    = *err;
+	memo->failed = failed;
+	memo->saved  = 0;
+	eprs->memo_stores++;
+
+	eprs_node_data_t *data = tree_get(&eprs->nodes, node);
+	if (failed || data == NULL || eprs->recognize) {
+		return;
+	}
+
+	eprs->memo_serial++;
+	if (eprs->memo_serial == 0) {
+		eprs->memo_serial = 1;
+	}
+	memo->serial	    = eprs->memo_serial;
+	data->val.rule.memo = memo->serial;
+
+	if (!save) {
+		return;
+	}
+
+	uint memo_cnt = eprs->memo_nodes.cnt;
+	eprs_node_t saved;
+	if (eprs_copy_node(&eprs->memo_nodes, &eprs->nodes, node, 0, &saved)) {
+		tree_reset(&eprs->memo_nodes, memo_cnt);
+		return;
+	}
+
+	memo->node  = saved;
+	memo->saved = 1;
+}
+
+static int eprs_memo_load(eprs_t *eprs, const eprs_memo_t *memo, uint *off, eprs_node_t node, eprs_parse_err_t *err)
+{
+	if (!memo->failed && !eprs->recognize) {
+		const tree_t *nodes	     = memo->saved ? &eprs->memo_nodes : &eprs->nodes;
+		const eprs_node_data_t *data = tree_get(nodes, memo->node);
+		if (!memo->saved && (memo->serial == 0 || data == NULL || data->type != EPRS_NODE_RULE || data->val.rule.memo != memo->serial)) {
+			return 1;
+		}
+
+		uint nodes_cnt = eprs->nodes.cnt;
+		eprs_node_t child;
+		if (eprs_copy_node(&eprs->nodes, nodes, memo->node, 0, &child)) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+		eprs_add_node(eprs, node, child);
+	}
+
+	if (!memo->failed) {
+		*off += memo->len;
+	}
+
+	eprs_merge_err(err, &memo->err);
+	eprs->memo_hits++;
+	log_trace("cparse", "eprs", NULL, "<%d>: memo %s +%d", memo->rule, memo->failed ? "failed" : "success", memo->len);
+	return 0;
+}
+
+// Removes the entry at i and moves the entries after it, which would not be found behind the hole anymore, into its place
+static void eprs_memo_remove(eprs_t *eprs, uint i)
+{
+	uint mask = eprs->memo_cap - 1;
+	for (uint j = (i + 1) & mask; eprs->memo[j].gen == eprs->memo_gen; j = (j + 1) & mask) {
+		uint home = eprs_memo_hash(eprs->memo[j].rule, eprs->memo[j].off, eprs->memo_cap);
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			eprs->memo[i] = eprs->memo[j];
+			i	      = j;
+		}
+	}
+
+	eprs->memo[i].gen = 0;
+	eprs->memo_cnt--;
+}
+
+// Entries before off are never asked for again. The walk over the table is only made once the memo doubled since the last one, so
+// it is paid for by the entries stored in between. The saved nodes are dropped with the entries once no entry left points into
+// memo_nodes. While recognizing the entries are kept, the choices recorded there guide the second phase.
+static void eprs_memo_drop(eprs_t *eprs, uint off)
+{
+	if (eprs->memo == NULL || eprs->recognize || eprs->guided || eprs->memo_cnt < EPRS_MEMO_CAP / 2 ||
+	    eprs->memo_cnt < 2 * eprs->memo_kept) {
+		return;
+	}
+
+	uint mask = eprs->memo_cap - 1;
+
+	// Clusters never wrap around an empty slot, so a walk starting behind one sees every entry moved by a removal again
+	uint start = 0;
+	while (eprs->memo[start].gen == eprs->memo_gen) {
+		start++;
+	}
+
+	uint cnt  = eprs->memo_cnt;
+	int saved = 0;
+	for (uint n = 1; n <= eprs->memo_cap; n++) {
+		uint i = (start + n) & mask;
+		while (eprs->memo[i].gen == eprs->memo_gen && eprs->memo[i].off < off) {
+			eprs_memo_remove(eprs, i);
+		}
+		if (eprs->memo[i].gen == eprs->memo_gen && eprs->memo[i].saved) {
+			saved = 1;
+		}
+	}
+
+	if (!saved) {
+		tree_reset(&eprs->memo_nodes, 0);
+	}
+
+	eprs->memo_kept = eprs->memo_cnt;
+	log_trace("cparse", "eprs", NULL, "memo: dropped %d entries before %d", cnt - eprs->memo_cnt, off);
+}
+
+static void eprs_choice_store(eprs_t *eprs, estx_node_t term, uint off, uint alt, int failed)
+{
+	if (!eprs->recognize || eprs->guided) {
+		return;
+	}
+
+	eprs_memo_t *memo = eprs_memo_add(eprs, term, off);
+	if (memo == NULL) {
+		return;
+	}
+
+	memo->alt    = alt;
+	memo->failed = failed;
+}
+
+static const eprs_memo_t *eprs_choice_find(const eprs_t *eprs, estx_node_t term, uint off)
+{
+	return eprs->guided ? eprs_memo_find(eprs, term, off) : NULL;
+}
+
+// A choice point is open until a cut commits it. The parse can not return before the start of the outermost open choice point, and
+// not before the current offset without one. Everything the memo holds before that offset is dropped.
+static eprs_choice_t eprs_choice_enter(eprs_t *eprs, uint off)
+{
+	eprs_choice_t choice = {
+		.open = eprs->choices_open,
+		.off  = eprs->choice_off,
+	};
+
+	if (eprs->choices_open++ == 0) {
+		eprs->choice_off = off;
+	}
+	eprs->choices++;
+
+	eprs_memo_drop(eprs, eprs->choice_off);
+	return choice;
+}
+
+static void eprs_choice_exit(eprs_t *eprs, eprs_choice_t choice)
+{
+	eprs->choices--;
+	eprs->choices_open = choice.open;
+	eprs->choice_off   = choice.off;
+}
+
+// A cut commits the innermost choice point of its rule, unless the attempt it is in was committed already
+static void eprs_choice_cut(eprs_t *eprs, uint off, int committed)
+{
+	if (!committed && eprs->choices > eprs->rule_choices) {
+		eprs->choices_open--;
+	}
+
+	eprs_memo_drop(eprs, eprs->choices_open > 0 ? eprs->choice_off : off);
+}
+
+static void eprs_event(eprs_t *eprs, eprs_event_t event)
+{
+	if (eprs->event_err) {
+		return;
+	}
+
+	if (eprs->event(eprs, event, eprs->event_priv)) {
+		log_trace("cparse", "eprs", NULL, "event %d: stopped", event.type);
+		eprs->event_err = 1;
+	}
+}
+
+static void eprs_event_node(eprs_t *eprs, eprs_node_t node)
+{
+	const eprs_node_data_t *data = tree_get(&eprs->nodes, node);
+	switch (data->type) {
+	case EPRS_NODE_RULE: {
+		estx_node_t id = data->val.rule.id;
+		tok_t span     = {.start = data->val.rule.start, .len = data->val.rule.len};
+		eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_ENTER, .id = id, .tok = {.start = span.start}});
+
+		eprs_node_t child;
+		tree_foreach_child(&eprs->nodes, node, child, data)
+		{
+			eprs_event_node(eprs, child);
+		}
+
+		eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_EXIT, .id = id, .tok = span});
+		break;
+	}
+	case EPRS_NODE_TOKEN: eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_TOKEN, .tok = data->val.tok}); break;
+	case EPRS_NODE_LITERAL: eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_LITERAL, .tok = data->val.literal}); break;
+	case EPRS_NODE_OP:
+		eprs_event(eprs,
+			   (eprs_event_t){
+				   .type = EPRS_EVENT_OP,
+				   .id	 = data->val.op.id,
+				   .tok	 = {.start = data->val.op.start, .len = data->val.op.len},
+			   });
+		break;
+	default: break;
+	}
+}
+
+// Streams every rule being parsed from the root down: enters the ones not entered yet and sends their finished children
+static void eprs_event_enter(eprs_t *eprs, eprs_frame_t *frame)
+{
+	if (frame == NULL) {
+		return;
+	}
+
+	eprs_event_enter(eprs, frame->parent);
+
+	if (!frame->entered) {
+		eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_ENTER, .id = frame->rule, .tok = {.start = frame->start}});
+		frame->entered = 1;
+	}
+
+	eprs_node_t child;
+	const eprs_node_data_t *data;
+	tree_foreach_child(&eprs->nodes, frame->node, child, data)
+	{
+		if (child < frame->from) {
+			continue;
+		}
+
+		eprs_event_node(eprs, child);
+		frame->from = child + 1;
+	}
+}
+
+// Nodes added by a successful attempt can not be taken back once no other choice point is open. They are streamed and dropped, so
+// that only the part of the tree which may still be backtracked is kept.
+static void eprs_event_flush(eprs_t *eprs, uint nodes_cnt)
+{
+	if (eprs->event == NULL || eprs->choices > 0 || eprs->frame == NULL) {
+		return;
+	}
+
+	eprs_event_enter(eprs, eprs->frame);
+	eprs_reset(eprs, nodes_cnt);
+	eprs->frame->from = nodes_cnt;
+}
+
+static void eprs_event_exit(eprs_t *eprs, eprs_frame_t *frame, uint len)
+{
+	if (eprs->event == NULL || !frame->entered) {
+		return;
+	}
+
+	eprs_event_enter(eprs, frame);
+	eprs_event(eprs, (eprs_event_t){.type = EPRS_EVENT_EXIT, .id = frame->rule, .tok = {.start = frame->start, .len = len}});
+	if (frame->parent) {
+		frame->parent->from = frame->node + 1;
+	}
+}
+
+static int eprs_parse_rule(eprs_t *prs, const estx_node_t rule_id, uint *off, eprs_node_t node, eprs_parse_err_t *err);
+static int eprs_parse_terms(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
+			    const estx_node_data_t *term);
+
+// An inline rule adds its children to the node of the rule using it. Without a node of its own it is neither memoized nor reused
+// while building, and no events are sent for it.
+static int eprs_parse_inline(eprs_t *eprs, estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err,
+			     const estx_node_data_t *term)
+{
+	if (eprs->guided) {
+		const eprs_memo_t *memo = eprs_memo_find(eprs, rule, *off);
+		if (memo && memo->failed) {
+			return 1;
+		}
+	}
+
+	uint cur	   = *off;
+	uint nodes_cnt	   = eprs->nodes.cnt;
+	uint choices	   = eprs->rule_choices;
+	eprs->rule_choices = eprs->choices;
+
+	eprs_parse_err_t sub = {0};
+
+	int ret = eprs_parse_terms(eprs, rule, rule, off, node, &sub, term);
+	eprs_merge_err(err, &sub);
+	eprs->rule_choices = choices;
+
+	if (ret) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int eprs_parse_sub(eprs_t *eprs, estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err)
+{
+	const estx_node_data_t *term = estx_get_node(eprs->estx, rule);
+	if (term && (term->flags & ESTX_RULE_FLAG_INLINE) && !eprs->recognize) {
+		return eprs_parse_inline(eprs, rule, off, node, err, term);
+	}
+
+	if (eprs->prev && !eprs->recognize && eprs_reuse(eprs, rule, off, node, err) == 0) {
+		return 0;
+	}
+
+	uint cur	  = *off;
+	eprs_memo_t *memo = eprs_memo_find(eprs, rule, cur);
+	if (eprs->guided) {
+		// Only rules known to succeed are built, the memo of the recognizing pass is kept as it is
+		if (memo && memo->failed) {
+			return 1;
+		}
+	} else if (memo && eprs_memo_load(eprs, memo, off, node, err) == 0) {
+		return memo->failed;
+	}
+
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, rule, &child)) {
+		return 1;
+	}
+
+	// The rule is parsed with its own errors, so that they can be stored and merged again on every later hit
+	eprs_parse_err_t sub = {0};
+
+	int ret = eprs_parse_rule(eprs, rule, off, child, &sub);
+	eprs_merge_err(err, &sub);
+	if (!eprs->guided) {
+		eprs_memo_store(eprs, rule, cur, *off - cur, child, &sub, ret, memo != NULL && !eprs->recognize);
+	}
+
+	if (ret) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int eprs_match_lit(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, strv_t literal, uint off, eprs_parse_err_t *err)
+{
+	for (uint i = 0; i < (uint)literal.len; i++) {
+		tok_t tok = lex_get_tok(eprs->lex, off + i);
+		eprs_look(err, off + i);
+
+		if (tok.type & (1 << TOK_EOF)) {
+			err->rule   = rule;
+			err->tok    = off + i;
+			err->exp    = term_id;
+			err->failed = 1;
+			log_trace("cparse", "eprs", NULL, "\'%*s\': failed: end of toks", literal.len, literal.data);
+			return 1;
+		}
+
+		strv_t c       = STRVN(&literal.data[i], 1);
+		strv_t tok_val = lex_get_tok_val(eprs->lex, tok);
+		if (!strv_eq(tok_val, c)) {
+			if (!err->failed || off + i >= err->tok) {
+				err->rule   = rule;
+				err->tok    = off + i;
+				err->exp    = term_id;
+				err->failed = 1;
+			}
+
+			char buf[256] = {0};
+			size_t len    = strv_print(tok_val, DST_BUF(buf));
+
+			log_trace("cparse",
+				  "eprs",
+				  NULL,
+				  "failed: expected \'%.*s\', but got \'%.*s\'",
+				  literal.len,
+				  literal.data,
+				  (int)len,
+				  buf);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Operands and operators are added to the node in postfix order, so the tree stays flat and still encodes the precedence: every
+// operator node applies to the one (prefix) or two (infix) operands before it.
+static int eprs_parse_expr(eprs_t *eprs, estx_node_t rule, const estx_node_data_t *term, uint prec, uint *off, eprs_node_t node,
+			   eprs_parse_err_t *err)
+{
+	const estx_t *estx = eprs->estx;
+	uint cur	   = *off;
+	uint nodes_cnt	   = eprs->nodes.cnt;
+
+	const estx_node_data_t *op;
+	estx_node_t op_id = term->val.expr.ops;
+	estx_node_foreach(&estx->nodes, op_id, op)
+	{
+		if (op->val.op.type == ESTX_OP_PREFIX && eprs_match_lit(eprs, rule, op_id, estx_data_lit(estx, op), *off, err) == 0) {
+			break;
+		}
+	}
+
+	if (op) {
+		uint len = (uint)estx_data_lit(estx, op).len;
+		*off += len;
+
+		eprs_node_t child;
+		if (eprs_parse_expr(eprs, rule, term, op->val.op.prec, off, node, err) || eprs_node_op(eprs, op_id, cur, len, &child)) {
+			eprs_reset(eprs, nodes_cnt);
+			*off = cur;
+			return 1;
+		}
+		eprs_add_node(eprs, node, child);
+	} else if (eprs_parse_sub(eprs, term->val.expr.rule, off, node, err)) {
+		return 1;
+	}
+
+	while (1) {
+		op_id = term->val.expr.ops;
+		estx_node_foreach(&estx->nodes, op_id, op)
+		{
+			if (op->val.op.type != ESTX_OP_PREFIX && op->val.op.prec >= prec &&
+			    eprs_match_lit(eprs, rule, op_id, estx_data_lit(estx, op), *off, err) == 0) {
+				break;
+			}
+		}
+
+		if (op == NULL) {
+			break;
+		}
+
+		uint start = *off;
+		uint len   = (uint)estx_data_lit(estx, op).len;
+		nodes_cnt  = eprs->nodes.cnt;
+		*off += len;
+
+		eprs_node_t child;
+		uint next = op->val.op.type == ESTX_OP_LEFT ? op->val.op.prec + 1 : op->val.op.prec;
+		eprs_choice_t choice = eprs_choice_enter(eprs, start);
+		int ret		     = eprs_parse_expr(eprs, rule, term, next, off, node, err);
+		eprs_choice_exit(eprs, choice);
+		if (ret || eprs_node_op(eprs, op_id, start, len, &child)) {
+			eprs_reset(eprs, nodes_cnt);
+			*off = start;
+			break;
+		}
+		eprs_add_node(eprs, node, child);
+		log_trace("cparse", "eprs", NULL, "op %d: success", op_id);
+	}
+
+	return 0;
+}
+
+// With an analyzed grammar an attempt of a term which can neither be empty nor start with the next token is not made. Every term
+// which could start it would fail on that token, so the last of them is recorded as the expected one, the same as the attempt.
+// The end of the tokens is left to the attempt, as literals record it regardless of earlier errors.
+static int eprs_skip(eprs_t *eprs, estx_node_t term_id, uint off, eprs_parse_err_t *err)
+{
+	const estx_info_t *info = estx_get_info(eprs->estx, term_id);
+	if (info == NULL || info->empty || info->cut || !info->has_exp) {
+		return 0;
+	}
+
+	tok_t tok = lex_get_tok(eprs->lex, off);
+	if ((tok.type & (1 << TOK_EOF)) || estx_toks_has(&info->first, tok, lex_get_tok_val(eprs->lex, tok))) {
+		return 0;
+	}
+
+	eprs_look(err, off);
+	if (!err->failed || off >= err->tok) {
+		err->rule   = info->exp_rule;
+		err->tok    = off;
+		err->exp    = info->exp;
+		err->failed = 1;
+	}
+
+	log_trace("cparse", "eprs", NULL, "%d: skipped", term_id);
+	return 1;
+}
+
+static int eprs_chr_one(const eprs_t *eprs, const estx_node_data_t *term)
+{
+	return term->type == ESTX_TERM_TOK || term->type == ESTX_TERM_SET ||
+	       (term->type == ESTX_TERM_LIT && estx_data_lit(eprs->estx, term).len == 1);
+}
+
+// A set is tested with one lookup of the character in its bitmap
+static int eprs_chr_has(const eprs_t *eprs, const estx_node_data_t *term, uint type, strv_t val)
+{
+	if (term->type == ESTX_TERM_TOK) {
+		return (type & (1 << term->val.tok)) != 0;
+	}
+
+	if ((type & (1 << TOK_EOF)) || val.len != 1) {
+		return 0;
+	}
+
+	if (term->type == ESTX_TERM_SET) {
+		return tok_set_has(estx_data_set(eprs->estx, term), (byte)val.data[0]);
+	}
+
+	return val.data[0] == estx_data_lit(eprs->estx, term).data[0];
+}
+
+static int eprs_chr_match(const eprs_t *eprs, const estx_node_data_t *term, tok_t tok)
+{
+	return eprs_chr_has(eprs, term, tok.type, lex_get_tok_val(eprs->lex, tok));
+}
+
+// A list is parsed in a loop which adds its elements to the node, without a group and a choice point per repetition. Every element
+// after the first is an attempt together with the separator in front of it, a cut inside a failed attempt fails the whole list. The
+// separators are only recognized, unless they are kept.
+static int eprs_parse_list(eprs_t *eprs, estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err, const estx_node_data_t *term)
+{
+	estx_node_t elem = term->val.list.terms;
+	estx_node_t sep;
+	const estx_node_data_t *elem_data = list_get(&eprs->estx->nodes, elem);
+	const estx_node_data_t *sep_data  = list_get_next(&eprs->estx->nodes, elem, &sep);
+	if (elem_data == NULL || sep_data == NULL) {
+		return 1;
+	}
+
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	byte cut       = err->cut;
+	int recog      = eprs->recognize;
+	uint cnt       = 0;
+
+	for (;;) {
+		uint at	    = *off;
+		uint at_cnt = eprs->nodes.cnt;
+		if ((cnt > 0 || term->val.list.min == 0) && eprs_skip(eprs, cnt > 0 ? sep : elem, at, err)) {
+			break;
+		}
+
+		eprs_choice_t choice = eprs_choice_enter(eprs, at);
+		err->cut	     = 0;
+		int ret		     = 0;
+		if (cnt > 0) {
+			eprs->recognize = recog || !term->val.list.keep;
+			ret		= eprs_parse_terms(eprs, rule, sep, off, node, err, sep_data);
+			eprs->recognize = recog;
+		}
+		if (ret == 0) {
+			ret = eprs_parse_terms(eprs, rule, elem, off, node, err, elem_data);
+		}
+		eprs_choice_exit(eprs, choice);
+		byte commit = err->cut;
+		err->cut    = cut;
+
+		if (ret) {
+			eprs_reset(eprs, at_cnt);
+			*off = at;
+			if (commit) {
+				log_trace("cparse", "eprs", NULL, "list: cut");
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			}
+			break;
+		}
+
+		eprs_event_flush(eprs, nodes_cnt);
+		if (cnt++ > 0 && *off == at) {
+			log_warn("cparse", "eprs", NULL, "loop detected: %d", at);
+			break;
+		}
+	}
+
+	if (cnt < term->val.list.min) {
+		log_trace("cparse", "eprs", NULL, "list: failed");
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	log_trace("cparse", "eprs", NULL, "list: success %d", cnt);
+	return 0;
+}
+
+static int eprs_parse_term(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
+			   const estx_node_data_t *term)
+{
+	switch (term->type) {
+	case ESTX_RULE: {
+		estx_node_t terms;
+		estx_node_data_t *data = list_get_next(&eprs->estx->nodes, term_id, &terms);
+		return eprs_parse_terms(eprs, rule, terms, off, node, err, data);
+	}
+	case ESTX_TERM_RULE: return eprs_parse_sub(eprs, term->val.rule, off, node, err);
+	case ESTX_TERM_TOK: {
+		const tok_type_t tok_type = term->val.tok;
+
+		char buf[32] = {0};
+
+		size_t len = tok_type_print(1 << tok_type, DST_BUF(buf));
+
+		tok_t tok = lex_get_tok(eprs->lex, *off);
+		eprs_look(err, *off);
+
+		if (tok.type & (1 << tok_type)) {
+			eprs_node_t token;
+			eprs_node_tok(eprs, (tok_t){.type = tok_type, .start = tok.start, .len = tok.len}, &token);
+			eprs_add_node(eprs, node, token);
+			log_trace("cparse", "eprs", NULL, "%.*s: success +%d", len, buf, tok.len);
+			*off += tok.len;
+			return 0;
+		}
+
+		if (!err->failed || *off >= err->tok) {
+			err->rule   = rule;
+			err->tok    = *off;
+			err->exp    = term_id;
+			err->failed = 1;
+		}
+		char act[32]   = {0};
+		size_t act_len = lex_print_tok(eprs->lex, tok, DST_BUF(act));
+		log_trace("cparse", "eprs", NULL, "failed: expected %.*s, but got %.*s", len, buf, (int)act_len, act);
+		return 1;
+	}
+	case ESTX_TERM_LIT: {
+		strv_t literal = estx_data_lit(eprs->estx, term);
+		if (eprs_match_lit(eprs, rule, term_id, literal, *off, err)) {
+			return 1;
+		}
+
+		eprs_node_t lit;
+		eprs_node_lit(eprs, *off, (uint)literal.len, &lit);
+		eprs_add_node(eprs, node, lit);
+		log_trace("cparse", "eprs", NULL, "\'%*s\': success +%d", literal.len, literal.data, literal.len);
+		*off += (uint)literal.len;
+		return 0;
+	}
+	case ESTX_TERM_SET: {
+		tok_t tok = lex_get_tok(eprs->lex, *off);
+		eprs_look(err, *off);
+
+		if (eprs_chr_match(eprs, term, tok)) {
+			eprs_node_t lit;
+			eprs_node_lit(eprs, *off, 1, &lit);
+			eprs_add_node(eprs, node, lit);
+			log_trace("cparse", "eprs", NULL, "set: success +1");
+			*off += 1;
+			return 0;
+		}
+
+		if (!err->failed || *off >= err->tok) {
+			err->rule   = rule;
+			err->tok    = *off;
+			err->exp    = term_id;
+			err->failed = 1;
+		}
+		log_trace("cparse", "eprs", NULL, "set: failed");
+		return 1;
+	}
+	case ESTX_TERM_ALT: {
+		estx_node_t terms	= term->val.terms;
+		byte cut		= err->cut;
+		const eprs_memo_t *memo = eprs_choice_find(eprs, term_id, *off);
+		uint alt		= 0;
+		estx_node_foreach(&eprs->estx->nodes, terms, term)
+		{
+			uint i = alt++;
+			if (memo && !memo->failed && i != memo->alt) {
+				continue;
+			}
+
+			if (term->occ == ESTX_TERM_OCC_ONE && eprs_skip(eprs, terms, *off, err)) {
+				continue;
+			}
+
+			uint cur	 = *off;
+			uint nodes_cnt	 = eprs->nodes.cnt;
+			eprs_choice_t cp = eprs_choice_enter(eprs, cur);
+			err->cut	 = 0;
+			int ret		 = eprs_parse_terms(eprs, rule, terms, off, node, err, term);
+			eprs_choice_exit(eprs, cp);
+			byte commit = err->cut;
+			err->cut    = cut;
+			if (ret) {
+				log_trace("cparse", "eprs", NULL, "alt: failed");
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				if (commit) {
+					log_trace("cparse", "eprs", NULL, "alt: cut");
+					return 1;
+				}
+			} else {
+				log_trace("cparse", "eprs", NULL, "alt: success");
+				eprs_choice_store(eprs, term_id, cur, i, 0);
+				return 0;
+			}
+		}
+		break;
+	}
+	case ESTX_TERM_CON: {
+		uint cur	  = *off;
+		uint nodes_cnt	  = eprs->nodes.cnt;
+		estx_node_t terms = term->val.terms;
+		estx_node_foreach(&eprs->estx->nodes, terms, term)
+		{
+			if (eprs_parse_terms(eprs, rule, terms, off, node, err, term)) {
+				log_trace("cparse", "eprs", NULL, "con: failed");
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			} else {
+				log_trace("cparse", "eprs", NULL, "con: success");
+			}
+		}
+		return 0;
+	}
+	case ESTX_TERM_GROUP: {
+		uint cur	  = *off;
+		uint nodes_cnt	  = eprs->nodes.cnt;
+		estx_node_t terms = term->val.terms;
+		estx_node_foreach(&eprs->estx->nodes, terms, term)
+		{
+			if (eprs_parse_terms(eprs, rule, terms, off, node, err, term)) {
+				log_trace("cparse", "eprs", NULL, "group: failed");
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			} else {
+				log_trace("cparse", "eprs", NULL, "group: success");
+			}
+		}
+		return 0;
+	}
+	case ESTX_TERM_EXPR: return eprs_parse_expr(eprs, rule, term, 0, off, node, err);
+	case ESTX_TERM_LIST: return eprs_parse_list(eprs, rule, off, node, err, term);
+	case ESTX_TERM_CUT:
+		log_trace("cparse", "eprs", NULL, "cut");
+		eprs_choice_cut(eprs, *off, err->cut);
+		err->cut = 1;
+		return 0;
+	default: log_warn("cparse", "eprs", NULL, "unknown term type: %d", term->type); break;
+	}
+
+	return 1;
+}
+
+// An attempt of a repeated group which failed while recognizing is not tried again while building
+static int eprs_parse_attempt(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
+			      const estx_node_data_t *term)
+{
+	if (eprs_skip(eprs, term_id, *off, err)) {
+		return 1;
+	}
+
+	if (term->type != ESTX_TERM_GROUP) {
+		return eprs_parse_term(eprs, rule, term_id, off, node, err, term);
+	}
+
+	const eprs_memo_t *choice = eprs_choice_find(eprs, term_id, *off);
+	if (choice && choice->failed) {
+		return 1;
+	}
+
+	uint cur = *off;
+	int ret	 = eprs_parse_term(eprs, rule, term_id, off, node, err, term);
+	if (ret) {
+		eprs_choice_store(eprs, term_id, cur, 0, 1);
+	}
+
+	return ret;
+}
+
+// A character class is a token, a single character literal, or a group of one of them or of an alternation of them. Returns the
+// first term of the class and whether the class is made of more than one term.
+static const estx_node_data_t *eprs_chr_class(const eprs_t *eprs, const estx_node_data_t *term, estx_node_t *first, int *alt)
+{
+	*alt = 0;
+
+	if (eprs_chr_one(eprs, term)) {
+		return term;
+	}
+
+	if (term->type != ESTX_TERM_GROUP) {
+		return NULL;
+	}
+
+	estx_node_t child = term->val.terms;
+	const estx_node_data_t *data;
+	if ((data = list_get(&eprs->estx->nodes, child)) == NULL || list_get_next(&eprs->estx->nodes, child, NULL) ||
+	    data->occ != ESTX_TERM_OCC_ONE) {
+		return NULL;
+	}
+
+	if (eprs_chr_one(eprs, data)) {
+		return data;
+	}
+
+	if (data->type != ESTX_TERM_ALT) {
+		return NULL;
+	}
+
+	*first = data->val.terms;
+	const estx_node_data_t *alts;
+	estx_node_t i = data->val.terms;
+	estx_node_foreach(&eprs->estx->nodes, i, alts)
+	{
+		if (alts->occ != ESTX_TERM_OCC_ONE || !eprs_chr_one(eprs, alts)) {
+			return NULL;
+		}
+	}
+
+	*alt = 1;
+	return list_get(&eprs->estx->nodes, *first);
+}
+
+static byte eprs_chr_node(const estx_node_data_t *term)
+{
+	return term->type == ESTX_TERM_TOK ? (byte)(EPRS_CHR_TOK + term->val.tok) : EPRS_CHR_LIT;
+}
+
+// The first term of the class which matches the token decides the node
+static byte eprs_chr_kind(const eprs_t *eprs, const estx_node_data_t *chr, estx_node_t first, int alt, uint type, strv_t val)
+{
+	if (!alt) {
+		return eprs_chr_has(eprs, chr, type, val) ? eprs_chr_node(chr) : EPRS_CHR_NONE;
+	}
+
+	const estx_node_data_t *data;
+	estx_node_t i = first;
+	estx_node_foreach(&eprs->estx->nodes, i, data)
+	{
+		if (eprs_chr_has(eprs, data, type, val)) {
+			return eprs_chr_node(data);
+		}
+	}
+
+	return EPRS_CHR_NONE;
+}
+
+static uint eprs_chr_type(const lex_t *lex, uint c)
+{
+	return c < lex->chars_len ? lex->chars[c] : TOK_UNKNOWN;
+}
+
+// The table of a class is built the first time the class is repeated, and again for another grammar or other character types
+static const eprs_chr_t *eprs_chr_get(eprs_t *eprs, estx_node_t term_id, const estx_node_data_t *chr, estx_node_t first, int alt)
+{
+	if (eprs->chrs_estx != eprs->estx || eprs->chrs_chars != eprs->lex->chars) {
+		eprs->chrs_cnt	 = 0;
+		eprs->chrs_estx	 = eprs->estx;
+		eprs->chrs_chars = eprs->lex->chars;
+	}
+
+	for (uint i = 0; i < eprs->chrs_cnt; i++) {
+		if (eprs->chrs[i].term == term_id) {
+			return &eprs->chrs[i];
+		}
+	}
+
+	if (eprs->chrs_cnt >= eprs->chrs_cap) {
+		uint cap	 = eprs->chrs_cap == 0 ? EPRS_CHRS_CAP : eprs->chrs_cap * 2;
+		eprs_chr_t *chrs = alloc_alloc(&eprs->nodes.alloc, cap * sizeof(eprs_chr_t));
+		if (chrs == NULL) {
+			log_error("cparse", "eprs", NULL, "failed to allocate character class");
+			return NULL;
+		}
+
+		for (uint i = 0; i < eprs->chrs_cnt; i++) {
+			chrs[i] = eprs->chrs[i];
+		}
+
+		if (eprs->chrs) {
+			alloc_free(&eprs->nodes.alloc, eprs->chrs, eprs->chrs_cap * sizeof(eprs_chr_t));
+		}
+		eprs->chrs     = chrs;
+		eprs->chrs_cap = cap;
+	}
+
+	// Characters are typed like the lexer does, which reads them as char
+	eprs_chr_t *table = &eprs->chrs[eprs->chrs_cnt++];
+	table->term	  = term_id;
+	for (uint c = 0; c < 256; c++) {
+		char val       = (char)c;
+		table->kind[c] = eprs_chr_kind(eprs, chr, first, alt, eprs_chr_type(eprs->lex, (uint)val), STRVN(&val, 1));
+	}
+
+	return table;
+}
+
+// Repeats a character class in a loop, without a choice point and error bookkeeping for every character. The node of a character
+// is looked up in the table of the class, only words walk the terms of the class. The nodes are the same as the ones of
+// eprs_parse_term, and the attempt which ends the repetition is left to the caller, so errors are reported the same.
+static uint eprs_chr_rep(eprs_t *eprs, const eprs_chr_t *table, const estx_node_data_t *chr, estx_node_t first, int alt, uint *off,
+			 eprs_node_t node)
+{
+	uint cnt = 0;
+
+	for (;;) {
+		tok_t tok = lex_get_tok(eprs->lex, *off);
+		if (tok.len == 0) {
+			return cnt;
+		}
+
+		strv_t val = lex_get_tok_val(eprs->lex, tok);
+		byte kind;
+		if (tok.len == 1 && tok.type == eprs_chr_type(eprs->lex, (uint)val.data[0])) {
+			kind = table->kind[(byte)val.data[0]];
+		} else {
+			kind = eprs_chr_kind(eprs, chr, first, alt, tok.type, val);
+		}
+		if (kind == EPRS_CHR_NONE) {
+			return cnt;
+		}
+
+		eprs_node_t child;
+		if (kind == EPRS_CHR_LIT) {
+			eprs_node_lit(eprs, *off, 1, &child);
+		} else {
+			eprs_node_tok(eprs, (tok_t){.type = kind - EPRS_CHR_TOK, .start = tok.start, .len = tok.len}, &child);
+		}
+		eprs_add_node(eprs, node, child);
+
+		*off += tok.len;
+		cnt++;
+	}
+}
+
+static int eprs_parse_terms(eprs_t *eprs, estx_node_t rule, estx_node_t term_id, uint *off, eprs_node_t node, eprs_parse_err_t *err,
+			    const estx_node_data_t *term)
+{
+	if (term == NULL) {
+		return 1;
+	}
+	uint cur = *off;
+
+	int one = term->occ == ESTX_TERM_OCC_ONE;
+
+	if (term->type == ESTX_TERM_ALT || term->type == ESTX_TERM_CON || one) {
+		return eprs_parse_term(eprs, rule, term_id, off, node, err, term);
+	}
+
+	// Streamed events are flushed per attempt, so character classes are only repeated in a loop when building or recognizing
+	estx_node_t first = 0;
+	int alt;
+	const estx_node_data_t *chr = eprs->event ? NULL : eprs_chr_class(eprs, term, &first, &alt);
+	const eprs_chr_t *table	    = chr ? eprs_chr_get(eprs, term_id, chr, first, alt) : NULL;
+	if (table && eprs_chr_rep(eprs, table, chr, first, alt, off, node) > 0) {
+		// The attempt after the scan records why the repetition ends. If it matches anyway, like EOF where the scan stops,
+		// its nodes are kept and the scan goes on after them, the same as in the loop below.
+		for (;;) {
+			cur		 = *off;
+			uint nodes_cnt	 = eprs->nodes.cnt;
+			eprs_choice_t cp = eprs_choice_enter(eprs, cur);
+			int ret		 = eprs_parse_attempt(eprs, rule, term_id, off, node, err, term);
+			eprs_choice_exit(eprs, cp);
+			if (ret) {
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 0;
+			}
+
+			if (*off == cur) {
+				log_warn("cparse", "eprs", NULL, "loop detected: %d", cur);
+				return 0;
+			}
+
+			eprs_chr_rep(eprs, table, chr, first, alt, off, node);
+		}
+	}
+
+	// Every attempt of an optional or repeated term is a choice point, a cut inside a failed attempt fails the whole term
+	uint nodes_cnt = eprs->nodes.cnt;
+	byte cut       = err->cut;
+
+	eprs_choice_t choice = eprs_choice_enter(eprs, cur);
+	err->cut	     = 0;
+	int ret		     = eprs_parse_attempt(eprs, rule, term_id, off, node, err, term);
+	eprs_choice_exit(eprs, choice);
+	int opt = (term->occ & ESTX_TERM_OCC_OPT) && !(term->occ & ESTX_TERM_OCC_REP);
+	int rep = !(term->occ & ESTX_TERM_OCC_OPT) && (term->occ & ESTX_TERM_OCC_REP);
+
+	if (ret && err->cut) {
+		log_trace("cparse", "eprs", NULL, "cut: failed");
+		err->cut = cut;
+		*off	 = cur;
+		return 1;
+	}
+
+	err->cut = cut;
+
+	if (ret == 0) {
+		eprs_event_flush(eprs, nodes_cnt);
+	}
 
 	if (ret && opt) {
 		*off = cur;
@@ -391,30 +1684,319 @@ static int eprs_parse_terms(eprs_t *eprs, estx_node_t rule, estx_node_t term_id,
 			log_warn("cparse", "eprs", NULL, "loop detected: %d", cur);
 			break;
 		}
-		cur = *off;
-		ret = eprs_parse_term(eprs, rule, term_id, off, node, err, term);
+		cur	 = *off;
+		err->cut = 0;
+		choice	 = eprs_choice_enter(eprs, cur);
+		ret	 = eprs_parse_attempt(eprs, rule, term_id, off, node, err, term);
+		eprs_choice_exit(eprs, choice);
+		if (ret == 0) {
+			eprs_event_flush(eprs, nodes_cnt);
+		}
+		if (ret && err->cut) {
+			log_trace("cparse", "eprs", NULL, "cut: failed");
+			eprs_reset(eprs, nodes_cnt);
+			err->cut = cut;
+			return 1;
+		}
+		err->cut = cut;
 	}
 
 	*off = cur;
 	return 0;
 }
 
+int eprs_parse_piece(eprs_piece_t *piece)
+{
+	if (piece == NULL) {
+		return 1;
+	}
+
+	eprs_t *eprs  = &piece->eprs;
+	piece->off    = piece->start;
+	piece->look   = piece->start;
+	piece->err    = (eprs_err_t){0};
+	piece->failed = 0;
+	piece->cut    = 0;
+
+	eprs_reset(eprs, 0);
+	eprs_memo_start(eprs);
+
+	estx_node_t terms;
+	const estx_node_data_t *term = list_get_next(&eprs->estx->nodes, piece->rule, &terms);
+	if (term == NULL || eprs_node_rule(eprs, piece->rule, &piece->root)) {
+		return 1;
+	}
+
+	// The last piece runs until its items fail, like the sequential loop, every other piece stops at its end
+	eprs_parse_err_t err = {0};
+	while (piece->off < piece->end || piece->end == eprs->lex->toks.cnt) {
+		uint cur       = piece->off;
+		uint nodes_cnt = eprs->nodes.cnt;
+		err.cut	       = 0;
+		if (eprs_parse_term(eprs, piece->rule, terms, &piece->off, piece->root, &err, term)) {
+			eprs_reset(eprs, nodes_cnt);
+			piece->off = cur;
+			piece->cut = err.cut;
+			break;
+		}
+
+		if (piece->off == cur) {
+			break;
+		}
+	}
+
+	piece->look   = err.look;
+	piece->err    = (eprs_err_t){.rule = err.rule, .tok = err.tok, .exp = err.exp};
+	piece->failed = err.failed;
+
+	log_trace("cparse", "eprs", NULL, "piece [%d, %d): +%d", piece->start, piece->end, piece->off - piece->start);
+	return 0;
+}
+
+// A split rule repeats its single term. The remaining tokens are cut at line starts into pieces which are parsed independently,
+// possibly on other threads through eprs->run. A piece is only trusted if every piece before it ended exactly on its end, as only
+// then it starts where the sequential parse would start an item. Parsing continues sequentially after a piece whose last item
+// crossed its end, and a piece which stopped early ends the repetition.
+static int eprs_parse_split(eprs_t *eprs, estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err)
+{
+	estx_node_t terms;
+	const estx_node_data_t *term = list_get_next(&eprs->estx->nodes, rule, &terms);
+	if (term == NULL || !(term->occ & ESTX_TERM_OCC_REP)) {
+		return eprs_parse_terms(eprs, rule, rule, off, node, err, estx_get_node(eprs->estx, rule));
+	}
+
+	uint cur = *off;
+	uint end = eprs->lex->toks.cnt;
+	uint cnt = 0;
+	for (uint start = cur; cnt < eprs->pieces_cnt && start < end; cnt++) {
+		uint next = cnt + 1 == eprs->pieces_cnt ? end : cur + (uint)((size_t)(end - cur) * (cnt + 1) / eprs->pieces_cnt);
+		next	  = next > start ? next : start + 1;
+		while (next < end && !(lex_get_tok(eprs->lex, next - 1).type & (1 << TOK_NL))) {
+			next++;
+		}
+
+		eprs_piece_t *piece = &eprs->pieces[cnt];
+		piece->eprs.estx    = eprs->estx;
+		piece->eprs.lex	    = eprs->lex;
+		piece->rule	    = rule;
+		piece->start	    = start;
+		piece->end	    = next;
+
+		start = next;
+	}
+
+	if (cnt < 2) {
+		return eprs_parse_terms(eprs, rule, rule, off, node, err, estx_get_node(eprs->estx, rule));
+	}
+
+	if (eprs->run) {
+		eprs->run(eprs->pieces, cnt, eprs->priv);
+	} else {
+		for (uint i = 0; i < cnt; i++) {
+			eprs_parse_piece(&eprs->pieces[i]);
+		}
+	}
+
+	uint nodes_start = eprs->nodes.cnt;
+	int more	 = 0;
+	for (uint i = 0; i < cnt; i++) {
+		const eprs_piece_t *piece = &eprs->pieces[i];
+		if (piece->failed && (!err->failed || piece->err.tok >= err->tok)) {
+			*err = (eprs_parse_err_t){.rule = piece->err.rule, .tok = piece->err.tok, .exp = piece->err.exp, .failed = 1};
+		}
+
+		err->look = piece->look > err->look ? piece->look : err->look;
+		if (piece->cut) {
+			log_trace("cparse", "eprs", NULL, "cut: failed");
+			eprs_reset(eprs, nodes_start);
+			*off = cur;
+			return 1;
+		}
+
+		if (piece->off > piece->start && eprs_copy(&eprs->nodes, node, &piece->eprs.nodes, piece->root, 0)) {
+			eprs_reset(eprs, nodes_start);
+			*off = cur;
+			return 1;
+		}
+
+		*off = piece->off;
+		if (piece->off != piece->end) {
+			more = piece->off > piece->end;
+			break;
+		}
+	}
+
+	while (more) {
+		uint prev	     = *off;
+		uint nodes_cnt	     = eprs->nodes.cnt;
+		eprs_choice_t choice = eprs_choice_enter(eprs, prev);
+		err->cut	     = 0;
+		int ret		     = eprs_parse_term(eprs, rule, terms, off, node, err, term);
+		eprs_choice_exit(eprs, choice);
+		if (ret) {
+			if (err->cut) {
+				log_trace("cparse", "eprs", NULL, "cut: failed");
+				eprs_reset(eprs, nodes_start);
+				*off = cur;
+				return 1;
+			}
+			eprs_reset(eprs, nodes_cnt);
+			*off = prev;
+			break;
+		}
+		more = *off != prev;
+	}
+
+	if (*off == cur && !(term->occ & ESTX_TERM_OCC_OPT)) {
+		log_trace("cparse", "eprs", NULL, "rep: failed");
+		return 1;
+	}
+
+	return 0;
+}
+
 static int eprs_parse_rule(eprs_t *prs, const estx_node_t rule, uint *off, eprs_node_t node, eprs_parse_err_t *err)
 {
 	log_trace("cparse", "eprs", NULL, "<%d>", rule);
 
 	uint cur		     = *off;
+	uint look		     = err->look;
+	byte cut		     = err->cut;
+	uint choices		     = prs->rule_choices;
 	const estx_node_data_t *term = estx_get_node(prs->estx, rule);
-	if (eprs_parse_terms(prs, rule, rule, off, node, err, term)) {
+
+	err->look	  = cur;
+	err->cut	  = 0;
+	prs->rule_choices = prs->choices;
+
+	eprs_frame_t frame = {
+		.parent = prs->frame,
+		.rule	= rule,
+		.node	= node,
+		.start	= cur,
+		.from	= node + 1,
+	};
+	prs->frame = &frame;
+
+	int ret;
+	if (term && (term->flags & ESTX_RULE_FLAG_SPLIT) && prs->pieces_cnt > 1 && prs->prev == NULL && prs->event == NULL && !prs->recognize &&
+	    !prs->guided) {
+		ret = eprs_parse_split(prs, rule, off, node, err);
+	} else if (term && (term->flags & ESTX_RULE_FLAG_LEX) && !prs->recognize) {
+		// A lexical rule is only recognized and becomes a single node spanning its tokens, nothing inside it is streamed
+		eprs_event_cb event = prs->event;
+		prs->event	    = NULL;
+		prs->recognize	    = 1;
+		ret		    = eprs_parse_terms(prs, rule, rule, off, node, err, term);
+		prs->recognize	    = 0;
+		prs->event	    = event;
+	} else {
+		ret = eprs_parse_terms(prs, rule, rule, off, node, err, term);
+	}
+
+	if (ret == 0) {
+		eprs_event_exit(prs, &frame, *off - cur);
+	}
+	prs->frame = frame.parent;
+
+	uint rule_look	  = err->look;
+	err->look	  = look > err->look ? look : err->look;
+	err->cut	  = cut;
+	prs->rule_choices = choices;
+
+	if (ret) {
 		log_trace("cparse", "eprs", NULL, "<%d>: failed", rule);
 		*off = cur;
 		return 1;
 	}
 
+	// While recognizing node is 0, which is the root of the tree
+	eprs_node_data_t *data = prs->recognize ? NULL : tree_get(&prs->nodes, node);
+	if (data) {
+		data->val.rule.start = cur;
+		data->val.rule.len   = *off - cur;
+		data->val.rule.look  = rule_look;
+	}
+
 	log_trace("cparse", "eprs", NULL, "<%d>: success +%d", rule, *off - cur);
 	return 0;
 }
 
+size_t eprs_print_err(const eprs_t *eprs, eprs_err_t err, dst_t dst)
+{
+	if (eprs == NULL || eprs->lex == NULL || eprs->estx == NULL) {
+		return 0;
+	}
+
+	size_t off = dst.off;
+
+	const estx_node_data_t *term	  = estx_get_node(eprs->estx, err.exp);
+	const estx_node_data_t *rule_data = estx_get_node(eprs->estx, err.rule);
+	strv_t rule_name		  = STRV("<unknown>");
+	if (rule_data != NULL && rule_data->type == ESTX_RULE) {
+		rule_name = strvbuf_get(&eprs->estx->strs, rule_data->val.name);
+	}
+
+	// The location is found by the byte the token starts at, the end of the source for EOF
+	tok_t got      = lex_get_tok(eprs->lex, err.tok);
+	size_t start   = err.tok < eprs->lex->toks.cnt ? got.start : eprs->lex->src.len;
+	tok_loc_t loc  = lex_get_tok_loc(eprs->lex, (uint)start);
+	strv_t got_str = lex_get_tok_val(eprs->lex, got);
+
+	dst.off += lex_tok_loc_print_loc(eprs->lex, loc, dst);
+
+	if (term == NULL) {
+		dst.off += dputf(dst, "error: in rule '%.*s': got '%.*s'\n", rule_name.len, rule_name.data, got_str.len, got_str.data);
+	} else if (term->type == ESTX_TERM_SET) {
+		dst.off += dputf(dst, "error: in rule '%.*s': expected ", rule_name.len, rule_name.data);
+		dst.off += tok_set_print(estx_data_set(eprs->estx, term), dst);
+		dst.off += dputf(dst, ", got '%.*s'\n", got_str.len, got_str.data);
+	} else if (term->type == ESTX_TERM_TOK) {
+		char buf[32] = {0};
+		size_t len   = tok_type_print(1 << term->val.tok, DST_BUF(buf));
+		dst.off += dputf(dst,
+				 "error: in rule '%.*s': expected %.*s, got '%.*s'\n",
+				 rule_name.len,
+				 rule_name.data,
+				 (int)len,
+				 buf,
+				 got_str.len,
+				 got_str.data);
+
+	} else {
+		strv_t exp_str = estx_data_lit(eprs->estx, term);
+		dst.off += dputf(dst,
+				 "error: in rule '%.*s': expected \'%.*s\', got '%.*s'\n",
+				 rule_name.len,
+				 rule_name.data,
+				 exp_str.len,
+				 exp_str.data,
+				 got_str.len,
+				 got_str.data);
+	}
+
+	dst.off += lex_tok_loc_print_src(eprs->lex, loc, dst);
+
+	return dst.off - off;
+}
+
+static int eprs_parse_root(eprs_t *eprs, estx_node_t rule, eprs_node_t *root, eprs_parse_err_t *err)
+{
+	eprs_reset(eprs, 0);
+	if (!eprs->guided) {
+		eprs_memo_start(eprs);
+	}
+
+	*err = (eprs_parse_err_t){0};
+
+	uint parsed = 0;
+	if (eprs_node_rule(eprs, rule, root) || eprs_parse_rule(eprs, rule, &parsed, *root, err) || parsed != eprs->lex->toks.cnt) {
+		return 1;
+	}
+
+	return 0;
+}
+
 int eprs_parse(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_node_t *root, dst_t dst)
 {
 	if (eprs == NULL || lex == NULL || estx == NULL) {
@@ -424,60 +2006,129 @@ int eprs_parse(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t r
 	eprs->lex  = lex;
 	eprs->estx = estx;
 
-	eprs_reset(eprs, 0);
-
 	eprs_parse_err_t err = {0};
 
 	eprs_node_t tmp;
-	eprs_node_rule(eprs, rule, &tmp);
-	uint parsed = 0;
-	if (eprs_parse_rule(eprs, rule, &parsed, tmp, &err) || parsed != eprs->lex->toks.cnt) {
+	if (eprs_parse_root(eprs, rule, &tmp, &err)) {
 		if (!err.failed) {
 			log_error("cparse", "eprs", NULL, "wrong syntax");
 			return 1;
 		}
 
-		const estx_node_data_t *term	  = estx_get_node(eprs->estx, err.exp);
-		const estx_node_data_t *rule_data = estx_get_node(eprs->estx, err.rule);
-		strv_t rule_name		  = STRV("<unknown>");
-		if (rule_data != NULL && rule_data->type == ESTX_RULE) {
-			rule_name = strvbuf_get(&eprs->estx->strs, rule_data->val.name);
-		}
+		eprs_print_err(eprs, (eprs_err_t){.rule = err.rule, .tok = err.tok, .exp = err.exp}, dst);
+		return 1;
+	}
+
+	if (root) {
+		*root = tmp;
+	}
+
+	log_trace("cparse", "eprs", NULL, "success");
+	return 0;
+}
 
-		tok_loc_t loc  = lex_get_tok_loc(eprs->lex, err.tok);
-		tok_t got      = lex_get_tok(eprs->lex, err.tok);
-		strv_t got_str = lex_get_tok_val(eprs->lex, got);
+int eprs_recognize(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, dst_t dst)
+{
+	if (eprs == NULL) {
+		return 1;
+	}
 
-		dst.off += lex_tok_loc_print_loc(eprs->lex, loc, dst);
+	eprs->recognize = 1;
+	int ret		= eprs_parse(eprs, lex, estx, rule, NULL, dst);
+	eprs->recognize = 0;
 
-		if (term->type == ESTX_TERM_TOK) {
-			char buf[32] = {0};
-			size_t len   = tok_type_print(1 << term->val.tok, DST_BUF(buf));
-			dst.off += dputf(dst,
-					 "error: in rule '%.*s': expected %.*s, got '%.*s'\n",
-					 rule_name.len,
-					 rule_name.data,
-					 (int)len,
-					 buf,
-					 got_str.len,
-					 got_str.data);
+	return ret;
+}
 
-		} else {
-			strv_t exp_str = estx_data_lit(eprs->estx, term);
-			dst.off += dputf(dst,
-					 "error: in rule '%.*s': expected \'%.*s\', got '%.*s'\n",
-					 rule_name.len,
-					 rule_name.data,
-					 exp_str.len,
-					 exp_str.data,
-					 got_str.len,
-					 got_str.data);
+int eprs_parse_two_phase(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_node_t *root, dst_t dst)
+{
+	if (eprs_recognize(eprs, lex, estx, rule, dst)) {
+		return 1;
+	}
+
+	eprs->guided = 1;
+	int ret	     = eprs_parse(eprs, lex, estx, rule, root, dst);
+	eprs->guided = 0;
+
+	return ret;
+}
+
+int eprs_parse_events(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_event_cb cb, void *priv, dst_t dst)
+{
+	if (eprs == NULL || lex == NULL || estx == NULL || cb == NULL) {
+		return 1;
+	}
+
+	eprs->lex	 = lex;
+	eprs->estx	 = estx;
+	eprs->event	 = cb;
+	eprs->event_priv = priv;
+	eprs->event_err	 = 0;
+
+	eprs_parse_err_t err = {0};
+
+	eprs_node_t root;
+	int ret = eprs_parse_root(eprs, rule, &root, &err);
+
+	eprs->event	 = NULL;
+	eprs->event_priv = NULL;
+
+	if (ret) {
+		if (!err.failed) {
+			log_error("cparse", "eprs", NULL, "wrong syntax");
+			return 1;
 		}
 
-		dst.off += lex_tok_loc_print_src(eprs->lex, loc, dst);
+		eprs_print_err(eprs, (eprs_err_t){.rule = err.rule, .tok = err.tok, .exp = err.exp}, dst);
+		return 1;
+	}
+
+	if (eprs->event_err) {
+		log_error("cparse", "eprs", NULL, "event callback failed");
+		return 1;
+	}
+
+	log_trace("cparse", "eprs", NULL, "success");
+	return 0;
+}
+
+int eprs_reparse(eprs_t *eprs, const lex_t *lex, estx_node_t rule, eprs_edit_t edit, eprs_node_t *root, dst_t dst)
+{
+	if (eprs == NULL || lex == NULL || eprs->estx == NULL) {
+		return 1;
+	}
+
+	const eprs_node_data_t *data = tree_get(&eprs->nodes, 0);
+	if (data == NULL || data->type != EPRS_NODE_RULE || data->val.rule.id != rule || data->val.rule.start != 0 ||
+	    edit.start + edit.old_len > data->val.rule.len || data->val.rule.len - edit.old_len + edit.new_len != lex->toks.cnt) {
+		log_trace("cparse", "eprs", NULL, "previous tree not reusable");
+		return eprs_parse(eprs, lex, eprs->estx, rule, root, dst);
+	}
+
+	tree_t prev = eprs->nodes;
+	if (tree_init(&eprs->nodes, prev.cnt, sizeof(eprs_node_data_t), prev.alloc) == NULL) {
+		eprs->nodes = prev;
+		log_error("cparse", "eprs", NULL, "failed to initialize nodes tree");
 		return 1;
 	}
 
+	eprs->lex  = lex;
+	eprs->prev = &prev;
+	eprs->edit = edit;
+
+	eprs_parse_err_t err = {0};
+
+	eprs_node_t tmp;
+	int ret = eprs_parse_root(eprs, rule, &tmp, &err);
+
+	eprs->prev = NULL;
+	tree_free(&prev);
+
+	if (ret) {
+		// The errors are only exact when no subtree was reused
+		return eprs_parse(eprs, lex, eprs->estx, rule, root, dst);
+	}
+
 	if (root) {
 		*root = tmp;
 	}
@@ -486,6 +2137,166 @@ int eprs_parse(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t r
 	return 0;
 }
 
+// Returns the token of lex which holds the byte at off, or the end of the tokens
+static uint eprs_tok_at(const lex_t *lex, size_t off)
+{
+	uint lo = 0;
+	uint hi = lex->toks.cnt;
+	while (lo < hi) {
+		uint mid  = lo + (hi - lo) / 2;
+		tok_t tok = lex_get_tok(lex, mid);
+		if (off < tok.start) {
+			hi = mid;
+		} else if (off >= tok.start + tok.len) {
+			lo = mid + 1;
+		} else {
+			return mid;
+		}
+	}
+
+	return lo;
+}
+
+int eprs_parse_errs(eprs_t *eprs, const lex_t *lex, const estx_t *estx, estx_node_t rule, eprs_err_t *errs, uint errs_cap, uint *errs_cnt,
+		    dst_t dst)
+{
+	if (errs_cnt) {
+		*errs_cnt = 0;
+	}
+
+	if (eprs == NULL || lex == NULL || estx == NULL) {
+		return 1;
+	}
+
+	eprs->lex  = lex;
+	eprs->estx = estx;
+
+	eprs_parse_err_t err = {0};
+
+	eprs_node_t root;
+	if (eprs_parse_root(eprs, rule, &root, &err) == 0) {
+		return 0;
+	}
+
+	// Every failed pass drops the line holding the farthest failure and parses the remaining source again. The copy keeps the
+	// original offset of each remaining byte so that the collected errors point into the source of lex.
+	size_t len     = lex->src.len;
+	char *src      = alloc_alloc(&eprs->nodes.alloc, len + 1);
+	uint *src_offs = alloc_alloc(&eprs->nodes.alloc, (len + 1) * sizeof(uint));
+	if (src == NULL || src_offs == NULL) {
+		alloc_free(&eprs->nodes.alloc, src, len + 1);
+		alloc_free(&eprs->nodes.alloc, src_offs, (len + 1) * sizeof(uint));
+		log_error("cparse", "eprs", NULL, "failed to allocate recovery buffer");
+		return 1;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		src[i]	    = lex->src.data[i];
+		src_offs[i] = (uint)i;
+	}
+	src_offs[len] = (uint)len;
+
+	uint words_cnt = 0;
+	uint i	       = 0;
+	strv_t word;
+	strbuf_foreach(&lex->words, i, word)
+	{
+		words_cnt++;
+	}
+
+	lex_t rlex = {0};
+	if (lex_init(&rlex, words_cnt, lex->toks.cnt + 1, eprs->nodes.alloc) == NULL) {
+		alloc_free(&eprs->nodes.alloc, src, len + 1);
+		alloc_free(&eprs->nodes.alloc, src_offs, (len + 1) * sizeof(uint));
+		log_error("cparse", "eprs", NULL, "failed to initialize recovery lexer");
+		return 1;
+	}
+
+	i = 0;
+	strbuf_foreach(&lex->words, i, word)
+	{
+		lex_add_word(&rlex, word, NULL);
+	}
+
+	uint cnt = 0;
+	int ret	 = 0;
+	while (1) {
+		if (!err.failed) {
+			log_error("cparse", "eprs", NULL, "wrong syntax");
+			ret = 1;
+			break;
+		}
+
+		// The failure is a token of the lexer of the pass. Its start is mapped back to the source of lex and to the token there.
+		size_t off = err.tok < eprs->lex->toks.cnt ? lex_get_tok(eprs->lex, err.tok).start : len;
+
+		eprs->lex    = lex;
+		eprs_err_t e = {.rule = err.rule, .tok = eprs_tok_at(lex, src_offs[off]), .exp = err.exp};
+		dst.off += eprs_print_err(eprs, e, dst);
+		if (cnt < errs_cap && errs) {
+			errs[cnt] = e;
+		}
+		cnt++;
+
+		if (cnt >= errs_cap) {
+			break;
+		}
+
+		size_t line_start = off;
+		while (line_start > 0 && src[line_start - 1] != '\n') {
+			line_start--;
+		}
+
+		size_t line_end = off;
+		while (line_end < len && src[line_end] != '\n') {
+			line_end++;
+		}
+		if (line_end < len) {
+			line_end++;
+		}
+
+		if (line_end == line_start) {
+			break;
+		}
+
+		for (size_t j = line_end; j <= len; j++) {
+			src[line_start + j - line_end]	    = src[j];
+			src_offs[line_start + j - line_end] = src_offs[j];
+		}
+		len -= line_end - line_start;
+
+		lex_reset(&rlex);
+		i = 0;
+		strbuf_foreach(&lex->words, i, word)
+		{
+			lex_add_word(&rlex, word, NULL);
+		}
+
+		if (lex_tokenize(&rlex, STRVN(src, len), lex->file, lex->line_off)) {
+			ret = 1;
+			break;
+		}
+
+		eprs->lex = &rlex;
+		if (eprs_parse_root(eprs, rule, &root, &err) == 0) {
+			break;
+		}
+	}
+
+	eprs->lex = lex;
+	eprs_reset(eprs, 0);
+
+	lex_free(&rlex);
+	alloc_free(&eprs->nodes.alloc, src, lex->src.len + 1);
+	alloc_free(&eprs->nodes.alloc, src_offs, (lex->src.len + 1) * sizeof(uint));
+
+	if (errs_cnt) {
+		*errs_cnt = cnt < errs_cap ? cnt : errs_cap;
+	}
+
+	return ret || cnt > 0;
+}
+
 static size_t print_nodes(void *data, dst_t dst, const void *priv)
 {
 	const eprs_t *eprs = priv;
@@ -495,7 +2306,7 @@ static size_t print_nodes(void *data, dst_t dst, const void *priv)
 	const eprs_node_data_t *node = data;
 	switch (node->type) {
 	case EPRS_NODE_RULE: {
-		dst.off += dputf(dst, "%d\n", node->val.rule);
+		dst.off += dputf(dst, "%d\n", node->val.rule.id);
 		break;
 	}
 	case EPRS_NODE_TOKEN: {
@@ -512,6 +2323,13 @@ static size_t print_nodes(void *data, dst_t dst, const void *priv)
 		dst.off += dputf(dst, "\'%.*s\'\n", val_len, val);
 		break;
 	}
+	case EPRS_NODE_OP: {
+		tok_t tok      = {.start = node->val.op.start, .len = node->val.op.len};
+		char val[32]   = {0};
+		size_t val_len = strv_print(lex_get_tok_val(eprs->lex, tok), DST_BUF(val));
+		dst.off += dputf(dst, "op(%.*s)\n", val_len, val);
+		break;
+	}
 	default: break;
 	}
 
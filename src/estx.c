@@ -1,6 +1,10 @@
 #include "estx.h"
 
 #include "log.h"
+#include "mem.h"
+
+#define ESTX_RULES_CAP	16
+#define ESTX_RULES_NONE ((estx_node_t)-1)
 
 estx_t *estx_init(estx_t *estx, uint nodes_cap, alloc_t alloc)
 {
@@ -14,6 +18,12 @@ estx_t *estx_init(estx_t *estx, uint nodes_cap, alloc_t alloc)
 		return NULL;
 	}
 
+	estx->rules	= NULL;
+	estx->rules_cap = 0;
+	estx->rules_cnt = 0;
+	estx->infos	= NULL;
+	estx->infos_cnt = 0;
+
 	return estx;
 }
 
@@ -23,16 +33,117 @@ void estx_free(estx_t *estx)
 		return;
 	}
 
+	if (estx->rules) {
+		alloc_free(&estx->nodes.alloc, estx->rules, estx->rules_cap * sizeof(estx_node_t));
+		estx->rules = NULL;
+	}
+
+	if (estx->infos) {
+		alloc_free(&estx->nodes.alloc, estx->infos, estx->infos_cnt * sizeof(estx_info_t));
+		estx->infos = NULL;
+	}
+
 	list_free(&estx->nodes);
 	strvbuf_free(&estx->strs);
 }
 
+// Rules are indexed by name in an open addressing table of node ids, so looking up a rule does not scan all nodes
+static uint estx_rules_hash(strv_t name, uint cap)
+{
+	uint hash = 2166136261u;
+	for (size_t i = 0; i < name.len; i++) {
+		hash = (hash ^ (byte)name.data[i]) * 16777619u;
+	}
+
+	return hash & (cap - 1);
+}
+
+static strv_t estx_rules_name(const estx_t *estx, estx_node_t rule)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, rule);
+	return strvbuf_get(&estx->strs, data->val.name);
+}
+
+static void estx_rules_set(const estx_t *estx, estx_node_t *rules, uint cap, estx_node_t rule)
+{
+	uint i = estx_rules_hash(estx_rules_name(estx, rule), cap);
+	while (rules[i] != ESTX_RULES_NONE) {
+		i = (i + 1) & (cap - 1);
+	}
+	rules[i] = rule;
+}
+
+// Makes room for one more rule beforehand, so adding a created rule to the index can not fail
+static int estx_rules_reserve(estx_t *estx)
+{
+	if ((estx->rules_cnt + 1) * 4 <= estx->rules_cap * 3) {
+		return 0;
+	}
+
+	uint cap	   = estx->rules_cap == 0 ? ESTX_RULES_CAP : estx->rules_cap * 2;
+	estx_node_t *rules = alloc_alloc(&estx->nodes.alloc, cap * sizeof(estx_node_t));
+	if (rules == NULL) {
+		log_error("cparse", "estx", NULL, "failed to allocate rules index");
+		return 1;
+	}
+
+	mem_set(rules, 0xff, cap * sizeof(estx_node_t));
+
+	for (uint i = 0; i < estx->rules_cap; i++) {
+		if (estx->rules[i] != ESTX_RULES_NONE) {
+			estx_rules_set(estx, rules, cap, estx->rules[i]);
+		}
+	}
+
+	if (estx->rules) {
+		alloc_free(&estx->nodes.alloc, estx->rules, estx->rules_cap * sizeof(estx_node_t));
+	}
+
+	estx->rules	= rules;
+	estx->rules_cap = cap;
+	return 0;
+}
+
+static int estx_rules_find(const estx_t *estx, strv_t name, estx_node_t *rule)
+{
+	if (estx->rules == NULL) {
+		return 1;
+	}
+
+	for (uint i = estx_rules_hash(name, estx->rules_cap);; i = (i + 1) & (estx->rules_cap - 1)) {
+		if (estx->rules[i] == ESTX_RULES_NONE) {
+			return 1;
+		}
+
+		if (strv_eq(estx_rules_name(estx, estx->rules[i]), name)) {
+			*rule = estx->rules[i];
+			return 0;
+		}
+	}
+}
+
+// The first rule with a name is the one found, later rules with the same name are not indexed
+static void estx_rules_add(estx_t *estx, estx_node_t rule)
+{
+	estx_node_t found;
+	if (estx_rules_find(estx, estx_rules_name(estx, rule), &found) == 0) {
+		return;
+	}
+
+	estx_rules_set(estx, estx->rules, estx->rules_cap, rule);
+	estx->rules_cnt++;
+}
+
 int estx_rule(estx_t *estx, strv_t name, estx_node_t *rule)
 {
 	if (estx == NULL) {
 		return 1;
 	}
 
+	if (estx_rules_reserve(estx)) {
+		return 1;
+	}
+
 	size_t rule_name;
 	size_t used = estx->strs.used;
 	if (strvbuf_add(&estx->strs, name, &rule_name)) {
@@ -40,7 +151,8 @@ int estx_rule(estx_t *estx, strv_t name, estx_node_t *rule)
 		return 1;
 	}
 
-	estx_node_data_t *data = list_node(&estx->nodes, rule);
+	estx_node_t id;
+	estx_node_data_t *data = list_node(&estx->nodes, &id);
 	if (data == NULL) {
 		strvbuf_reset(&estx->strs, used);
 		log_error("cparse", "stx", NULL, "failed to add rule");
@@ -52,13 +164,33 @@ int estx_rule(estx_t *estx, strv_t name, estx_node_t *rule)
 		.val.name = rule_name,
 	};
 
+	estx_rules_add(estx, id);
+
 	if (rule) {
+		*rule = id;
 		log_trace("cparse", "estx", NULL, "created rule('%.*s'): %d", name.len, name.data, *rule);
 	}
 
 	return 0;
 }
 
+int estx_rule_set_flags(estx_t *estx, estx_node_t rule, estx_rule_flag_t flags)
+{
+	if (estx == NULL) {
+		return 1;
+	}
+
+	estx_node_data_t *data = estx_get_node(estx, rule);
+	if (data == NULL || data->type != ESTX_RULE) {
+		log_error("cparse", "estx", NULL, "invalid rule: %d", rule);
+		return 1;
+	}
+
+	data->flags |= flags;
+
+	return 0;
+}
+
 int estx_term_rule(estx_t *estx, estx_node_t rule, estx_node_occ_t occ, estx_node_t *term)
 {
 	if (estx == NULL) {
@@ -221,27 +353,177 @@ int estx_term_group(estx_t *estx, estx_node_t terms, estx_node_occ_t occ, estx_n
 	return 0;
 }
 
-int estx_find_rule(estx_t *estx, strv_t name, estx_node_t *rule)
+int estx_term_expr(estx_t *estx, estx_node_t rule, estx_node_t ops, estx_node_occ_t occ, estx_node_t *term)
 {
 	if (estx == NULL) {
 		return 1;
 	}
 
-	uint i = 0;
-	const estx_node_data_t *node;
-	estx_node_foreach_all(&estx->nodes, i, node)
-	{
-		if (node->type != ESTX_RULE) {
-			continue;
-		}
+	estx_node_data_t *data = estx_get_node(estx, rule);
+	if (data == NULL || data->type != ESTX_RULE) {
+		log_error("cparse", "estx", NULL, "invalid rule: %d", rule);
+		return 1;
+	}
 
-		if (strv_eq(strvbuf_get(&estx->strs, node->val.name), name)) {
-			*rule = i;
-			return 0;
-		}
+	data = estx_get_node(estx, ops);
+	if (data == NULL || data->type != ESTX_OP) {
+		log_error("cparse", "estx", NULL, "invalid operator: %d", ops);
+		return 1;
+	}
+
+	data = list_node(&estx->nodes, term);
+	if (data == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create expr term");
+		return 1;
+	}
+
+	*data = (estx_node_data_t){
+		.type	       = ESTX_TERM_EXPR,
+		.val.expr.rule = rule,
+		.val.expr.ops  = ops,
+		.occ	       = occ,
+	};
+
+	if (term) {
+		log_trace("cparse", "estx", NULL, "created expr(%d, %d) term: %d", rule, ops, *term);
+	}
+
+	return 0;
+}
+
+int estx_term_cut(estx_t *estx, estx_node_t *term)
+{
+	if (estx == NULL) {
+		return 1;
+	}
+
+	estx_node_data_t *data = list_node(&estx->nodes, term);
+	if (data == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create cut term");
+		return 1;
+	}
+
+	*data = (estx_node_data_t){
+		.type = ESTX_TERM_CUT,
+	};
+
+	if (term) {
+		log_trace("cparse", "estx", NULL, "created cut term: %d", *term);
+	}
+
+	return 0;
+}
+
+int estx_term_set(estx_t *estx, const tok_set_t *set, estx_node_occ_t occ, estx_node_t *term)
+{
+	if (estx == NULL || set == NULL) {
+		return 1;
+	}
+
+	size_t off;
+	size_t used = estx->strs.used;
+	if (strvbuf_add(&estx->strs, STRVN((const char *)set->bits, sizeof(set->bits)), &off)) {
+		log_error("cparse", "estx", NULL, "failed to add set");
+		return 1;
+	}
+
+	estx_node_data_t *data = list_node(&estx->nodes, term);
+	if (data == NULL) {
+		strvbuf_reset(&estx->strs, used);
+		log_error("cparse", "estx", NULL, "failed to create set term");
+		return 1;
+	}
+
+	*data = (estx_node_data_t){
+		.type	 = ESTX_TERM_SET,
+		.val.set = off,
+		.occ	 = occ,
+	};
+
+	if (term) {
+		log_trace("cparse", "estx", NULL, "created set term: %d", *term);
+	}
+
+	return 0;
+}
+
+// The separator follows the element in list.terms, which is in the place of terms, so a list is walked like the other terms with
+// children
+int estx_term_list(estx_t *estx, estx_node_t elem, estx_node_t sep, uint min, int keep, estx_node_occ_t occ, estx_node_t *term)
+{
+	if (estx_get_node(estx, elem) == NULL || estx_get_node(estx, sep) == NULL) {
+		return 1;
+	}
+
+	estx_node_data_t *data = list_node(&estx->nodes, term);
+	if (data == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create list term");
+		return 1;
+	}
+
+	list_app(&estx->nodes, elem, sep);
+
+	*data = (estx_node_data_t){
+		.type		= ESTX_TERM_LIST,
+		.val.list.terms = elem,
+		.val.list.min	= min,
+		.val.list.keep	= keep,
+		.occ		= occ,
+	};
+
+	if (term) {
+		log_trace("cparse", "estx", NULL, "created list(%d, %d) term: %d", elem, sep, *term);
+	}
+
+	return 0;
+}
+
+int estx_op(estx_t *estx, strv_t str, estx_op_type_t type, uint prec, estx_node_t *op)
+{
+	if (estx == NULL) {
+		return 1;
+	}
+
+	if (str.len == 0) {
+		log_error("cparse", "estx", NULL, "empty operator");
+		return 1;
+	}
+
+	size_t lit;
+	size_t used = estx->strs.used;
+	if (strvbuf_add(&estx->strs, str, &lit)) {
+		log_error("cparse", "estx", NULL, "failed to add operator");
+		return 1;
+	}
+
+	estx_node_data_t *data = list_node(&estx->nodes, op);
+	if (data == NULL) {
+		strvbuf_reset(&estx->strs, used);
+		log_error("cparse", "estx", NULL, "failed to create operator");
+		return 1;
+	}
+
+	*data = (estx_node_data_t){
+		.type	     = ESTX_OP,
+		.val.op.lit  = lit,
+		.val.op.prec = prec,
+		.val.op.type = type,
+	};
+
+	if (op) {
+		log_trace("cparse", "estx", NULL, "created operator('%.*s', %d, %d): %d", str.len, str.data, type, prec, *op);
+	}
+
+	return 0;
+}
+
+int estx_find_rule(estx_t *estx, strv_t name, estx_node_t *rule)
+{
+	if (estx == NULL) {
+		return 1;
 	}
 
-	return 1;
+	return estx_rules_find(estx, name, rule);
 }
 
 estx_node_data_t *estx_get_node(const estx_t *estx, estx_node_t node)
@@ -261,11 +543,24 @@ estx_node_data_t *estx_get_node(const estx_t *estx, estx_node_t node)
 
 strv_t estx_data_lit(const estx_t *estx, const estx_node_data_t *data)
 {
-	if (estx == NULL || data == NULL || data->type != ESTX_TERM_LIT) {
+	if (estx == NULL || data == NULL) {
 		return STRV_NULL;
 	}
 
-	return strvbuf_get(&estx->strs, data->val.lit);
+	switch (data->type) {
+	case ESTX_TERM_LIT: return strvbuf_get(&estx->strs, data->val.lit);
+	case ESTX_OP: return strvbuf_get(&estx->strs, data->val.op.lit);
+	default: return STRV_NULL;
+	}
+}
+
+const tok_set_t *estx_data_set(const estx_t *estx, const estx_node_data_t *data)
+{
+	if (estx == NULL || data == NULL || data->type != ESTX_TERM_SET) {
+		return NULL;
+	}
+
+	return (const tok_set_t *)strvbuf_get(&estx->strs, data->val.set).data;
 }
 
 int estx_add_term(estx_t *estx, estx_node_t node, estx_node_t term)
@@ -301,6 +596,56 @@ static size_t estx_term_occ_print(estx_node_occ_t occ, dst_t dst)
 	return 0;
 }
 
+static size_t estx_op_print(const estx_t *estx, const estx_node_data_t *op, dst_t dst)
+{
+	size_t off = dst.off;
+
+	strv_t lit = estx_data_lit(estx, op);
+	if (strv_eq(lit, STRV("'"))) {
+		dst.off += dputf(dst, "\"%.*s\" %d", lit.len, lit.data, op->val.op.prec);
+	} else {
+		dst.off += dputf(dst, "'%.*s' %d", lit.len, lit.data, op->val.op.prec);
+	}
+
+	switch (op->val.op.type) {
+	case ESTX_OP_PREFIX: dst.off += dputs(dst, STRV(" prefix")); break;
+	case ESTX_OP_LEFT: dst.off += dputs(dst, STRV(" left")); break;
+	case ESTX_OP_RIGHT: dst.off += dputs(dst, STRV(" right")); break;
+	default: break;
+	}
+
+	return dst.off - off;
+}
+
+static size_t estx_term_print(const estx_t *estx, const estx_node_data_t *term, dst_t dst);
+
+// An alternation in a sequence of more than one term is put in parentheses
+static size_t estx_seq_print(const estx_t *estx, estx_node_t terms, dst_t dst)
+{
+	size_t off = dst.off;
+
+	int paren = list_get_next(&estx->nodes, terms, NULL) != NULL;
+	int first = 1;
+	const estx_node_data_t *data;
+	list_foreach(&estx->nodes, terms, data)
+	{
+		if (!first) {
+			dst.off += dputs(dst, STRV(" "));
+		}
+
+		if (paren && data->type == ESTX_TERM_ALT) {
+			dst.off += dputs(dst, STRV("("));
+			dst.off += estx_term_print(estx, data, dst);
+			dst.off += dputs(dst, STRV(")"));
+		} else {
+			dst.off += estx_term_print(estx, data, dst);
+		}
+		first = 0;
+	}
+
+	return dst.off - off;
+}
+
 static size_t estx_term_print(const estx_t *estx, const estx_node_data_t *term, dst_t dst)
 {
 	size_t off = dst.off;
@@ -331,6 +676,11 @@ static size_t estx_term_print(const estx_t *estx, const estx_node_data_t *term,
 		dst.off += estx_term_occ_print(term->occ, dst);
 		break;
 	}
+	case ESTX_TERM_SET: {
+		dst.off += tok_set_print(estx_data_set(estx, term), dst);
+		dst.off += estx_term_occ_print(term->occ, dst);
+		break;
+	}
 	case ESTX_TERM_ALT: {
 		int first = 1;
 		const estx_node_data_t *data;
@@ -346,33 +696,53 @@ static size_t estx_term_print(const estx_t *estx, const estx_node_data_t *term,
 		}
 		break;
 	}
-	case ESTX_TERM_CON: {
+	case ESTX_TERM_CON: dst.off += estx_seq_print(estx, term->val.terms, dst); break;
+	case ESTX_TERM_GROUP: {
+		dst.off += dputs(dst, STRV("("));
+		dst.off += estx_seq_print(estx, term->val.terms, dst);
+		dst.off += dputs(dst, STRV(")"));
+		dst.off += estx_term_occ_print(term->occ, dst);
+		break;
+	}
+	case ESTX_TERM_EXPR: {
+		const estx_node_data_t *rule = list_get(&estx->nodes, term->val.expr.rule);
+		if (rule == NULL) {
+			break;
+		}
+		dst.off += dputs(dst, strvbuf_get(&estx->strs, rule->val.name));
+		dst.off += dputs(dst, STRV("("));
 		int first = 1;
 		const estx_node_data_t *data;
-		estx_node_t terms = term->val.terms;
-		list_foreach(&estx->nodes, terms, data)
+		estx_node_t ops = term->val.expr.ops;
+		list_foreach(&estx->nodes, ops, data)
 		{
 			if (!first) {
-				dst.off += dputs(dst, STRV(" "));
+				dst.off += dputs(dst, STRV(" | "));
 			}
 
-			dst.off += estx_term_print(estx, data, dst);
+			dst.off += estx_op_print(estx, data, dst);
 			first = 0;
 		}
+		dst.off += dputs(dst, STRV(")"));
+		dst.off += estx_term_occ_print(term->occ, dst);
 		break;
 	}
-	case ESTX_TERM_GROUP: {
-		const estx_node_data_t *data;
-		estx_node_t terms = term->val.terms;
-		dst.off += dputs(dst, STRV("("));
-		list_foreach(&estx->nodes, terms, data)
-		{
-			dst.off += estx_term_print(estx, data, dst);
+	case ESTX_TERM_LIST: {
+		estx_node_t sep;
+		const estx_node_data_t *elem = list_get(&estx->nodes, term->val.list.terms);
+		const estx_node_data_t *data = list_get_next(&estx->nodes, term->val.list.terms, &sep);
+		if (elem == NULL || data == NULL) {
+			break;
 		}
-		dst.off += dputs(dst, STRV(")"));
+		dst.off += dputs(dst, STRV("list("));
+		dst.off += estx_term_print(estx, elem, dst);
+		dst.off += dputs(dst, STRV(", "));
+		dst.off += estx_term_print(estx, data, dst);
+		dst.off += dputf(dst, ", %d%s)", term->val.list.min, term->val.list.keep ? ", keep" : "");
 		dst.off += estx_term_occ_print(term->occ, dst);
 		break;
 	}
+	case ESTX_TERM_CUT: dst.off += dputs(dst, STRV("~")); break;
 	default: log_warn("cparse", "estx", NULL, "unknown term type: %d", term->type); break;
 	}
 
@@ -395,6 +765,14 @@ size_t estx_print(const estx_t *estx, dst_t dst)
 			continue;
 		}
 
+		if (node->flags & ESTX_RULE_FLAG_LEX) {
+			dst.off += dputs(dst, STRV("@lex "));
+		}
+
+		if (node->flags & ESTX_RULE_FLAG_INLINE) {
+			dst.off += dputs(dst, STRV("@inline "));
+		}
+
 		strv_t name = strvbuf_get(&estx->strs, node->val.name);
 		dst.off += dputf(dst, "%.*s = ", name.len, name.data);
 
@@ -494,6 +872,70 @@ static size_t estx_node_print_tree(const estx_t *estx, estx_node_t rule, dst_t d
 			}
 			break;
 		}
+		case ESTX_TERM_EXPR: {
+			if (state[top - 1] == 0) {
+				estx_node_data_t *node = estx_get_node(estx, term->val.expr.rule);
+				if (node == NULL) {
+					top--;
+					break;
+				}
+				strv_t name = strvbuf_get(&estx->strs, node->val.name);
+				dst.off += print_header(estx, stack, state, top, dst);
+				dst.off += dputf(dst, "expr <%.*s>", name.len, name.data);
+				dst.off += estx_term_occ_print(term->occ, dst);
+				dst.off += dputs(dst, STRV("\n"));
+				state[top - 1] = 1;
+				stack[top++]   = term->val.expr.ops;
+			} else {
+				state[top - 1] = 0;
+				if (list_get_next(&estx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+					top--;
+				}
+			}
+			break;
+		}
+		case ESTX_TERM_SET: {
+			dst.off += print_header(estx, stack, state, top, dst);
+			dst.off += tok_set_print(estx_data_set(estx, term), dst);
+			dst.off += estx_term_occ_print(term->occ, dst);
+			dst.off += dputs(dst, STRV("\n"));
+			if (list_get_next(&estx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+				top--;
+			}
+			break;
+		}
+		case ESTX_TERM_CUT: {
+			dst.off += print_header(estx, stack, state, top, dst);
+			dst.off += dputs(dst, STRV("~\n"));
+			if (list_get_next(&estx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+				top--;
+			}
+			break;
+		}
+		case ESTX_OP: {
+			dst.off += print_header(estx, stack, state, top, dst);
+			dst.off += estx_op_print(estx, term, dst);
+			dst.off += dputs(dst, STRV("\n"));
+			if (list_get_next(&estx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+				top--;
+			}
+			break;
+		}
+		case ESTX_TERM_LIST:
+			if (state[top - 1] == 0) {
+				dst.off += print_header(estx, stack, state, top, dst);
+				dst.off += dputf(dst, "list(%d%s)", term->val.list.min, term->val.list.keep ? ", keep" : "");
+				dst.off += estx_term_occ_print(term->occ, dst);
+				dst.off += dputs(dst, STRV("\n"));
+				state[top - 1] = 1;
+				stack[top++]   = term->val.list.terms;
+			} else {
+				state[top - 1] = 0;
+				if (list_get_next(&estx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+					top--;
+				}
+			}
+			break;
 		case ESTX_TERM_GROUP: title = title.data ? title : STRV("group"); occ = 1; // fall-through
 		case ESTX_TERM_ALT: title = title.data ? title : STRV("alt");		   // fall-through
 		case ESTX_TERM_CON:
@@ -551,3 +993,1410 @@ size_t estx_print_tree(const estx_t *estx, dst_t dst)
 
 	return dst.off - off;
 }
+
+static int estx_toks_add(estx_toks_t *toks, const estx_toks_t *src)
+{
+	int changed = (src->types & ~toks->types) != 0;
+	toks->types |= src->types;
+
+	for (int i = 0; i < 8; i++) {
+		changed |= (src->chars[i] & ~toks->chars[i]) != 0;
+		toks->chars[i] |= src->chars[i];
+	}
+
+	return changed;
+}
+
+static void estx_toks_add_char(estx_toks_t *toks, char c)
+{
+	byte b = (byte)c;
+	toks->chars[b / 32] |= 1u << (b % 32);
+}
+
+int estx_toks_has(const estx_toks_t *toks, tok_t tok, strv_t val)
+{
+	if (toks == NULL) {
+		return 0;
+	}
+
+	if (toks->types & tok.type) {
+		return 1;
+	}
+
+	if (val.len != 1) {
+		return 0;
+	}
+
+	byte b = (byte)val.data[0];
+	return (toks->chars[b / 32] & (1u << (b % 32))) != 0;
+}
+
+size_t estx_toks_print(const estx_toks_t *toks, dst_t dst)
+{
+	if (toks == NULL) {
+		return 0;
+	}
+
+	size_t off = dst.off;
+
+	if (toks->types) {
+		dst.off += tok_type_print(toks->types, dst);
+	}
+
+	for (uint c = 0; c < 256; c++) {
+		if (!(toks->chars[c / 32] & (1u << (c % 32)))) {
+			continue;
+		}
+
+		if (dst.off > off) {
+			dst.off += dputs(dst, STRV(" "));
+		}
+
+		if (c == '\'') {
+			dst.off += dputf(dst, "\"%c\"", (char)c);
+		} else {
+			dst.off += dputf(dst, "'%c'", (char)c);
+		}
+	}
+
+	return dst.off - off;
+}
+
+static const estx_node_data_t *estx_analyze_rule(const estx_t *estx, estx_node_t rule)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, rule);
+	return data && data->type == ESTX_RULE ? data : NULL;
+}
+
+// Every term is marked with the rule it belongs to
+static void estx_analyze_owner(const estx_t *estx, estx_info_t *infos, estx_node_t node, estx_node_t rule)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+	if (data == NULL || infos[node].rule != ESTX_RULES_NONE) {
+		return;
+	}
+
+	infos[node].rule = rule;
+
+	if (data->type != ESTX_TERM_ALT && data->type != ESTX_TERM_CON && data->type != ESTX_TERM_GROUP && data->type != ESTX_TERM_LIST) {
+		return;
+	}
+
+	estx_node_t child = data->val.terms;
+	estx_node_foreach(&estx->nodes, child, data)
+	{
+		estx_analyze_owner(estx, infos, child, rule);
+	}
+}
+
+// Whether one match of a node can be empty, the tokens it can start with and whether it can run into a cut before consuming a token, all
+// without its occurrence. A cut only applies to the rule it is in, so it is not passed on by rules.
+static estx_info_t estx_analyze_base(const estx_t *estx, const estx_info_t *infos, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+	estx_info_t info	     = {0};
+
+	estx_node_t child = ESTX_RULES_NONE;
+	switch (data->type) {
+	case ESTX_RULE: list_get_next(&estx->nodes, node, &child); break;
+	case ESTX_TERM_RULE: child = estx_analyze_rule(estx, data->val.rule) ? data->val.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_TOK:
+		info.first.types = 1u << data->val.tok;
+		info.nullable	 = data->val.tok == TOK_EOF;
+		break;
+	case ESTX_TERM_LIT: {
+		strv_t lit = estx_data_lit(estx, data);
+		if (lit.len == 0) {
+			info.nullable = 1;
+		} else {
+			estx_toks_add_char(&info.first, lit.data[0]);
+		}
+		break;
+	}
+	case ESTX_TERM_SET: {
+		const tok_set_t *set = estx_data_set(estx, data);
+		for (uint c = 0; c < 256; c++) {
+			if (tok_set_has(set, (byte)c)) {
+				estx_toks_add_char(&info.first, (char)c);
+			}
+		}
+		break;
+	}
+	case ESTX_TERM_ALT: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_toks_add(&info.first, &infos[i].first);
+			info.nullable |= infos[i].nullable;
+			info.cut |= infos[i].cut;
+		}
+		break;
+	}
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP: {
+		info.nullable = 1;
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_toks_add(&info.first, &infos[i].first);
+			info.cut |= infos[i].cut;
+			if (!infos[i].nullable) {
+				info.nullable = 0;
+				break;
+			}
+		}
+		break;
+	}
+	case ESTX_TERM_LIST: {
+		// The element starts the list, the separator only when the element can be empty
+		estx_node_t elem = data->val.list.terms;
+		estx_node_t sep;
+		if (list_get_next(&estx->nodes, elem, &sep) == NULL) {
+			break;
+		}
+		estx_toks_add(&info.first, &infos[elem].first);
+		info.cut = infos[elem].cut;
+		if (infos[elem].nullable) {
+			estx_toks_add(&info.first, &infos[sep].first);
+			info.cut |= infos[sep].cut;
+		}
+		info.nullable = data->val.list.min == 0 || (infos[elem].nullable && (data->val.list.min == 1 || infos[sep].nullable));
+		break;
+	}
+	case ESTX_TERM_EXPR: {
+		child = estx_analyze_rule(estx, data->val.expr.rule) ? data->val.expr.rule : ESTX_RULES_NONE;
+		const estx_node_data_t *op;
+		estx_node_t i = data->val.expr.ops;
+		estx_node_foreach(&estx->nodes, i, op)
+		{
+			strv_t lit = estx_data_lit(estx, op);
+			if (op->val.op.type == ESTX_OP_PREFIX && lit.len > 0) {
+				estx_toks_add_char(&info.first, lit.data[0]);
+			}
+		}
+		break;
+	}
+	case ESTX_TERM_CUT:
+		info.nullable = 1;
+		info.cut      = 1;
+		break;
+	default: break;
+	}
+
+	if (child != ESTX_RULES_NONE) {
+		estx_toks_add(&info.first, &infos[child].first);
+		info.nullable |= infos[child].nullable;
+	}
+
+	return info;
+}
+
+// The term expected when a node fails on its first token: every term which can start the node is attempted on that token and
+// fails, the last one of them is the one reported
+static void estx_analyze_exp(const estx_t *estx, estx_info_t *infos, byte *state, estx_node_t node)
+{
+	if (state[node]) {
+		return;
+	}
+	state[node] = 1;
+
+	estx_info_t *info	     = &infos[node];
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	estx_node_t child = ESTX_RULES_NONE;
+	switch (data->type) {
+	case ESTX_RULE: list_get_next(&estx->nodes, node, &child); break;
+	case ESTX_TERM_RULE: child = estx_analyze_rule(estx, data->val.rule) ? data->val.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_EXPR: child = estx_analyze_rule(estx, data->val.expr.rule) ? data->val.expr.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_TOK:
+	case ESTX_TERM_LIT:
+	case ESTX_TERM_SET:
+		info->exp_rule = info->rule;
+		info->exp      = node;
+		info->has_exp  = 1;
+		break;
+	case ESTX_TERM_ALT: {
+		info->has_exp = 1;
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_analyze_exp(estx, infos, state, i);
+			info->has_exp &= infos[i].has_exp;
+			info->exp_rule = infos[i].exp_rule;
+			info->exp      = infos[i].exp;
+		}
+		break;
+	}
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			if (!infos[i].nullable) {
+				child = i;
+				break;
+			}
+		}
+		break;
+	}
+	default: break;
+	}
+
+	// A node reached again while its expected term is searched is left recursive and has none
+	if (child != ESTX_RULES_NONE && state[child] != 1) {
+		estx_analyze_exp(estx, infos, state, child);
+		info->has_exp  = infos[child].has_exp;
+		info->exp_rule = infos[child].exp_rule;
+		info->exp      = infos[child].exp;
+	}
+
+	state[node] = 2;
+}
+
+// Whether the rule can be reached from the start of a node without consuming a token
+static int estx_analyze_left(const estx_t *estx, const estx_info_t *infos, byte *seen, estx_node_t node, estx_node_t rule)
+{
+	if (seen[node]) {
+		return 0;
+	}
+	seen[node] = 1;
+
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	estx_node_t child = ESTX_RULES_NONE;
+	switch (data->type) {
+	case ESTX_RULE: list_get_next(&estx->nodes, node, &child); break;
+	case ESTX_TERM_RULE: child = estx_analyze_rule(estx, data->val.rule) ? data->val.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_EXPR: child = estx_analyze_rule(estx, data->val.expr.rule) ? data->val.expr.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			if (estx_analyze_left(estx, infos, seen, i, rule)) {
+				return 1;
+			}
+
+			if (data->type != ESTX_TERM_ALT && !infos[i].nullable) {
+				break;
+			}
+		}
+		break;
+	}
+	default: break;
+	}
+
+	if (child == ESTX_RULES_NONE) {
+		return 0;
+	}
+
+	return child == rule || estx_analyze_left(estx, infos, seen, child, rule);
+}
+
+static void estx_analyze_reach(const estx_t *estx, estx_info_t *infos, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	estx_node_t child = ESTX_RULES_NONE;
+	switch (data->type) {
+	case ESTX_RULE:
+		if (infos[node].reachable) {
+			return;
+		}
+		infos[node].reachable = 1;
+		list_get_next(&estx->nodes, node, &child);
+		break;
+	case ESTX_TERM_RULE: child = estx_analyze_rule(estx, data->val.rule) ? data->val.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_EXPR: child = estx_analyze_rule(estx, data->val.expr.rule) ? data->val.expr.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_analyze_reach(estx, infos, i);
+		}
+		break;
+	}
+	default: break;
+	}
+
+	if (child != ESTX_RULES_NONE) {
+		estx_analyze_reach(estx, infos, child);
+	}
+}
+
+// Passes the tokens which can follow a node on to its children and to the rules it uses
+static int estx_analyze_follow(const estx_t *estx, estx_info_t *infos, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+	estx_info_t *info	     = &infos[node];
+
+	int changed = 0;
+	if (data->occ & ESTX_TERM_OCC_REP) {
+		changed |= estx_toks_add(&info->follow, &info->first);
+	}
+
+	switch (data->type) {
+	case ESTX_RULE: {
+		estx_node_t body;
+		if (list_get_next(&estx->nodes, node, &body)) {
+			changed |= estx_toks_add(&infos[body].follow, &info->follow);
+		}
+		break;
+	}
+	case ESTX_TERM_RULE:
+		if (estx_analyze_rule(estx, data->val.rule)) {
+			changed |= estx_toks_add(&infos[data->val.rule].follow, &info->follow);
+		}
+		break;
+	case ESTX_TERM_EXPR: {
+		if (estx_analyze_rule(estx, data->val.expr.rule) == NULL) {
+			break;
+		}
+
+		estx_toks_t follow = info->follow;
+		const estx_node_data_t *op;
+		estx_node_t i = data->val.expr.ops;
+		estx_node_foreach(&estx->nodes, i, op)
+		{
+			strv_t lit = estx_data_lit(estx, op);
+			if (op->val.op.type != ESTX_OP_PREFIX && lit.len > 0) {
+				estx_toks_add_char(&follow, lit.data[0]);
+			}
+		}
+		changed |= estx_toks_add(&infos[data->val.expr.rule].follow, &follow);
+		break;
+	}
+	case ESTX_TERM_ALT: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			changed |= estx_toks_add(&infos[i].follow, &info->follow);
+		}
+		break;
+	}
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_toks_t follow = {0};
+			int nullable	   = 1;
+
+			estx_node_t j = i;
+			while (nullable && list_get_next(&estx->nodes, j, &j)) {
+				estx_toks_add(&follow, &infos[j].first);
+				nullable = infos[j].nullable;
+			}
+
+			if (nullable) {
+				estx_toks_add(&follow, &info->follow);
+			}
+
+			changed |= estx_toks_add(&infos[i].follow, &follow);
+		}
+		break;
+	}
+	case ESTX_TERM_LIST: {
+		// An element is followed by a separator or the end of the list, a separator by an element
+		estx_node_t elem = data->val.list.terms;
+		estx_node_t sep;
+		if (list_get_next(&estx->nodes, elem, &sep) == NULL) {
+			break;
+		}
+
+		estx_toks_t follow = infos[sep].first;
+		if (infos[sep].nullable) {
+			estx_toks_add(&follow, &infos[elem].first);
+		}
+		estx_toks_add(&follow, &info->follow);
+		changed |= estx_toks_add(&infos[elem].follow, &follow);
+
+		follow = infos[elem].first;
+		if (infos[elem].nullable) {
+			estx_toks_add(&follow, &infos[sep].first);
+			estx_toks_add(&follow, &info->follow);
+		}
+		changed |= estx_toks_add(&infos[sep].follow, &follow);
+		break;
+	}
+	default: break;
+	}
+
+	return changed;
+}
+
+int estx_analyze(estx_t *estx, estx_node_t root, dst_t dst)
+{
+	if (estx == NULL) {
+		return 1;
+	}
+
+	if (estx_analyze_rule(estx, root) == NULL) {
+		log_error("cparse", "estx", NULL, "invalid rule: %d", root);
+		return 1;
+	}
+
+	uint cnt   = estx->nodes.cnt;
+	byte *seen = alloc_alloc(&estx->nodes.alloc, cnt);
+	if (seen == NULL) {
+		log_error("cparse", "estx", NULL, "failed to allocate analysis");
+		return 1;
+	}
+
+	if (estx->infos == NULL || estx->infos_cnt != cnt) {
+		estx_info_t *infos = alloc_alloc(&estx->nodes.alloc, cnt * sizeof(estx_info_t));
+		if (infos == NULL) {
+			alloc_free(&estx->nodes.alloc, seen, cnt);
+			log_error("cparse", "estx", NULL, "failed to allocate analysis");
+			return 1;
+		}
+
+		if (estx->infos) {
+			alloc_free(&estx->nodes.alloc, estx->infos, estx->infos_cnt * sizeof(estx_info_t));
+		}
+
+		estx->infos	= infos;
+		estx->infos_cnt = cnt;
+	}
+
+	estx_info_t *infos = estx->infos;
+	mem_set(infos, 0, cnt * sizeof(estx_info_t));
+
+	for (estx_node_t i = 0; i < cnt; i++) {
+		infos[i].rule = ESTX_RULES_NONE;
+	}
+
+	for (estx_node_t i = 0; i < cnt; i++) {
+		estx_node_t body;
+		if (estx_analyze_rule(estx, i) && list_get_next(&estx->nodes, i, &body)) {
+			infos[i].rule = i;
+			estx_analyze_owner(estx, infos, body, i);
+		}
+	}
+
+	// Nullable, first tokens and cuts only grow, so they are computed again until nothing changes
+	int changed = 1;
+	while (changed) {
+		changed = 0;
+		for (estx_node_t i = 0; i < cnt; i++) {
+			const estx_node_data_t *data = list_get(&estx->nodes, i);
+			estx_info_t base	     = estx_analyze_base(estx, infos, i);
+			int nullable		     = base.nullable || (data->occ & ESTX_TERM_OCC_OPT);
+
+			changed |= estx_toks_add(&infos[i].first, &base.first);
+			changed |= (nullable && !infos[i].nullable) || (base.nullable && !infos[i].empty) || (base.cut && !infos[i].cut);
+			infos[i].nullable |= nullable;
+			infos[i].empty |= base.nullable;
+			infos[i].cut |= base.cut;
+		}
+	}
+
+	mem_set(seen, 0, cnt);
+	for (estx_node_t i = 0; i < cnt; i++) {
+		estx_analyze_exp(estx, infos, seen, i);
+	}
+
+	estx_analyze_reach(estx, infos, root);
+
+	infos[root].follow.types |= 1u << TOK_EOF;
+	changed = 1;
+	while (changed) {
+		changed = 0;
+		for (estx_node_t i = 0; i < cnt; i++) {
+			changed |= estx_analyze_follow(estx, infos, i);
+		}
+	}
+
+	int ret = 0;
+	for (estx_node_t i = 0; i < cnt; i++) {
+		const estx_node_data_t *data = list_get(&estx->nodes, i);
+		if (infos[i].rule == ESTX_RULES_NONE) {
+			continue;
+		}
+
+		strv_t name = estx_rules_name(estx, infos[i].rule);
+
+		if (data->type == ESTX_RULE) {
+			mem_set(seen, 0, cnt);
+			estx_node_t body;
+			if (list_get_next(&estx->nodes, i, &body) && estx_analyze_left(estx, infos, seen, body, i)) {
+				infos[i].left_rec = 1;
+				dst.off += dputf(dst, "error: in rule '%.*s': left recursion\n", name.len, name.data);
+				ret = 1;
+			}
+
+			if (!infos[i].reachable) {
+				dst.off += dputf(dst, "warning: rule '%.*s' is unreachable\n", name.len, name.data);
+			}
+		}
+
+		if ((data->occ & ESTX_TERM_OCC_REP) && infos[i].empty) {
+			dst.off += dputf(dst, "error: in rule '%.*s': repeated term can match nothing\n", name.len, name.data);
+			ret = 1;
+		}
+	}
+
+	alloc_free(&estx->nodes.alloc, seen, cnt);
+
+	return ret;
+}
+
+const estx_info_t *estx_get_info(const estx_t *estx, estx_node_t node)
+{
+	if (estx == NULL || estx->infos == NULL || estx->infos_cnt != estx->nodes.cnt || node >= estx->infos_cnt) {
+		return NULL;
+	}
+
+	return &estx->infos[node];
+}
+
+size_t estx_print_info(const estx_t *estx, dst_t dst)
+{
+	if (estx == NULL || estx->infos == NULL || estx->infos_cnt != estx->nodes.cnt) {
+		return 0;
+	}
+
+	size_t off = dst.off;
+
+	uint i = 0;
+	const estx_node_data_t *node;
+	estx_node_foreach_all(&estx->nodes, i, node)
+	{
+		if (node->type != ESTX_RULE) {
+			continue;
+		}
+
+		const estx_info_t *info = &estx->infos[i];
+		strv_t name		= strvbuf_get(&estx->strs, node->val.name);
+		dst.off += dputf(dst, "%.*s:%s first: ", name.len, name.data, info->nullable ? " nullable" : "");
+		dst.off += estx_toks_print(&info->first, dst);
+		dst.off += dputs(dst, STRV(" follow: "));
+		dst.off += estx_toks_print(&info->follow, dst);
+		dst.off += dputs(dst, STRV("\n"));
+	}
+
+	return dst.off - off;
+}
+
+static int estx_optimize_lit(const estx_node_data_t *data)
+{
+	return data->type == ESTX_TERM_LIT && data->occ == ESTX_TERM_OCC_ONE;
+}
+
+static int estx_optimize_splice(const estx_node_data_t *data)
+{
+	return (data->type == ESTX_TERM_GROUP || data->type == ESTX_TERM_CON) && data->occ == ESTX_TERM_OCC_ONE;
+}
+
+static void estx_optimize_link(estx_t *estx, estx_node_t id, estx_node_t *first, estx_node_t *last)
+{
+	if (*first == ESTX_RULES_NONE) {
+		*first = id;
+	} else {
+		list_app(&estx->nodes, *last, id);
+	}
+
+	*last = id;
+}
+
+// Appends a copy of a term to a new sequence. Inside lexical rules a literal following a literal is merged into it, as no nodes
+// are built for them there.
+static int estx_optimize_app(estx_t *estx, estx_node_t term, int lex, estx_node_t *first, estx_node_t *last)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, term);
+	const estx_node_data_t *prev = *last == ESTX_RULES_NONE ? NULL : list_get(&estx->nodes, *last);
+
+	if (lex && prev && estx_optimize_lit(prev) && estx_optimize_lit(data)) {
+		strv_t a = estx_data_lit(estx, prev);
+		strv_t b = estx_data_lit(estx, data);
+
+		char buf[256];
+		if (a.len + b.len <= sizeof(buf)) {
+			for (size_t i = 0; i < a.len; i++) {
+				buf[i] = a.data[i];
+			}
+			for (size_t i = 0; i < b.len; i++) {
+				buf[a.len + i] = b.data[i];
+			}
+
+			size_t lit;
+			if (strvbuf_add(&estx->strs, STRVN(buf, a.len + b.len), &lit)) {
+				log_error("cparse", "estx", NULL, "failed to add literal string");
+				return 1;
+			}
+
+			estx_get_node(estx, *last)->val.lit = lit;
+			return 0;
+		}
+	}
+
+	estx_node_t id;
+	estx_node_data_t *copy = list_node(&estx->nodes, &id);
+	if (copy == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create term");
+		return 1;
+	}
+
+	*copy = *(estx_node_data_t *)list_get(&estx->nodes, term);
+
+	estx_optimize_link(estx, id, first, last);
+	return 0;
+}
+
+// Nested groups and concatenations without occurrence are spliced into the sequence around them. The sequence is built anew, as
+// terms can not be unlinked, and the old one is left unused.
+static int estx_optimize_seq(estx_t *estx, estx_node_t node, int lex)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	int change = 0;
+	int lit	   = 0;
+	estx_node_t i;
+	const estx_node_data_t *child;
+
+	i = data->val.terms;
+	estx_node_foreach(&estx->nodes, i, child)
+	{
+		change |= estx_optimize_splice(child) || (lex && lit && estx_optimize_lit(child));
+		lit = estx_optimize_lit(child);
+	}
+
+	if (!change) {
+		return 0;
+	}
+
+	estx_node_t first = ESTX_RULES_NONE;
+	estx_node_t last  = ESTX_RULES_NONE;
+
+	i = data->val.terms;
+	while (i != ESTX_RULES_NONE) {
+		child = list_get(&estx->nodes, i);
+		if (estx_optimize_splice(child)) {
+			estx_node_t j = child->val.terms;
+			while (j != ESTX_RULES_NONE) {
+				if (estx_optimize_app(estx, j, lex, &first, &last)) {
+					return 1;
+				}
+				j = list_get_next(&estx->nodes, j, &j) ? j : ESTX_RULES_NONE;
+			}
+		} else if (estx_optimize_app(estx, i, lex, &first, &last)) {
+			return 1;
+		}
+		i = list_get_next(&estx->nodes, i, &i) ? i : ESTX_RULES_NONE;
+	}
+
+	estx_get_node(estx, node)->val.terms = first;
+	return 0;
+}
+
+static int estx_optimize_chr(const estx_t *estx, const estx_node_data_t *data)
+{
+	return data->occ == ESTX_TERM_OCC_ONE &&
+	       (data->type == ESTX_TERM_SET || (data->type == ESTX_TERM_LIT && estx_data_lit(estx, data).len == 1));
+}
+
+// Adjacent alternatives matching one character are merged into a set, which is tested with one lookup instead of one attempt for
+// every alternative. Alternatives which are not adjacent are kept apart, as one between them could match first. An alternation
+// merged into a single set becomes the set.
+static int estx_optimize_alt(estx_t *estx, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	int change = 0;
+	int chr	   = 0;
+	estx_node_t i;
+	const estx_node_data_t *child;
+
+	i = data->val.terms;
+	estx_node_foreach(&estx->nodes, i, child)
+	{
+		change |= chr && estx_optimize_chr(estx, child);
+		chr = estx_optimize_chr(estx, child);
+	}
+
+	if (!change) {
+		return 0;
+	}
+
+	estx_node_t first = ESTX_RULES_NONE;
+	estx_node_t last  = ESTX_RULES_NONE;
+
+	i = data->val.terms;
+	while (i != ESTX_RULES_NONE) {
+		estx_node_t start = i;
+		tok_set_t set	  = {0};
+		uint cnt	  = 0;
+		while (i != ESTX_RULES_NONE && estx_optimize_chr(estx, child = list_get(&estx->nodes, i))) {
+			if (child->type == ESTX_TERM_SET) {
+				const tok_set_t *bits = estx_data_set(estx, child);
+				for (uint j = 0; j < sizeof(set.bits); j++) {
+					set.bits[j] |= bits->bits[j];
+				}
+			} else {
+				byte c = (byte)estx_data_lit(estx, child).data[0];
+				tok_set_add(&set, c, c);
+			}
+			cnt++;
+			i = list_get_next(&estx->nodes, i, &i) ? i : ESTX_RULES_NONE;
+		}
+
+		if (cnt > 1) {
+			estx_node_t id;
+			if (estx_term_set(estx, &set, ESTX_TERM_OCC_ONE, &id)) {
+				return 1;
+			}
+			estx_optimize_link(estx, id, &first, &last);
+			continue;
+		}
+
+		if (estx_optimize_app(estx, start, 0, &first, &last)) {
+			return 1;
+		}
+		i = list_get_next(&estx->nodes, start, &i) ? i : ESTX_RULES_NONE;
+	}
+
+	estx_node_data_t *alt = estx_get_node(estx, node);
+	if (list_get_next(&estx->nodes, first, NULL) == NULL) {
+		estx_node_data_t set = *estx_get_node(estx, first);
+		set.occ		     = alt->occ;
+		*alt		     = set;
+	} else {
+		alt->val.terms = first;
+	}
+
+	return 0;
+}
+
+// The element and separator of a list are optimized on their own, they are no sequence to splice
+static int estx_optimize_node(estx_t *estx, estx_node_t node, int lex)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+	if (data->type != ESTX_TERM_ALT && data->type != ESTX_TERM_CON && data->type != ESTX_TERM_GROUP && data->type != ESTX_TERM_LIST) {
+		return 0;
+	}
+
+	estx_node_t i = data->val.terms;
+	while (i != ESTX_RULES_NONE) {
+		if (estx_optimize_node(estx, i, lex)) {
+			return 1;
+		}
+		i = list_get_next(&estx->nodes, i, &i) ? i : ESTX_RULES_NONE;
+	}
+
+	data = list_get(&estx->nodes, node);
+	switch (data->type) {
+	case ESTX_TERM_ALT: return estx_optimize_alt(estx, node);
+	case ESTX_TERM_LIST: return 0;
+	default: return estx_optimize_seq(estx, node, lex);
+	}
+}
+
+static void estx_optimize_uses(const estx_t *estx, uint *uses, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	switch (data->type) {
+	case ESTX_TERM_RULE:
+		if (estx_analyze_rule(estx, data->val.rule)) {
+			uses[data->val.rule]++;
+		}
+		break;
+	case ESTX_TERM_EXPR:
+		if (estx_analyze_rule(estx, data->val.expr.rule)) {
+			uses[data->val.expr.rule]++;
+		}
+		break;
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, data)
+		{
+			estx_optimize_uses(estx, uses, i);
+		}
+		break;
+	}
+	default: break;
+	}
+}
+
+static int estx_optimize_cut(const estx_t *estx, estx_node_t node)
+{
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+	if (data->type == ESTX_TERM_CUT) {
+		return 1;
+	}
+
+	if (data->type != ESTX_TERM_ALT && data->type != ESTX_TERM_CON && data->type != ESTX_TERM_GROUP && data->type != ESTX_TERM_LIST) {
+		return 0;
+	}
+
+	estx_node_t i = data->val.terms;
+	estx_node_foreach(&estx->nodes, i, data)
+	{
+		if (estx_optimize_cut(estx, i)) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Whether the rule is reached from a node, following rules and groups
+static int estx_optimize_reaches(const estx_t *estx, byte *seen, estx_node_t node, estx_node_t rule)
+{
+	if (seen[node]) {
+		return 0;
+	}
+	seen[node] = 1;
+
+	const estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	estx_node_t child = ESTX_RULES_NONE;
+	switch (data->type) {
+	case ESTX_RULE: list_get_next(&estx->nodes, node, &child); break;
+	case ESTX_TERM_RULE: child = estx_analyze_rule(estx, data->val.rule) ? data->val.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_EXPR: child = estx_analyze_rule(estx, data->val.expr.rule) ? data->val.expr.rule : ESTX_RULES_NONE; break;
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			if (estx_optimize_reaches(estx, seen, i, rule)) {
+				return 1;
+			}
+		}
+		break;
+	}
+	default: break;
+	}
+
+	if (child == ESTX_RULES_NONE) {
+		return 0;
+	}
+
+	return child == rule || estx_optimize_reaches(estx, seen, child, rule);
+}
+
+// A rule used once becomes a group of its body, if no node of its own is missed: it is used inside a lexical rule, where no nodes
+// are built, or it is an inline rule, whose children are added to the node using it anyway. A cut stays in its rule, so rules
+// with cuts are kept.
+static void estx_optimize_inline(estx_t *estx, const uint *uses, byte *seen, estx_node_t rule, estx_node_t node)
+{
+	estx_node_data_t *data = list_get(&estx->nodes, node);
+
+	switch (data->type) {
+	case ESTX_TERM_RULE: {
+		const estx_node_data_t *parent = list_get(&estx->nodes, rule);
+		const estx_node_data_t *target = estx_analyze_rule(estx, data->val.rule);
+		estx_node_t body;
+		if (target == NULL || data->val.rule == rule || uses[data->val.rule] != 1 || (target->flags & ESTX_RULE_FLAG_SPLIT) ||
+		    list_get_next(&estx->nodes, data->val.rule, &body) == NULL || estx_optimize_cut(estx, body)) {
+			break;
+		}
+
+		if (!(parent->flags & ESTX_RULE_FLAG_LEX) &&
+		    (!(target->flags & ESTX_RULE_FLAG_INLINE) || (target->flags & ESTX_RULE_FLAG_LEX))) {
+			break;
+		}
+
+		mem_set(seen, 0, estx->nodes.cnt);
+		if (estx_optimize_reaches(estx, seen, body, rule)) {
+			break;
+		}
+
+		data->type	= ESTX_TERM_GROUP;
+		data->val.terms = body;
+		break;
+	}
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+	case ESTX_TERM_LIST: {
+		const estx_node_data_t *tmp;
+		estx_node_t i = data->val.terms;
+		estx_node_foreach(&estx->nodes, i, tmp)
+		{
+			estx_optimize_inline(estx, uses, seen, rule, i);
+		}
+		break;
+	}
+	default: break;
+	}
+}
+
+// Copies a term with the terms below it
+static int estx_optimize_copy(estx_t *estx, estx_node_t term, estx_node_t *copy)
+{
+	estx_node_data_t *data = list_node(&estx->nodes, copy);
+	if (data == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create term");
+		return 1;
+	}
+
+	*data = *(estx_node_data_t *)list_get(&estx->nodes, term);
+	if (data->type != ESTX_TERM_ALT && data->type != ESTX_TERM_CON && data->type != ESTX_TERM_GROUP && data->type != ESTX_TERM_LIST) {
+		return 0;
+	}
+
+	estx_node_t first = ESTX_RULES_NONE;
+	estx_node_t last  = ESTX_RULES_NONE;
+
+	estx_node_t i = data->val.terms;
+	while (i != ESTX_RULES_NONE) {
+		estx_node_t id;
+		if (estx_optimize_copy(estx, i, &id)) {
+			return 1;
+		}
+		estx_optimize_link(estx, id, &first, &last);
+		i = list_get_next(&estx->nodes, i, &i) ? i : ESTX_RULES_NONE;
+	}
+
+	estx_get_node(estx, *copy)->val.terms = first;
+	return 0;
+}
+
+int estx_optimize(estx_t *estx)
+{
+	if (estx == NULL) {
+		return 1;
+	}
+
+	// Nodes are added below, the analysis has to be made again
+	if (estx->infos) {
+		alloc_free(&estx->nodes.alloc, estx->infos, estx->infos_cnt * sizeof(estx_info_t));
+		estx->infos	= NULL;
+		estx->infos_cnt = 0;
+	}
+
+	uint cnt = estx->nodes.cnt;
+	for (estx_node_t i = 0; i < cnt; i++) {
+		const estx_node_data_t *data = estx_analyze_rule(estx, i);
+		estx_node_t body;
+		if (data && list_get_next(&estx->nodes, i, &body) && estx_optimize_node(estx, body, data->flags & ESTX_RULE_FLAG_LEX)) {
+			return 1;
+		}
+	}
+
+	cnt	   = estx->nodes.cnt;
+	uint *uses = alloc_alloc(&estx->nodes.alloc, cnt * sizeof(uint));
+	byte *seen = alloc_alloc(&estx->nodes.alloc, cnt);
+	if (uses == NULL || seen == NULL) {
+		if (uses) {
+			alloc_free(&estx->nodes.alloc, uses, cnt * sizeof(uint));
+		}
+		if (seen) {
+			alloc_free(&estx->nodes.alloc, seen, cnt);
+		}
+		log_error("cparse", "estx", NULL, "failed to allocate optimizer");
+		return 1;
+	}
+
+	mem_set(uses, 0, cnt * sizeof(uint));
+
+	for (estx_node_t i = 0; i < cnt; i++) {
+		estx_node_t body;
+		if (estx_analyze_rule(estx, i) && list_get_next(&estx->nodes, i, &body)) {
+			estx_optimize_uses(estx, uses, body);
+		}
+	}
+
+	for (estx_node_t i = 0; i < cnt; i++) {
+		estx_node_t body;
+		if (estx_analyze_rule(estx, i) && list_get_next(&estx->nodes, i, &body)) {
+			estx_optimize_inline(estx, uses, seen, i, body);
+		}
+	}
+
+	// Inlined groups share the body of their rule until all rules are inlined, then every one gets a copy of it, so that no term
+	// has two parents and the rule keeps its own body
+	mem_set(seen, 0, cnt);
+	for (estx_node_t i = 0; i < cnt; i++) {
+		estx_node_t body;
+		if (estx_analyze_rule(estx, i) && list_get_next(&estx->nodes, i, &body)) {
+			seen[body] = 1;
+		}
+	}
+
+	int ret = 0;
+	for (estx_node_t i = 0; i < cnt && ret == 0; i++) {
+		const estx_node_data_t *data = list_get(&estx->nodes, i);
+		estx_node_t copy;
+		if (data->type == ESTX_TERM_GROUP && data->val.terms < cnt && seen[data->val.terms]) {
+			ret = estx_optimize_copy(estx, data->val.terms, &copy);
+			if (ret == 0) {
+				estx_get_node(estx, i)->val.terms = copy;
+			}
+		}
+	}
+
+	alloc_free(&estx->nodes.alloc, uses, cnt * sizeof(uint));
+	alloc_free(&estx->nodes.alloc, seen, cnt);
+
+	return ret;
+}
+
+#define ESTX_BIN_MAGIC	 0x58545345 // "ESTX"
+#define ESTX_BIN_VERSION 2
+#define ESTX_BIN_NONE	 0xffffffff
+
+// The binary format is a header (magic, version, node count), every node in index order (type, occurrence, flags and the values of
+// its type), the next node of every node and the analysis of every node, if the grammar was analyzed. Values are 32 bit little
+// endian, strings are stored with their length in front and nodes refer to each other by index, so the data does not depend on
+// where it is loaded.
+typedef struct estx_bin_s {
+	byte *data;
+	size_t size;
+	size_t off;
+} estx_bin_t;
+
+static void estx_bin_put(estx_bin_t *bin, uint val)
+{
+	for (int i = 0; i < 4; i++) {
+		if (bin->off < bin->size) {
+			bin->data[bin->off] = (byte)(val >> (i * 8));
+		}
+		bin->off++;
+	}
+}
+
+static void estx_bin_put_str(estx_bin_t *bin, strv_t str)
+{
+	estx_bin_put(bin, (uint)str.len);
+	for (size_t i = 0; i < str.len; i++) {
+		if (bin->off < bin->size) {
+			bin->data[bin->off] = (byte)str.data[i];
+		}
+		bin->off++;
+	}
+}
+
+static int estx_bin_get(estx_bin_t *bin, uint *val)
+{
+	if (bin->size - bin->off < 4) {
+		return 1;
+	}
+
+	const byte *data = &bin->data[bin->off];
+	*val		 = (uint)data[0] | (uint)data[1] << 8 | (uint)data[2] << 16 | (uint)data[3] << 24;
+	bin->off += 4;
+	return 0;
+}
+
+static void estx_bin_put_toks(estx_bin_t *bin, const estx_toks_t *toks)
+{
+	estx_bin_put(bin, toks->types);
+	for (int i = 0; i < 8; i++) {
+		estx_bin_put(bin, toks->chars[i]);
+	}
+}
+
+static int estx_bin_get_toks(estx_bin_t *bin, estx_toks_t *toks)
+{
+	if (estx_bin_get(bin, &toks->types)) {
+		return 1;
+	}
+
+	for (int i = 0; i < 8; i++) {
+		if (estx_bin_get(bin, &toks->chars[i])) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int estx_bin_get_str(estx_bin_t *bin, strv_t *str)
+{
+	uint len;
+	if (estx_bin_get(bin, &len) || bin->size - bin->off < len) {
+		return 1;
+	}
+
+	*str = STRVN((const char *)&bin->data[bin->off], len);
+	bin->off += len;
+	return 0;
+}
+
+size_t estx_save(const estx_t *estx, void *buf, size_t size)
+{
+	if (estx == NULL) {
+		return 0;
+	}
+
+	estx_bin_t bin = {.data = buf, .size = buf == NULL ? 0 : size};
+
+	estx_bin_put(&bin, ESTX_BIN_MAGIC);
+	estx_bin_put(&bin, ESTX_BIN_VERSION);
+	estx_bin_put(&bin, estx->nodes.cnt);
+
+	uint i = 0;
+	const estx_node_data_t *node;
+	estx_node_foreach_all(&estx->nodes, i, node)
+	{
+		estx_bin_put(&bin, node->type);
+		estx_bin_put(&bin, node->occ);
+		estx_bin_put(&bin, node->flags);
+
+		switch (node->type) {
+		case ESTX_RULE: estx_bin_put_str(&bin, strvbuf_get(&estx->strs, node->val.name)); break;
+		case ESTX_TERM_RULE: estx_bin_put(&bin, node->val.rule); break;
+		case ESTX_TERM_TOK: estx_bin_put(&bin, node->val.tok); break;
+		case ESTX_TERM_LIT: estx_bin_put_str(&bin, strvbuf_get(&estx->strs, node->val.lit)); break;
+		case ESTX_TERM_SET: estx_bin_put_str(&bin, strvbuf_get(&estx->strs, node->val.set)); break;
+		case ESTX_TERM_ALT:
+		case ESTX_TERM_CON:
+		case ESTX_TERM_GROUP: estx_bin_put(&bin, node->val.terms); break;
+		case ESTX_TERM_EXPR:
+			estx_bin_put(&bin, node->val.expr.rule);
+			estx_bin_put(&bin, node->val.expr.ops);
+			break;
+		case ESTX_TERM_LIST:
+			estx_bin_put(&bin, node->val.list.terms);
+			estx_bin_put(&bin, node->val.list.min);
+			estx_bin_put(&bin, (uint)node->val.list.keep);
+			break;
+		case ESTX_OP:
+			estx_bin_put_str(&bin, strvbuf_get(&estx->strs, node->val.op.lit));
+			estx_bin_put(&bin, node->val.op.prec);
+			estx_bin_put(&bin, node->val.op.type);
+			break;
+		default: break;
+		}
+	}
+
+	for (i = 0; i < estx->nodes.cnt; i++) {
+		estx_node_t next;
+		estx_bin_put(&bin, list_get_next(&estx->nodes, i, &next) ? next : ESTX_BIN_NONE);
+	}
+
+	// An analysis made before nodes were added is not saved
+	uint infos_cnt = estx->infos && estx->infos_cnt == estx->nodes.cnt ? estx->infos_cnt : 0;
+	estx_bin_put(&bin, infos_cnt);
+	for (i = 0; i < infos_cnt; i++) {
+		const estx_info_t *info = &estx->infos[i];
+		estx_bin_put(&bin, info->rule);
+		estx_bin_put_toks(&bin, &info->first);
+		estx_bin_put_toks(&bin, &info->follow);
+		estx_bin_put(&bin, info->exp_rule);
+		estx_bin_put(&bin, info->exp);
+		estx_bin_put(&bin,
+			     (uint)info->nullable | (uint)info->empty << 1 | (uint)info->cut << 2 | (uint)info->has_exp << 3 |
+				     (uint)info->left_rec << 4 | (uint)info->reachable << 5);
+	}
+
+	return bin.off;
+}
+
+static int estx_load_str(estx_t *estx, estx_bin_t *bin, size_t *off)
+{
+	strv_t str;
+	if (estx_bin_get_str(bin, &str)) {
+		return 1;
+	}
+
+	if (strvbuf_add(&estx->strs, str, off)) {
+		log_error("cparse", "estx", NULL, "failed to add string");
+		return 1;
+	}
+
+	return 0;
+}
+
+static int estx_load_node(estx_t *estx, estx_bin_t *bin, uint cnt)
+{
+	uint type, occ, flags;
+	if (estx_bin_get(bin, &type) || estx_bin_get(bin, &occ) || estx_bin_get(bin, &flags)) {
+		return 1;
+	}
+
+	if (type == ESTX_RULE && estx_rules_reserve(estx)) {
+		return 1;
+	}
+
+	estx_node_t id;
+	estx_node_data_t *data = list_node(&estx->nodes, &id);
+	if (data == NULL) {
+		log_error("cparse", "estx", NULL, "failed to create node");
+		return 1;
+	}
+
+	*data = (estx_node_data_t){
+		.type  = type,
+		.occ   = occ,
+		.flags = flags,
+	};
+
+	uint a = 0, b = 0;
+	switch (type) {
+	case ESTX_RULE:
+		if (estx_load_str(estx, bin, &data->val.name)) {
+			return 1;
+		}
+		estx_rules_add(estx, id);
+		return 0;
+	case ESTX_TERM_RULE:
+		if (estx_bin_get(bin, &a) || a >= cnt) {
+			return 1;
+		}
+		data->val.rule = a;
+		return 0;
+	case ESTX_TERM_TOK:
+		if (estx_bin_get(bin, &a) || a >= __TOK_MAX) {
+			return 1;
+		}
+		data->val.tok = a;
+		return 0;
+	case ESTX_TERM_LIT: return estx_load_str(estx, bin, &data->val.lit);
+	case ESTX_TERM_SET:
+		return estx_load_str(estx, bin, &data->val.set) || strvbuf_get(&estx->strs, data->val.set).len != sizeof(tok_set_t);
+	case ESTX_TERM_ALT:
+	case ESTX_TERM_CON:
+	case ESTX_TERM_GROUP:
+		if (estx_bin_get(bin, &a) || a >= cnt) {
+			return 1;
+		}
+		data->val.terms = a;
+		return 0;
+	case ESTX_TERM_EXPR:
+		if (estx_bin_get(bin, &a) || estx_bin_get(bin, &b) || a >= cnt || b >= cnt) {
+			return 1;
+		}
+		data->val.expr.rule = a;
+		data->val.expr.ops  = b;
+		return 0;
+	case ESTX_TERM_LIST: {
+		uint keep;
+		if (estx_bin_get(bin, &a) || estx_bin_get(bin, &b) || estx_bin_get(bin, &keep) || a >= cnt || keep > 1) {
+			return 1;
+		}
+		data->val.list.terms = a;
+		data->val.list.min   = b;
+		data->val.list.keep  = (int)keep;
+		return 0;
+	}
+	case ESTX_UNKNOWN:
+	case ESTX_TERM_CUT: return 0;
+	case ESTX_OP:
+		if (estx_load_str(estx, bin, &data->val.op.lit) || estx_bin_get(bin, &a) || estx_bin_get(bin, &b) || b > ESTX_OP_RIGHT) {
+			return 1;
+		}
+		data->val.op.prec = a;
+		data->val.op.type = b;
+		return 0;
+	default: return 1;
+	}
+}
+
+static int estx_load_info(estx_bin_t *bin, estx_info_t *info, uint cnt)
+{
+	uint rule, exp_rule, exp, flags;
+	if (estx_bin_get(bin, &rule) || estx_bin_get_toks(bin, &info->first) || estx_bin_get_toks(bin, &info->follow) ||
+	    estx_bin_get(bin, &exp_rule) || estx_bin_get(bin, &exp) || estx_bin_get(bin, &flags) ||
+	    (rule >= cnt && rule != ESTX_RULES_NONE) || flags >= 1 << 6) {
+		return 1;
+	}
+
+	info->rule	= rule;
+	info->exp_rule	= exp_rule;
+	info->exp	= exp;
+	info->nullable	= flags & 1;
+	info->empty	= flags >> 1 & 1;
+	info->cut	= flags >> 2 & 1;
+	info->has_exp	= flags >> 3 & 1;
+	info->left_rec	= flags >> 4 & 1;
+	info->reachable = flags >> 5 & 1;
+	return 0;
+}
+
+// A saved analysis is loaded with the grammar, so it does not have to be made again
+static int estx_load_infos(estx_t *estx, estx_bin_t *bin, uint cnt)
+{
+	uint infos_cnt;
+	if (estx_bin_get(bin, &infos_cnt) || (infos_cnt != 0 && infos_cnt != cnt)) {
+		log_error("cparse", "estx", NULL, "invalid grammar analysis");
+		return 1;
+	}
+
+	if (infos_cnt == 0) {
+		return 0;
+	}
+
+	estx->infos = alloc_alloc(&estx->nodes.alloc, cnt * sizeof(estx_info_t));
+	if (estx->infos == NULL) {
+		log_error("cparse", "estx", NULL, "failed to allocate analysis");
+		return 1;
+	}
+
+	estx->infos_cnt = cnt;
+	mem_set(estx->infos, 0, cnt * sizeof(estx_info_t));
+
+	for (uint i = 0; i < cnt; i++) {
+		if (estx_load_info(bin, &estx->infos[i], cnt)) {
+			log_error("cparse", "estx", NULL, "invalid grammar analysis: %d", i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int estx_load(estx_t *estx, const void *data, size_t size)
+{
+	if (estx == NULL || data == NULL) {
+		return 1;
+	}
+
+	if (estx->nodes.cnt > 0) {
+		log_error("cparse", "estx", NULL, "grammar is not empty");
+		return 1;
+	}
+
+	estx_bin_t bin = {.data = (byte *)data, .size = size};
+
+	uint magic, version, cnt;
+	if (estx_bin_get(&bin, &magic) || estx_bin_get(&bin, &version) || estx_bin_get(&bin, &cnt) || magic != ESTX_BIN_MAGIC) {
+		log_error("cparse", "estx", NULL, "invalid grammar data");
+		return 1;
+	}
+
+	if (version != ESTX_BIN_VERSION) {
+		log_error("cparse", "estx", NULL, "unsupported grammar version: %d", version);
+		return 1;
+	}
+
+	for (uint i = 0; i < cnt; i++) {
+		if (estx_load_node(estx, &bin, cnt)) {
+			log_error("cparse", "estx", NULL, "invalid grammar node: %d", i);
+			return 1;
+		}
+	}
+
+	for (uint i = 0; i < cnt; i++) {
+		uint next;
+		if (estx_bin_get(&bin, &next) || (next != ESTX_BIN_NONE && (next >= cnt || list_app(&estx->nodes, i, next)))) {
+			log_error("cparse", "estx", NULL, "invalid grammar node link: %d", i);
+			return 1;
+		}
+	}
+
+	return estx_load_infos(estx, &bin, cnt);
+}
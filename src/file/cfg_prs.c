@@ -1,56 +1,99 @@
 #include "file/cfg_prs.h"
 
+#include "cfg_prs_estx.h"
 #include "ebnf.h"
 #include "eprs.h"
 #include "log.h"
 #include "str.h"
 
-cfg_prs_t *cfg_prs_init(cfg_prs_t *cfg_prs, alloc_t alloc)
+// Builds the cfg grammar from its EBNF text. cfg_prs_init loads the same grammar, optimized and analyzed, from the table in
+// cfg_prs_estx.h, which is generated from this function by tools/cfg_gen.c and has to be regenerated whenever the grammar changes.
+estx_t *cfg_prs_estx(estx_t *estx, alloc_t alloc)
 {
-	if (cfg_prs == NULL) {
+	if (estx == NULL) {
 		return NULL;
 	}
 
 	uint line      = __LINE__ + 1;
 	strv_t cfg_bnf = STRV("file = cfg EOF\n"
-			      "cfg  = (tv NL)* tbl? (NL tbl)*\n"
+			      "@inline cfg = (tv NL)* tbl? (NL tbl)*\n"
 			      "tv   = kv | (key ':' NL vals? NL) | val\n"
-			      "vals = val (NL val)*\n"
-			      "key  = (ALPHA | '.')+\n"
+			      "vals = list(val, NL, 1)\n"
+			      "@lex key  = [A-Za-z.]+\n"
 			      "val  = int | '\"' str '\"' | lit | '[' arr? ']' | '{' obj? '}'\n"
-			      "int  = DIGIT+\n"
-			      "str  = c*\n"
-			      "lit  = (ALPHA | DIGIT | '_') (ALPHA | DIGIT | '_' | ':')*\n"
-			      "arr  = val (', ' val)*\n"
-			      "obj  = kv (', ' kv)*\n"
+			      "@lex int  = DIGIT+\n"
+			      "@lex str  = c*\n"
+			      "@lex lit  = [A-Za-z0-9_] [A-Za-z0-9_:]*\n"
+			      "arr  = list(val, ', ', 1)\n"
+			      "obj  = list(kv, ', ', 1)\n"
 			      "kv   = key ' ' mode? '= ' val\n"
 			      "mode = '+' | '-' | '?'\n"
-			      "c    = ALPHA | DIGIT | SYMBOL | ' ' | \"'\"\n"
+			      "c    = [ !#-~]\n"
 			      "tbl  = '[' name ']' NL ent\n"
-			      "name = (ALPHA | DIGIT | '_' | ':' | '.' | '=' | '+' | '?' | '-')+\n"
+			      "@lex name = [A-Za-z0-9_:.=+?-]+\n"
 			      "ent  = (tv NL)*\n");
 
-	if (lex_init(&cfg_prs->lex, 1, 512, alloc) == NULL) {
-		log_error("cparse", "bnf", NULL, "failed to intialize lexer");
+	lex_t lex = {0};
+	if (lex_init(&lex, 1, 512, alloc) == NULL) {
+		log_error("cparse", "cfg_prs", NULL, "failed to intialize lexer");
 		return NULL;
 	}
 
-	lex_tokenize(&cfg_prs->lex, cfg_bnf, STRV(__FILE__), line);
+	lex_tokenize(&lex, cfg_bnf, STRV(__FILE__), line);
 
 	ebnf_t ebnf = {0};
 	ebnf_init(&ebnf, alloc);
 	ebnf_get_stx(&ebnf, alloc, DST_NONE());
 
 	prs_t prs = {0};
-	prs_init(&prs, 1024, ALLOC_STD);
+	prs_init(&prs, 1024, alloc);
 
 	prs_node_t prs_root;
-	prs_parse(&prs, &cfg_prs->lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+	if (estx_init(estx, 128, alloc) == NULL) {
+		prs_free(&prs);
+		ebnf_free(&ebnf);
+		lex_free(&lex);
+		return NULL;
+	}
+
+	if (estx_from_ebnf(&ebnf, &prs, prs_root, estx, NULL)) {
+		log_error("cparse", "cfg_prs", NULL, "failed to convert grammar");
+		estx_free(estx);
+		prs_free(&prs);
+		ebnf_free(&ebnf);
+		lex_free(&lex);
+		return NULL;
+	}
 
+	estx_node_t ent;
+	estx_find_rule(estx, STRV("ent"), &ent);
+	estx_rule_set_flags(estx, ent, ESTX_RULE_FLAG_SPLIT);
+
+	prs_free(&prs);
 	ebnf_free(&ebnf);
+	lex_free(&lex);
+
+	return estx;
+}
+
+cfg_prs_t *cfg_prs_init(cfg_prs_t *cfg_prs, alloc_t alloc)
+{
+	if (cfg_prs == NULL) {
+		return NULL;
+	}
+
+	if (cfg_prs_ctx_init(&cfg_prs->ctx, alloc) == NULL) {
+		return NULL;
+	}
 
-	estx_init(&cfg_prs->estx, 128, ALLOC_STD);
-	estx_from_ebnf(&ebnf, &prs, prs_root, &cfg_prs->estx, NULL);
+	if (estx_init(&cfg_prs->estx, 128, alloc) == NULL || estx_load(&cfg_prs->estx, cfg_prs_estx_tbl, sizeof(cfg_prs_estx_tbl))) {
+		estx_free(&cfg_prs->estx);
+		cfg_prs_ctx_free(&cfg_prs->ctx);
+		log_error("cparse", "cfg_prs", NULL, "failed to load grammar");
+		return NULL;
+	}
 
 	estx_find_rule(&cfg_prs->estx, STRV("file"), &cfg_prs->file);
 	estx_find_rule(&cfg_prs->estx, STRV("cfg"), &cfg_prs->cfg);
@@ -69,10 +112,6 @@ cfg_prs_t *cfg_prs_init(cfg_prs_t *cfg_prs, alloc_t alloc)
 	estx_find_rule(&cfg_prs->estx, STRV("name"), &cfg_prs->name);
 	estx_find_rule(&cfg_prs->estx, STRV("ent"), &cfg_prs->ent);
 
-	prs_free(&prs);
-
-	eprs_init(&cfg_prs->eprs, 256, alloc);
-
 	return cfg_prs;
 }
 
@@ -82,129 +121,200 @@ void cfg_prs_free(cfg_prs_t *cfg_prs)
 		return;
 	}
 
-	lex_free(&cfg_prs->lex);
-	eprs_free(&cfg_prs->eprs);
+	cfg_prs_ctx_free(&cfg_prs->ctx);
 	estx_free(&cfg_prs->estx);
 }
 
+cfg_prs_ctx_t *cfg_prs_ctx_init(cfg_prs_ctx_t *ctx, alloc_t alloc)
+{
+	if (ctx == NULL) {
+		return NULL;
+	}
+
+	if (lex_init(&ctx->lex, 1, 512, alloc) == NULL) {
+		log_error("cparse", "cfg_prs", NULL, "failed to intialize lexer");
+		return NULL;
+	}
+
+	if (eprs_init(&ctx->eprs, 256, alloc) == NULL) {
+		lex_free(&ctx->lex);
+		log_error("cparse", "cfg_prs", NULL, "failed to intialize parser");
+		return NULL;
+	}
+
+	for (uint i = 0; i < CFG_PRS_PIECES; i++) {
+		if (eprs_init(&ctx->pieces[i].eprs, 64, alloc) == NULL) {
+			while (i-- > 0) {
+				eprs_free(&ctx->pieces[i].eprs);
+			}
+			eprs_free(&ctx->eprs);
+			lex_free(&ctx->lex);
+			log_error("cparse", "cfg_prs", NULL, "failed to intialize parser");
+			return NULL;
+		}
+	}
+
+	return ctx;
+}
+
+void cfg_prs_ctx_free(cfg_prs_ctx_t *ctx)
+{
+	if (ctx == NULL) {
+		return;
+	}
+
+	for (uint i = 0; i < CFG_PRS_PIECES; i++) {
+		eprs_free(&ctx->pieces[i].eprs);
+	}
+	lex_free(&ctx->lex);
+	eprs_free(&ctx->eprs);
+}
+
+// The entries of a table are parsed in up to pieces_cnt pieces, see eprs_set_split. 0 parses them sequentially again.
+void cfg_prs_ctx_set_split(cfg_prs_ctx_t *ctx, uint pieces_cnt, eprs_split_run_fn run, void *priv)
+{
+	if (ctx == NULL) {
+		return;
+	}
+
+	pieces_cnt = pieces_cnt < CFG_PRS_PIECES ? pieces_cnt : CFG_PRS_PIECES;
+	eprs_set_split(&ctx->eprs, pieces_cnt > 0 ? ctx->pieces : NULL, pieces_cnt, run, priv);
+}
+
 static int cfg_parse_value(const cfg_prs_t *cfg_prs, eprs_t *eprs, strv_t key, cfg_mode_t mode, eprs_node_t value, cfg_t *cfg,
 			   cfg_var_t *var);
 
 static cfg_var_t cfg_parse_kv(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t kv, cfg_t *cfg, cfg_var_t *var)
 {
-	eprs_node_t node;
-	tok_t key   = {0};
-	tok_t tmode = {0};
+	tok_t key	    = {0};
+	cfg_mode_t mode	    = CFG_MODE_SET;
+	eprs_node_t prs_val = eprs->nodes.cnt;
 
-	if (eprs_get_rule(eprs, kv, cfg_prs->key, &node) == 0) {
-		eprs_get_str(eprs, node, &key);
-	}
+	eprs_node_t node;
+	void *data;
+	eprs_node_foreach(&eprs->nodes, kv, node, data)
+	{
+		estx_node_t rule;
+		if (eprs_get_node_rule(eprs, node, &rule)) {
+			continue;
+		}
 
-	cfg_mode_t mode = CFG_MODE_SET;
-	if (eprs_get_rule(eprs, kv, cfg_prs->mode, &node) == 0) {
-		eprs_get_str(eprs, node, &tmode);
-		strv_t val = lex_get_tok_val(eprs->lex, tmode);
-		if (strv_eq(val, STRV("+"))) {
-			mode = CFG_MODE_ADD;
-		} else if (strv_eq(val, STRV("-"))) {
-			mode = CFG_MODE_SUB;
-		} else if (strv_eq(val, STRV("?"))) {
-			mode = CFG_MODE_ENS;
+		if (rule == cfg_prs->key) {
+			eprs_get_str(eprs, node, &key);
+		} else if (rule == cfg_prs->mode) {
+			tok_t tmode = {0};
+			eprs_get_str(eprs, node, &tmode);
+			strv_t val = lex_get_tok_val(eprs->lex, tmode);
+			if (strv_eq(val, STRV("+"))) {
+				mode = CFG_MODE_ADD;
+			} else if (strv_eq(val, STRV("-"))) {
+				mode = CFG_MODE_SUB;
+			} else if (strv_eq(val, STRV("?"))) {
+				mode = CFG_MODE_ENS;
+			}
+		} else if (rule == cfg_prs->val) {
+			prs_val = node;
 		}
 	}
 
-	eprs_node_t prs_val;
-	eprs_get_rule(eprs, kv, cfg_prs->val, &prs_val);
 	return cfg_parse_value(cfg_prs, eprs, lex_get_tok_val(eprs->lex, key), mode, prs_val, cfg, var);
 }
 
-static int cfg_parse_value(const cfg_prs_t *cfg_prs, eprs_t *eprs, strv_t key, cfg_mode_t mode, eprs_node_t value, cfg_t *cfg,
-			   cfg_var_t *var)
+static int cfg_parse_vals(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t vals, cfg_t *cfg, cfg_var_t var)
 {
-	int ret = 1;
-	eprs_node_t node;
-	if (eprs_get_rule(eprs, value, cfg_prs->i, &node) == 0) {
-		tok_t val = {0};
-		eprs_get_str(eprs, node, &val);
-
-		strv_t val_str = lex_get_tok_val(eprs->lex, val);
-		int val_int;
-		strv_to_int(val_str, &val_int);
-		ret = cfg_int(cfg, key, mode, val_int, var);
-	} else if (eprs_get_rule(eprs, value, cfg_prs->str, &node) == 0) {
-		tok_t val = {0};
-		eprs_get_str(eprs, node, &val);
-		ret = cfg_str(cfg, key, mode, lex_get_tok_val(eprs->lex, val), var);
-	} else if (eprs_get_rule(eprs, value, cfg_prs->lit, &node) == 0) {
-		tok_t val = {0};
-		eprs_get_str(eprs, node, &val);
-		ret = cfg_lit(cfg, key, mode, lex_get_tok_val(eprs->lex, val), var);
-	} else if (eprs_get_rule(eprs, value, cfg_prs->arr, &node) == 0) {
-		eprs_node_t child;
-		void *data;
-		ret = cfg_arr(cfg, key, mode, 0, var);
-		eprs_node_foreach(&eprs->nodes, node, child, data)
-		{
-			eprs_node_t val;
-			if (eprs_get_rule(eprs, child, cfg_prs->val, &val)) {
-				continue;
-			}
+	int ret = 0;
 
-			cfg_var_t el;
-			ret |= cfg_parse_value(cfg_prs, eprs, STRV_NULL, CFG_MODE_UNKNOWN, val, cfg, &el);
-			ret |= cfg_add_var(cfg, *var, el);
+	eprs_node_t child;
+	void *data;
+	eprs_node_foreach(&eprs->nodes, vals, child, data)
+	{
+		estx_node_t rule;
+		if (eprs_get_node_rule(eprs, child, &rule) || rule != cfg_prs->val) {
+			continue;
 		}
-	} else if (eprs_get_rule(eprs, value, cfg_prs->obj, &node) == 0) {
-		eprs_node_t child;
-		void *data;
-		ret = cfg_obj(cfg, key, var);
-		eprs_node_foreach(&eprs->nodes, node, child, data)
-		{
-			eprs_node_t kv;
-			if (eprs_get_rule(eprs, child, cfg_prs->kv, &kv)) {
-				continue;
-			}
 
-			cfg_var_t el;
-			ret |= cfg_parse_kv(cfg_prs, eprs, kv, cfg, &el);
-			ret |= cfg_add_var(cfg, *var, el);
-		}
+		cfg_var_t el;
+		ret |= cfg_parse_value(cfg_prs, eprs, STRV_NULL, CFG_MODE_UNKNOWN, child, cfg, &el);
+		ret |= cfg_add_var(cfg, var, el);
 	}
 
 	return ret;
 }
 
-static cfg_var_t cfg_parse_tv(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t kv, cfg_t *cfg, cfg_var_t *var)
+static int cfg_parse_value(const cfg_prs_t *cfg_prs, eprs_t *eprs, strv_t key, cfg_mode_t mode, eprs_node_t value, cfg_t *cfg,
+			   cfg_var_t *var)
 {
 	eprs_node_t node;
-	tok_t key = {0};
+	void *data;
+	eprs_node_foreach(&eprs->nodes, value, node, data)
+	{
+		estx_node_t rule;
+		if (eprs_get_node_rule(eprs, node, &rule)) {
+			continue;
+		}
 
-	if (eprs_get_rule(eprs, kv, cfg_prs->kv, &node) == 0) {
-		return cfg_parse_kv(cfg_prs, eprs, node, cfg, var);
+		if (rule == cfg_prs->i) {
+			tok_t val = {0};
+			eprs_get_str(eprs, node, &val);
+
+			strv_t val_str = lex_get_tok_val(eprs->lex, val);
+			int val_int;
+			strv_to_int(val_str, &val_int);
+			return cfg_int(cfg, key, mode, val_int, var);
+		} else if (rule == cfg_prs->str) {
+			tok_t val = {0};
+			eprs_get_str(eprs, node, &val);
+			return cfg_str(cfg, key, mode, lex_get_tok_val(eprs->lex, val), var);
+		} else if (rule == cfg_prs->lit) {
+			tok_t val = {0};
+			eprs_get_str(eprs, node, &val);
+			return cfg_lit(cfg, key, mode, lex_get_tok_val(eprs->lex, val), var);
+		} else if (rule == cfg_prs->arr) {
+			int ret = cfg_arr(cfg, key, mode, 0, var);
+			return ret | cfg_parse_vals(cfg_prs, eprs, node, cfg, *var);
+		} else if (rule == cfg_prs->obj) {
+			eprs_node_t child;
+			int ret = cfg_obj(cfg, key, var);
+			eprs_node_foreach(&eprs->nodes, node, child, data)
+			{
+				if (eprs_get_node_rule(eprs, child, &rule) || rule != cfg_prs->kv) {
+					continue;
+				}
+
+				cfg_var_t el;
+				ret |= cfg_parse_kv(cfg_prs, eprs, child, cfg, &el);
+				ret |= cfg_add_var(cfg, *var, el);
+			}
+			return ret;
+		}
 	}
 
-	int ret = 0;
+	return 1;
+}
 
-	if (eprs_get_rule(eprs, kv, cfg_prs->key, &node) == 0) {
-		ret |= eprs_get_str(eprs, node, &key);
-	}
+static cfg_var_t cfg_parse_tv(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t kv, cfg_t *cfg, cfg_var_t *var)
+{
+	tok_t key = {0};
+	int ret	  = 0;
 
-	if (eprs_get_rule(eprs, kv, cfg_prs->val, &node) == 0) {
-		ret |= cfg_parse_value(cfg_prs, eprs, lex_get_tok_val(eprs->lex, key), CFG_MODE_UNKNOWN, node, cfg, var);
-	} else if (eprs_get_rule(eprs, kv, cfg_prs->vals, &node) == 0) {
-		eprs_node_t child;
-		void *data;
-		ret = cfg_arr(cfg, lex_get_tok_val(eprs->lex, key), CFG_MODE_ADD, 1, var);
-		eprs_node_foreach(&eprs->nodes, node, child, data)
-		{
-			eprs_node_t val;
-			if (eprs_get_rule(eprs, child, cfg_prs->val, &val)) {
-				continue;
-			}
+	eprs_node_t node;
+	void *data;
+	eprs_node_foreach(&eprs->nodes, kv, node, data)
+	{
+		estx_node_t rule;
+		if (eprs_get_node_rule(eprs, node, &rule)) {
+			continue;
+		}
 
-			cfg_var_t el;
-			ret |= cfg_parse_value(cfg_prs, eprs, STRV_NULL, CFG_MODE_UNKNOWN, val, cfg, &el);
-			ret |= cfg_add_var(cfg, *var, el);
+		if (rule == cfg_prs->kv) {
+			return cfg_parse_kv(cfg_prs, eprs, node, cfg, var);
+		} else if (rule == cfg_prs->key) {
+			ret |= eprs_get_str(eprs, node, &key);
+		} else if (rule == cfg_prs->val) {
+			return ret | cfg_parse_value(cfg_prs, eprs, lex_get_tok_val(eprs->lex, key), CFG_MODE_UNKNOWN, node, cfg, var);
+		} else if (rule == cfg_prs->vals) {
+			ret = cfg_arr(cfg, lex_get_tok_val(eprs->lex, key), CFG_MODE_ADD, 1, var);
+			return ret | cfg_parse_vals(cfg_prs, eprs, node, cfg, *var);
 		}
 	}
 
@@ -235,20 +345,18 @@ static int cfg_parse_ent(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t ent
 	void *data;
 	eprs_node_foreach(&eprs->nodes, ent, child, data)
 	{
-		eprs_node_t prs_kv;
-		if (eprs_get_rule(eprs, child, cfg_prs->tv, &prs_kv) == 0) {
-			cfg_var_t var;
-			cfg_parse_tv(cfg_prs, eprs, prs_kv, cfg, &var);
-			cfg_add_var(cfg, parent, var);
+		estx_node_t rule;
+		if (eprs_get_node_rule(eprs, child, &rule)) {
 			continue;
 		}
 
-		eprs_node_t prs_tbl;
-		if (eprs_get_rule(eprs, child, cfg_prs->tbl, &prs_tbl) == 0) {
-			cfg_var_t var;
-			cfg_parse_tbl(cfg_prs, eprs, prs_tbl, cfg, &var);
+		cfg_var_t var;
+		if (rule == cfg_prs->tv) {
+			cfg_parse_tv(cfg_prs, eprs, child, cfg, &var);
+			cfg_add_var(cfg, parent, var);
+		} else if (rule == cfg_prs->tbl) {
+			cfg_parse_tbl(cfg_prs, eprs, child, cfg, &var);
 			cfg_add_var(cfg, parent, var);
-			continue;
 		}
 	}
 
@@ -259,32 +367,38 @@ static int cfg_parse_file(const cfg_prs_t *cfg_prs, eprs_t *eprs, eprs_node_t fi
 {
 	cfg_root(cfg, var);
 
-	eprs_node_t prs_cfg;
-	eprs_get_rule(eprs, file, cfg_prs->cfg, &prs_cfg);
-
-	return cfg_parse_ent(cfg_prs, eprs, prs_cfg, *var, cfg);
+	return cfg_parse_ent(cfg_prs, eprs, file, *var, cfg);
 }
 
 int cfg_prs_parse(cfg_prs_t *cfg_prs, strv_t str, cfg_t *cfg, cfg_var_t *root, dst_t dst)
 {
-	if (cfg_prs == NULL || cfg == NULL || str.data == NULL) {
+	if (cfg_prs == NULL) {
 		return 1;
 	}
 
-	lex_reset(&cfg_prs->lex);
+	return cfg_prs_parse_ctx(cfg_prs, &cfg_prs->ctx, str, cfg, root, dst);
+}
+
+int cfg_prs_parse_ctx(const cfg_prs_t *cfg_prs, cfg_prs_ctx_t *ctx, strv_t str, cfg_t *cfg, cfg_var_t *root, dst_t dst)
+{
+	if (cfg_prs == NULL || ctx == NULL || cfg == NULL || str.data == NULL) {
+		return 1;
+	}
+
+	lex_reset(&ctx->lex);
 
 	strv_t sstr = STRVN(str.data, str.len);
-	if (lex_tokenize(&cfg_prs->lex, sstr, STRV(__FILE__), __LINE__ - 1)) {
+	if (lex_tokenize(&ctx->lex, sstr, STRV(__FILE__), __LINE__ - 1)) {
 		return 1;
 	}
 
 	eprs_node_t prs_root;
-	if (eprs_parse(&cfg_prs->eprs, &cfg_prs->lex, &cfg_prs->estx, cfg_prs->file, &prs_root, dst)) {
+	if (eprs_parse(&ctx->eprs, &ctx->lex, &cfg_prs->estx, cfg_prs->file, &prs_root, dst)) {
 		return 1;
 	}
 
 	cfg_var_t tmp;
-	int ret = cfg_parse_file(cfg_prs, &cfg_prs->eprs, prs_root, cfg, &tmp);
+	int ret = cfg_parse_file(cfg_prs, &ctx->eprs, prs_root, cfg, &tmp);
 
 	if (root) {
 		*root = tmp;
@@ -292,3 +406,17 @@ int cfg_prs_parse(cfg_prs_t *cfg_prs, strv_t str, cfg_t *cfg, cfg_var_t *root, d
 
 	return ret;
 }
+
+int cfg_prs_parse_batch(const cfg_prs_t *cfg_prs, cfg_prs_ctx_t *ctx, const strv_t *strs, uint cnt, cfg_t *cfgs, cfg_var_t *roots, dst_t dst)
+{
+	if (cfg_prs == NULL || ctx == NULL || ((strs == NULL || cfgs == NULL) && cnt > 0)) {
+		return 1;
+	}
+
+	int ret = 0;
+	for (uint i = 0; i < cnt; i++) {
+		ret |= cfg_prs_parse_ctx(cfg_prs, ctx, strs[i], &cfgs[i], roots ? &roots[i] : NULL, dst);
+	}
+
+	return ret;
+}
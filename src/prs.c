@@ -13,7 +13,11 @@ typedef enum prs_node_type_e {
 typedef struct prs_node_data_s {
 	prs_node_type_t type;
 	union {
-		stx_node_t rule;
+		struct {
+			stx_node_t id;
+			uint len;
+			size_t start;
+		} rule;
 		tok_t literal;
 		tok_t tok;
 	} val;
@@ -30,6 +34,9 @@ prs_t *prs_init(prs_t *prs, uint nodes_cap, alloc_t alloc)
 		return NULL;
 	}
 
+	prs->recognize = 0;
+	prs->guided    = 0;
+
 	return prs;
 }
 
@@ -40,6 +47,7 @@ void prs_free(prs_t *prs)
 	}
 
 	alloc_free(&prs->nodes.alloc, prs->parse_fail, prs->parse_fail_size);
+	alloc_free(&prs->nodes.alloc, prs->parse_fail_gens, prs->parse_fail_blocks * sizeof(uint));
 	tree_free(&prs->nodes);
 }
 
@@ -52,6 +60,16 @@ void prs_reset(prs_t *prs, uint cnt)
 	tree_reset(&prs->nodes, cnt);
 }
 
+// While recognizing no nodes are created, every node is reported as node 0 of the empty tree
+static int prs_node_none(prs_node_t *node)
+{
+	if (node) {
+		*node = 0;
+	}
+
+	return 0;
+}
+
 int prs_node_rule(prs_t *prs, stx_node_t rule, prs_node_t *node)
 {
 	if (prs == NULL) {
@@ -63,6 +81,10 @@ int prs_node_rule(prs_t *prs, stx_node_t rule, prs_node_t *node)
 		return 1;
 	}
 
+	if (prs->recognize) {
+		return prs_node_none(node);
+	}
+
 	prs_node_data_t *data = tree_node(&prs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "prs", NULL, "failed to add rule node");
@@ -70,8 +92,8 @@ int prs_node_rule(prs_t *prs, stx_node_t rule, prs_node_t *node)
 	}
 
 	*data = (prs_node_data_t){
-		.type	  = PRS_NODE_RULE,
-		.val.rule = rule,
+		.type	     = PRS_NODE_RULE,
+		.val.rule.id = rule,
 	};
 
 	return 0;
@@ -83,6 +105,10 @@ int prs_node_tok(prs_t *prs, tok_t tok, prs_node_t *node)
 		return 1;
 	}
 
+	if (prs->recognize) {
+		return prs_node_none(node);
+	}
+
 	prs_node_data_t *data = tree_node(&prs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "prs", NULL, "failed to add tok node");
@@ -103,6 +129,10 @@ int prs_node_lit(prs_t *prs, size_t start, uint len, prs_node_t *node)
 		return 1;
 	}
 
+	if (prs->recognize) {
+		return prs_node_none(node);
+	}
+
 	prs_node_data_t *data = tree_node(&prs->nodes, node);
 	if (data == NULL) {
 		log_error("cparse", "prs", NULL, "failed to add tok node");
@@ -123,6 +153,10 @@ int prs_add_node(prs_t *prs, prs_node_t parent, prs_node_t node)
 		return 1;
 	}
 
+	if (prs->recognize) {
+		return 0;
+	}
+
 	return tree_add(&prs->nodes, parent, node);
 }
 
@@ -147,7 +181,7 @@ int prs_get_rule(const prs_t *prs, prs_node_t parent, stx_node_t rule, prs_node_
 	{
 		switch (data->type) {
 		case PRS_NODE_RULE:
-			if (data->val.rule == rule) {
+			if (data->val.rule.id == rule) {
 				if (node) {
 					*node = child;
 				}
@@ -167,24 +201,22 @@ int prs_get_str(const prs_t *prs, prs_node_t parent, tok_t *out)
 		return 1;
 	}
 
-	prs_node_t child;
-	const prs_node_data_t *data;
-	tree_foreach_child(&prs->nodes, parent, child, data)
-	{
-		switch (data->type) {
-		case PRS_NODE_RULE: prs_get_str(prs, child, out); break;
-		case PRS_NODE_TOKEN: {
-			out->start = (out->len == 0 ? data->val.tok.start : out->start);
-			out->len += data->val.tok.len;
-			break;
-		}
-		case PRS_NODE_LITERAL: {
-			out->start = (out->len == 0 ? data->val.literal.start : out->start);
-			out->len += data->val.literal.len;
-			break;
-		}
-		default: log_error("cparse", "prs", NULL, "unexpected node: %d", data->type); break;
-		}
+	const prs_node_data_t *data = tree_get(&prs->nodes, parent);
+	if (data == NULL) {
+		return 1;
+	}
+
+	tok_t span = {0};
+	switch (data->type) {
+	case PRS_NODE_RULE: span = (tok_t){.start = data->val.rule.start, .len = data->val.rule.len}; break;
+	case PRS_NODE_TOKEN: span = data->val.tok; break;
+	case PRS_NODE_LITERAL: span = data->val.literal; break;
+	default: log_error("cparse", "prs", NULL, "unexpected node: %d", data->type); return 1;
+	}
+
+	if (span.len > 0) {
+		out->start = (out->len == 0 ? span.start : out->start);
+		out->len += span.len;
 	}
 
 	return 0;
@@ -200,6 +232,10 @@ typedef struct prs_parse_err_s {
 static int prs_parse_rule(prs_t *prs, stx_node_t rule_id, uint *off, prs_node_t node, prs_parse_err_t *err);
 static int prs_parse_terms(prs_t *prs, stx_node_t rule, stx_node_t terms, uint *off, prs_node_t node, prs_parse_err_t *err);
 
+#define PRS_FAIL_BLOCK 64
+
+// The failure bitmap is split into blocks of PRS_FAIL_BLOCK bytes, each stamped with the generation it was last written in. Starting
+// a new generation invalidates all blocks at once, a stale block is cleared when it is first written in the current generation.
 static int prs_cache_prepare(prs_t *prs)
 {
 	if (prs == NULL || prs->lex == NULL || prs->stx == NULL) {
@@ -208,26 +244,43 @@ static int prs_cache_prepare(prs_t *prs)
 
 	size_t stride = prs->lex->src.len + 1;
 	size_t bits   = (size_t)prs->stx->nodes.cnt * stride;
-	size_t size   = (bits + 7) / 8;
+	size_t blocks = ((bits + 7) / 8 + PRS_FAIL_BLOCK - 1) / PRS_FAIL_BLOCK;
+	size_t size   = blocks * PRS_FAIL_BLOCK;
 	if (bits == 0 || size == 0) {
 		return 1;
 	}
 
 	if (size > prs->parse_fail_size) {
 		alloc_free(&prs->nodes.alloc, prs->parse_fail, prs->parse_fail_size);
-		prs->parse_fail = alloc_alloc(&prs->nodes.alloc, size);
-		if (prs->parse_fail == NULL) {
+		alloc_free(&prs->nodes.alloc, prs->parse_fail_gens, prs->parse_fail_blocks * sizeof(uint));
+		prs->parse_fail	     = alloc_alloc(&prs->nodes.alloc, size);
+		prs->parse_fail_gens = alloc_alloc(&prs->nodes.alloc, blocks * sizeof(uint));
+		if (prs->parse_fail == NULL || prs->parse_fail_gens == NULL) {
+			alloc_free(&prs->nodes.alloc, prs->parse_fail, size);
+			alloc_free(&prs->nodes.alloc, prs->parse_fail_gens, blocks * sizeof(uint));
+			prs->parse_fail	       = NULL;
+			prs->parse_fail_gens   = NULL;
 			prs->parse_fail_size   = 0;
+			prs->parse_fail_blocks = 0;
 			prs->parse_fail_stride = 0;
 			log_error("cparse", "prs", NULL, "failed to allocate parse failure cache");
 			return 1;
 		}
-		prs->parse_fail_size = size;
+		mem_set(prs->parse_fail_gens, 0, blocks * sizeof(uint));
+		prs->parse_fail_size   = size;
+		prs->parse_fail_blocks = blocks;
+		prs->parse_fail_gen    = 0;
 	}
 
 	prs->parse_fail_stride = (uint)stride;
 	prs->parse_fail_bits   = bits;
-	mem_set(prs->parse_fail, 0, prs->parse_fail_size);
+
+	prs->parse_fail_gen++;
+	if (prs->parse_fail_gen == 0) {
+		mem_set(prs->parse_fail_gens, 0, prs->parse_fail_blocks * sizeof(uint));
+		prs->parse_fail_gen = 1;
+	}
+
 	return 0;
 }
 
@@ -240,6 +293,9 @@ static int prs_cache_failed(const prs_t *prs, stx_node_t rule, uint off)
 	if (bit >= prs->parse_fail_bits) {
 		return 0; // LCOV_EXCL_LINE
 	}
+	if (prs->parse_fail_gens[bit / 8 / PRS_FAIL_BLOCK] != prs->parse_fail_gen) {
+		return 0;
+	}
 	return (prs->parse_fail[bit / 8] & (byte)(1 << (bit % 8))) != 0;
 }
 
@@ -252,6 +308,11 @@ static void prs_cache_fail(prs_t *prs, stx_node_t rule, uint off)
 	if (bit >= prs->parse_fail_bits) {
 		return; // LCOV_EXCL_LINE
 	}
+	size_t block = bit / 8 / PRS_FAIL_BLOCK;
+	if (prs->parse_fail_gens[block] != prs->parse_fail_gen) {
+		mem_set(&prs->parse_fail[block * PRS_FAIL_BLOCK], 0, PRS_FAIL_BLOCK);
+		prs->parse_fail_gens[block] = prs->parse_fail_gen;
+	}
 	prs->parse_fail[bit / 8] |= (byte)(1 << (bit % 8));
 }
 
@@ -268,7 +329,7 @@ static void prs_diag_report(prs_t *prs, const char *phase, stx_node_t rule, stx_
 		  "prs",
 		  NULL,
 		  "prs_parse: %s rule=%u term=%u off=%u max_off=%u nodes=%u rule_calls=%u term_calls=%u term_rule=%u term_tok=%u "
-		  "term_lit=%u term_or=%u backtracks=%u memo_hits=%u memo_stores=%u",
+		  "term_lit=%u term_or=%u term_set=%u backtracks=%u memo_hits=%u memo_stores=%u",
 		  phase,
 		  rule,
 		  term,
@@ -281,6 +342,7 @@ static void prs_diag_report(prs_t *prs, const char *phase, stx_node_t rule, stx_
 		  prs->diag.term_tok_calls,
 		  prs->diag.term_lit_calls,
 		  prs->diag.term_or_calls,
+		  prs->diag.term_set_calls,
 		  prs->diag.backtracks,
 		  prs->diag.memo_hits,
 		  prs->diag.memo_stores);
@@ -310,6 +372,9 @@ static int prs_parse_term(prs_t *prs, stx_node_t rule, stx_node_t term_id, uint
 	case STX_RULE: return 0;
 	case STX_TERM_RULE: {
 		prs->diag.term_rule_calls++;
+		if (prs->guided && prs_cache_failed(prs, term->val.rule, *off)) {
+			return 1;
+		}
 		uint nodes_cnt = prs->nodes.cnt;
 		uint cur       = *off;
 		prs_node_t child;
@@ -401,19 +466,49 @@ static int prs_parse_term(prs_t *prs, stx_node_t rule, stx_node_t term_id, uint
 		*off += (uint)literal.len;
 		return 0;
 	}
+	case STX_TERM_SET: {
+		prs->diag.term_set_calls++;
+		tok_t tok  = lex_get_tok(prs->lex, *off);
+		strv_t val = lex_get_tok_val(prs->lex, tok);
+
+		// A set is one bitmap lookup per character instead of one alternative per character
+		if (!(tok.type & (1 << TOK_EOF)) && val.len == 1 && tok_set_has(stx_data_set(prs->stx, term), (byte)val.data[0])) {
+			prs_node_t lit;
+			prs_node_lit(prs, *off, 1, &lit);
+			prs_add_node(prs, node, lit);
+			log_trace("cparse", "prs", NULL, "set: success +1");
+			*off += 1;
+			return 0;
+		}
+
+		if (!err->failed || *off >= err->tok) {
+			err->rule   = rule;
+			err->tok    = *off;
+			err->exp    = term_id;
+			err->failed = 1;
+		}
+		log_trace("cparse", "prs", NULL, "set: failed");
+		return 1;
+	}
 	case STX_TERM_OR: {
 		prs->diag.term_or_calls++;
 		uint nodes_cnt = prs->nodes.cnt;
 		uint cur       = *off;
-		if (!prs_parse_terms(prs, rule, term->val.orv.l, off, node, err)) {
+		// A left side which failed while recognizing is marked in the failure cache under the or term and skipped while building
+		if (prs->guided && prs_cache_failed(prs, term_id, cur)) {
+			log_trace("cparse", "prs", NULL, "left: skipped");
+		} else if (!prs_parse_terms(prs, rule, term->val.orv.l, off, node, err)) {
 			log_trace("cparse", "prs", NULL, "left: success");
 			return 0;
+		} else {
+			log_trace("cparse", "prs", NULL, "left: failed");
+			prs->diag.backtracks++;
+			prs_reset(prs, nodes_cnt);
+			if (prs->recognize) {
+				prs_cache_fail(prs, term_id, cur);
+			}
 		}
 
-		log_trace("cparse", "prs", NULL, "left: failed");
-		prs->diag.backtracks++;
-		prs_reset(prs, nodes_cnt);
-
 		if (!prs_parse_terms(prs, rule, term->val.orv.r, off, node, err)) {
 			log_trace("cparse", "prs", NULL, "right: success");
 			return 0;
@@ -465,21 +560,23 @@ static int prs_parse_rule(prs_t *prs, stx_node_t rule, uint *off, prs_node_t nod
 		return 1;
 	}
 
+	prs_node_data_t *data = tree_get(&prs->nodes, node);
+	if (data) {
+		data->val.rule.start = cur;
+		data->val.rule.len   = *off - cur;
+	}
+
 	log_trace("cparse", "prs", NULL, "<%d>: success +%d", rule, *off - cur);
 	return 0;
 }
 
-int prs_parse(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, dst_t dst)
+static int prs_parse_root(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, prs_parse_err_t *err)
 {
-	if (prs == NULL || lex == NULL || stx == NULL) {
-		return 1;
-	}
-
 	prs->lex = lex;
 	prs->stx = stx;
 
 	prs_reset(prs, 0);
-	if (prs_cache_prepare(prs)) {
+	if (!prs->guided && prs_cache_prepare(prs)) {
 		return 1;
 	}
 	prs->diag = (prs_diag_t){
@@ -487,48 +584,126 @@ int prs_parse(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, p
 		.next_report = 50000,
 	};
 
-	prs_parse_err_t err = {0};
-
 	prs_node_t tmp;
 	prs_node_rule(prs, rule, &tmp);
 	uint parsed = 0;
 	prs_diag_report(prs, "starting root rule", rule, rule, parsed);
-	if (prs_parse_rule(prs, rule, &parsed, tmp, &err) || parsed != prs->lex->src.len) {
+	if (prs_parse_rule(prs, rule, &parsed, tmp, err) || parsed != prs->lex->src.len) {
 		prs_diag_report(prs, "failed root rule", rule, rule, parsed);
-		if (!err.failed) {
-			log_error("cparse", "prs", NULL, "wrong syntax");
-			return 1;
-		}
+		return 1;
+	}
+	prs_diag_report(prs, "completed root rule", rule, rule, parsed);
 
-		const stx_node_data_t *term = stx_get_node(prs->stx, err.exp);
+	if (root) {
+		*root = tmp;
+	}
 
-		tok_loc_t loc = lex_get_tok_loc(prs->lex, err.tok);
+	log_trace("cparse", "prs", NULL, "success");
+	return 0;
+}
 
-		dst.off += lex_tok_loc_print_loc(prs->lex, loc, dst);
+static size_t prs_print_parse_err(const prs_t *prs, const prs_parse_err_t *err, dst_t dst)
+{
+	if (!err->failed) {
+		log_error("cparse", "prs", NULL, "wrong syntax");
+		return 0;
+	}
 
-		if (term->type == STX_TERM_TOK) {
-			char buf[32] = {0};
-			size_t len   = tok_type_print(1 << term->val.tok, DST_BUF(buf));
-			dst.off += dputf(dst, "error: expected %.*s\n", (int)len, buf);
+	size_t off = dst.off;
 
-		} else {
-			strv_t exp_str = stx_data_lit(prs->stx, term);
-			dst.off += dputf(dst, "error: expected \'%.*s\'\n", exp_str.len, exp_str.data);
-		}
+	const stx_node_data_t *term = stx_get_node(prs->stx, err->exp);
+
+	tok_loc_t loc = lex_get_tok_loc(prs->lex, err->tok);
+
+	dst.off += lex_tok_loc_print_loc(prs->lex, loc, dst);
+
+	if (term->type == STX_TERM_TOK) {
+		char buf[32] = {0};
+		size_t len   = tok_type_print(1 << term->val.tok, DST_BUF(buf));
+		dst.off += dputf(dst, "error: expected %.*s\n", (int)len, buf);
+
+	} else if (term->type == STX_TERM_SET) {
+		dst.off += dputs(dst, STRV("error: expected "));
+		dst.off += tok_set_print(stx_data_set(prs->stx, term), dst);
+		dst.off += dputs(dst, STRV("\n"));
+	} else {
+		strv_t exp_str = stx_data_lit(prs->stx, term);
+		dst.off += dputf(dst, "error: expected \'%.*s\'\n", exp_str.len, exp_str.data);
+	}
+
+	dst.off += lex_tok_loc_print_src(prs->lex, loc, dst);
+
+	return dst.off - off;
+}
 
-		dst.off += lex_tok_loc_print_src(prs->lex, loc, dst);
+int prs_parse(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, dst_t dst)
+{
+	if (prs == NULL || lex == NULL || stx == NULL) {
 		return 1;
 	}
-	prs_diag_report(prs, "completed root rule", rule, rule, parsed);
 
-	if (root) {
-		*root = tmp;
+	prs_parse_err_t err = {0};
+	if (prs_parse_root(prs, lex, stx, rule, root, &err)) {
+		prs_print_parse_err(prs, &err, dst);
+		return 1;
 	}
 
-	log_trace("cparse", "prs", NULL, "success");
 	return 0;
 }
 
+int prs_recognize(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, dst_t dst)
+{
+	if (prs == NULL) {
+		return 1;
+	}
+
+	prs->recognize = 1;
+	int ret	       = prs_parse(prs, lex, stx, rule, NULL, dst);
+	prs->recognize = 0;
+
+	return ret;
+}
+
+int prs_parse_two_phase(prs_t *prs, const lex_t *lex, const stx_t *stx, stx_node_t rule, prs_node_t *root, dst_t dst)
+{
+	if (prs_recognize(prs, lex, stx, rule, dst)) {
+		return 1;
+	}
+
+	prs->guided = 1;
+	int ret	    = prs_parse(prs, lex, stx, rule, root, dst);
+	prs->guided = 0;
+
+	return ret;
+}
+
+int prs_parse_batch(prs_t *prs, lex_t *lex, const stx_t *stx, stx_node_t rule, const strv_t *srcs, uint srcs_cnt, prs_batch_cb cb, void *priv,
+		    dst_t dst)
+{
+	if (prs == NULL || lex == NULL || stx == NULL || (srcs == NULL && srcs_cnt > 0)) {
+		return 1;
+	}
+
+	// The errors of all failed inputs are printed one after another
+	int ret = 0;
+	for (uint i = 0; i < srcs_cnt; i++) {
+		prs_node_t root	    = 0;
+		prs_parse_err_t err = {0};
+		int failed	    = lex_tokenize(lex, srcs[i], lex->file, lex->line_off);
+		if (!failed && prs_parse_root(prs, lex, stx, rule, &root, &err)) {
+			dst.off += prs_print_parse_err(prs, &err, dst);
+			failed = 1;
+		}
+
+		if (cb) {
+			cb(prs, i, failed, root, priv);
+		}
+		ret |= failed;
+	}
+
+	return ret;
+}
+
 static size_t print_nodes(void *data, dst_t dst, const void *priv)
 {
 	const prs_t *prs = priv;
@@ -538,7 +713,7 @@ static size_t print_nodes(void *data, dst_t dst, const void *priv)
 	const prs_node_data_t *node = data;
 	switch (node->type) {
 	case PRS_NODE_RULE: {
-		stx_node_data_t *rule = stx_get_node(prs->stx, node->val.rule);
+		stx_node_data_t *rule = stx_get_node(prs->stx, node->val.rule.id);
 		strv_t name	      = strvbuf_get(&prs->stx->strs, rule->val.name);
 		dst.off += dputf(dst, "%.*s\n", name.len, name.data);
 		break;
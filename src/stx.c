@@ -1,6 +1,10 @@
 #include "stx.h"
 
 #include "log.h"
+#include "mem.h"
+
+#define STX_RULES_CAP  16
+#define STX_RULES_NONE ((stx_node_t)-1)
 
 stx_t *stx_init(stx_t *stx, uint nodes_cap, alloc_t alloc)
 {
@@ -14,6 +18,10 @@ stx_t *stx_init(stx_t *stx, uint nodes_cap, alloc_t alloc)
 		return NULL;
 	}
 
+	stx->rules     = NULL;
+	stx->rules_cap = 0;
+	stx->rules_cnt = 0;
+
 	return stx;
 }
 
@@ -23,16 +31,110 @@ void stx_free(stx_t *stx)
 		return;
 	}
 
+	if (stx->rules) {
+		alloc_free(&stx->nodes.alloc, stx->rules, stx->rules_cap * sizeof(stx_node_t));
+		stx->rules = NULL;
+	}
+
 	list_free(&stx->nodes);
 	strvbuf_free(&stx->strs);
 }
 
+// Rules are indexed by name in an open addressing table of node ids
+static uint stx_rules_hash(strv_t name, uint cap)
+{
+	uint hash = 2166136261u;
+	for (size_t i = 0; i < name.len; i++) {
+		hash = (hash ^ (byte)name.data[i]) * 16777619u;
+	}
+
+	return hash & (cap - 1);
+}
+
+static strv_t stx_rules_name(const stx_t *stx, stx_node_t rule)
+{
+	const stx_node_data_t *data = list_get(&stx->nodes, rule);
+	return strvbuf_get(&stx->strs, data->val.name);
+}
+
+static void stx_rules_set(const stx_t *stx, stx_node_t *rules, uint cap, stx_node_t rule)
+{
+	uint i = stx_rules_hash(stx_rules_name(stx, rule), cap);
+	while (rules[i] != STX_RULES_NONE) {
+		i = (i + 1) & (cap - 1);
+	}
+	rules[i] = rule;
+}
+
+static int stx_rules_reserve(stx_t *stx)
+{
+	if ((stx->rules_cnt + 1) * 4 <= stx->rules_cap * 3) {
+		return 0;
+	}
+
+	uint cap	  = stx->rules_cap == 0 ? STX_RULES_CAP : stx->rules_cap * 2;
+	stx_node_t *rules = alloc_alloc(&stx->nodes.alloc, cap * sizeof(stx_node_t));
+	if (rules == NULL) {
+		log_error("cparse", "stx", NULL, "failed to allocate rules index");
+		return 1;
+	}
+
+	mem_set(rules, 0xff, cap * sizeof(stx_node_t));
+
+	for (uint i = 0; i < stx->rules_cap; i++) {
+		if (stx->rules[i] != STX_RULES_NONE) {
+			stx_rules_set(stx, rules, cap, stx->rules[i]);
+		}
+	}
+
+	if (stx->rules) {
+		alloc_free(&stx->nodes.alloc, stx->rules, stx->rules_cap * sizeof(stx_node_t));
+	}
+
+	stx->rules     = rules;
+	stx->rules_cap = cap;
+	return 0;
+}
+
+static int stx_rules_find(const stx_t *stx, strv_t name, stx_node_t *rule)
+{
+	if (stx->rules == NULL) {
+		return 1;
+	}
+
+	for (uint i = stx_rules_hash(name, stx->rules_cap);; i = (i + 1) & (stx->rules_cap - 1)) {
+		if (stx->rules[i] == STX_RULES_NONE) {
+			return 1;
+		}
+
+		if (strv_eq(stx_rules_name(stx, stx->rules[i]), name)) {
+			*rule = stx->rules[i];
+			return 0;
+		}
+	}
+}
+
+static void stx_rules_add(stx_t *stx, stx_node_t rule)
+{
+	stx_node_t found;
+	if (stx_rules_find(stx, stx_rules_name(stx, rule), &found) == 0) {
+		return;
+	}
+
+	stx_rules_set(stx, stx->rules, stx->rules_cap, rule);
+	stx->rules_cnt++;
+}
+
 int stx_rule(stx_t *stx, strv_t name, stx_node_t *rule)
 {
 	if (stx == NULL) {
 		return 1;
 	}
 
+	if (stx_rules_reserve(stx)) {
+		return 1;
+	}
+
 	size_t rule_name;
 	size_t used = stx->strs.used;
 	if (strvbuf_add(&stx->strs, name, &rule_name)) {
@@ -40,7 +142,8 @@ int stx_rule(stx_t *stx, strv_t name, stx_node_t *rule)
 		return 1;
 	}
 
-	stx_node_data_t *data = list_node(&stx->nodes, rule);
+	stx_node_t id;
+	stx_node_data_t *data = list_node(&stx->nodes, &id);
 	if (data == NULL) {
 		buf_reset(&stx->strs, used);
 		log_error("cparse", "stx", NULL, "failed to add rule");
@@ -52,6 +155,12 @@ int stx_rule(stx_t *stx, strv_t name, stx_node_t *rule)
 		.val.name = rule_name,
 	};
 
+	stx_rules_add(stx, id);
+
+	if (rule) {
+		*rule = id;
+	}
+
 	return 0;
 }
 
@@ -159,27 +268,41 @@ int stx_term_or(stx_t *stx, stx_node_t l, stx_node_t r, stx_node_t *term)
 	return 0;
 }
 
-int stx_find_rule(stx_t *stx, strv_t name, stx_node_t *rule)
+int stx_term_set(stx_t *stx, const tok_set_t *set, stx_node_t *term)
 {
-	if (stx == NULL) {
+	if (stx == NULL || set == NULL) {
 		return 1;
 	}
 
-	uint i = 0;
-	stx_node_data_t *node;
-	stx_node_foreach_all(&stx->nodes, i, node)
-	{
-		if (node->type != STX_RULE) {
-			continue;
-		}
+	size_t off;
+	size_t used = stx->strs.used;
+	if (strvbuf_add(&stx->strs, STRVN((const char *)set->bits, sizeof(set->bits)), &off)) {
+		log_error("cparse", "stx", NULL, "failed to add set");
+		return 1;
+	}
 
-		if (strv_eq(strvbuf_get(&stx->strs, node->val.name), name)) {
-			*rule = i;
-			return 0;
-		}
+	stx_node_data_t *data = list_node(&stx->nodes, term);
+	if (data == NULL) {
+		buf_reset(&stx->strs, used);
+		log_error("cparse", "stx", NULL, "failed to create set term");
+		return 1;
 	}
 
-	return 1;
+	*data = (stx_node_data_t){
+		.type	 = STX_TERM_SET,
+		.val.set = off,
+	};
+
+	return 0;
+}
+
+int stx_find_rule(stx_t *stx, strv_t name, stx_node_t *rule)
+{
+	if (stx == NULL) {
+		return 1;
+	}
+
+	return stx_rules_find(stx, name, rule);
 }
 
 stx_node_data_t *stx_get_node(const stx_t *stx, stx_node_t node)
@@ -206,6 +329,15 @@ strv_t stx_data_lit(const stx_t *stx, const stx_node_data_t *data)
 	return strvbuf_get(&stx->strs, data->val.lit);
 }
 
+const tok_set_t *stx_data_set(const stx_t *stx, const stx_node_data_t *data)
+{
+	if (stx == NULL || data == NULL || data->type != STX_TERM_SET) {
+		return NULL;
+	}
+
+	return (const tok_set_t *)strvbuf_get(&stx->strs, data->val.set).data;
+}
+
 int stx_add_term(stx_t *stx, stx_node_t node, stx_node_t term)
 {
 	if (stx == NULL) {
@@ -342,6 +474,10 @@ static size_t stx_terms_print(const stx_t *stx, stx_node_t terms, dst_t dst)
 			}
 			break;
 		}
+		case STX_TERM_SET:
+			dst.off += dputs(dst, STRV(" "));
+			dst.off += tok_set_print(stx_data_set(stx, term), dst);
+			break;
 		case STX_TERM_OR:
 			dst.off += stx_terms_print(stx, term->val.orv.l, dst);
 			dst.off += dputs(dst, STRV(" |"));
@@ -483,6 +619,15 @@ static size_t stx_node_print_tree(const stx_t *stx, stx_node_t rule, dst_t dst)
 			}
 			break;
 		}
+		case STX_TERM_SET: {
+			dst.off += print_header(stx, stack, state, top, dst);
+			dst.off += tok_set_print(stx_data_set(stx, term), dst);
+			dst.off += dputs(dst, STRV("\n"));
+			if (list_get_next(&stx->nodes, stack[top - 1], &stack[top - 1]) == NULL) {
+				top--;
+			}
+			break;
+		}
 		case STX_TERM_OR:
 			if (state[top - 1] == 0) {
 				state[top - 1] = 1;
@@ -531,3 +676,214 @@ size_t stx_print_tree(const stx_t *stx, dst_t dst)
 
 	return dst.off - off;
 }
+
+#define STX_BIN_MAGIC	0x00585453 // "STX"
+#define STX_BIN_VERSION 1
+#define STX_BIN_NONE	0xffffffff
+
+// The binary format is a header (magic, version, node count), every node in index order (type and the values of its type) and the
+// next node of every node. Values are 32 bit little endian, strings are stored with their length in front and nodes refer to each
+// other by index.
+typedef struct stx_bin_s {
+	byte *data;
+	size_t size;
+	size_t off;
+} stx_bin_t;
+
+static void stx_bin_put(stx_bin_t *bin, uint val)
+{
+	for (int i = 0; i < 4; i++) {
+		if (bin->off < bin->size) {
+			bin->data[bin->off] = (byte)(val >> (i * 8));
+		}
+		bin->off++;
+	}
+}
+
+static void stx_bin_put_str(stx_bin_t *bin, strv_t str)
+{
+	stx_bin_put(bin, (uint)str.len);
+	for (size_t i = 0; i < str.len; i++) {
+		if (bin->off < bin->size) {
+			bin->data[bin->off] = (byte)str.data[i];
+		}
+		bin->off++;
+	}
+}
+
+static int stx_bin_get(stx_bin_t *bin, uint *val)
+{
+	if (bin->size - bin->off < 4) {
+		return 1;
+	}
+
+	const byte *data = &bin->data[bin->off];
+	*val		 = (uint)data[0] | (uint)data[1] << 8 | (uint)data[2] << 16 | (uint)data[3] << 24;
+	bin->off += 4;
+	return 0;
+}
+
+static int stx_bin_get_str(stx_bin_t *bin, strv_t *str)
+{
+	uint len;
+	if (stx_bin_get(bin, &len) || bin->size - bin->off < len) {
+		return 1;
+	}
+
+	*str = STRVN((const char *)&bin->data[bin->off], len);
+	bin->off += len;
+	return 0;
+}
+
+size_t stx_save(const stx_t *stx, void *buf, size_t size)
+{
+	if (stx == NULL) {
+		return 0;
+	}
+
+	stx_bin_t bin = {.data = buf, .size = buf == NULL ? 0 : size};
+
+	stx_bin_put(&bin, STX_BIN_MAGIC);
+	stx_bin_put(&bin, STX_BIN_VERSION);
+	stx_bin_put(&bin, stx->nodes.cnt);
+
+	uint i = 0;
+	const stx_node_data_t *node;
+	stx_node_foreach_all(&stx->nodes, i, node)
+	{
+		stx_bin_put(&bin, node->type);
+
+		switch (node->type) {
+		case STX_RULE: stx_bin_put_str(&bin, strvbuf_get(&stx->strs, node->val.name)); break;
+		case STX_TERM_RULE: stx_bin_put(&bin, node->val.rule); break;
+		case STX_TERM_TOK: stx_bin_put(&bin, node->val.tok); break;
+		case STX_TERM_LIT: stx_bin_put_str(&bin, strvbuf_get(&stx->strs, node->val.lit)); break;
+		case STX_TERM_SET: stx_bin_put_str(&bin, strvbuf_get(&stx->strs, node->val.set)); break;
+		case STX_TERM_OR:
+			stx_bin_put(&bin, node->val.orv.l);
+			stx_bin_put(&bin, node->val.orv.r);
+			break;
+		default: break;
+		}
+	}
+
+	for (i = 0; i < stx->nodes.cnt; i++) {
+		stx_node_t next;
+		stx_bin_put(&bin, list_get_next(&stx->nodes, i, &next) ? next : STX_BIN_NONE);
+	}
+
+	return bin.off;
+}
+
+static int stx_load_str(stx_t *stx, stx_bin_t *bin, size_t *off)
+{
+	strv_t str;
+	if (stx_bin_get_str(bin, &str)) {
+		return 1;
+	}
+
+	if (strvbuf_add(&stx->strs, str, off)) {
+		log_error("cparse", "stx", NULL, "failed to add string");
+		return 1;
+	}
+
+	return 0;
+}
+
+static int stx_load_node(stx_t *stx, stx_bin_t *bin, uint cnt)
+{
+	uint type;
+	if (stx_bin_get(bin, &type)) {
+		return 1;
+	}
+
+	if (type == STX_RULE && stx_rules_reserve(stx)) {
+		return 1;
+	}
+
+	stx_node_t id;
+	stx_node_data_t *data = list_node(&stx->nodes, &id);
+	if (data == NULL) {
+		log_error("cparse", "stx", NULL, "failed to create node");
+		return 1;
+	}
+
+	*data = (stx_node_data_t){
+		.type = type,
+	};
+
+	uint a = 0, b = 0;
+	switch (type) {
+	case STX_UNKNOWN: return 0;
+	case STX_RULE:
+		if (stx_load_str(stx, bin, &data->val.name)) {
+			return 1;
+		}
+		stx_rules_add(stx, id);
+		return 0;
+	case STX_TERM_RULE:
+		if (stx_bin_get(bin, &a) || a >= cnt) {
+			return 1;
+		}
+		data->val.rule = a;
+		return 0;
+	case STX_TERM_TOK:
+		if (stx_bin_get(bin, &a) || a >= __TOK_MAX) {
+			return 1;
+		}
+		data->val.tok = a;
+		return 0;
+	case STX_TERM_LIT: return stx_load_str(stx, bin, &data->val.lit);
+	case STX_TERM_SET: return stx_load_str(stx, bin, &data->val.set) || strvbuf_get(&stx->strs, data->val.set).len != sizeof(tok_set_t);
+	case STX_TERM_OR:
+		if (stx_bin_get(bin, &a) || stx_bin_get(bin, &b) || a >= cnt || b >= cnt) {
+			return 1;
+		}
+		data->val.orv.l = a;
+		data->val.orv.r = b;
+		return 0;
+	default: return 1;
+	}
+}
+
+int stx_load(stx_t *stx, const void *data, size_t size)
+{
+	if (stx == NULL || data == NULL) {
+		return 1;
+	}
+
+	if (stx->nodes.cnt > 0) {
+		log_error("cparse", "stx", NULL, "grammar is not empty");
+		return 1;
+	}
+
+	stx_bin_t bin = {.data = (byte *)data, .size = size};
+
+	uint magic, version, cnt;
+	if (stx_bin_get(&bin, &magic) || stx_bin_get(&bin, &version) || stx_bin_get(&bin, &cnt) || magic != STX_BIN_MAGIC) {
+		log_error("cparse", "stx", NULL, "invalid grammar data");
+		return 1;
+	}
+
+	if (version != STX_BIN_VERSION) {
+		log_error("cparse", "stx", NULL, "unsupported grammar version: %d", version);
+		return 1;
+	}
+
+	for (uint i = 0; i < cnt; i++) {
+		if (stx_load_node(stx, &bin, cnt)) {
+			log_error("cparse", "stx", NULL, "invalid grammar node: %d", i);
+			return 1;
+		}
+	}
+
+	for (uint i = 0; i < cnt; i++) {
+		uint next;
+		if (stx_bin_get(&bin, &next) || (next != STX_BIN_NONE && (next >= cnt || list_app(&stx->nodes, i, next)))) {
+			log_error("cparse", "stx", NULL, "invalid grammar node link: %d", i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
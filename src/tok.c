@@ -49,3 +49,66 @@ tok_type_t tok_type_enum(strv_t str)
 
 	return TOK_UNKNOWN;
 }
+
+void tok_set_add(tok_set_t *set, byte from, byte to)
+{
+	if (set == NULL) {
+		return;
+	}
+
+	for (uint c = from; c <= to; c++) {
+		set->bits[c >> 3] |= (byte)(1 << (c & 7));
+	}
+}
+
+int tok_set_has(const tok_set_t *set, byte c)
+{
+	return set != NULL && ((set->bits[c >> 3] >> (c & 7)) & 1);
+}
+
+static size_t tok_set_chr_print(byte c, dst_t dst)
+{
+	if (c == ']' || c == '\\' || c == '-') {
+		return dputf(dst, "\\%c", c);
+	}
+
+	if (c < ' ' || c > '~') {
+		return dputf(dst, "\\x%02x", c);
+	}
+
+	return dputf(dst, "%c", c);
+}
+
+// Runs of three or more characters are printed as ranges
+size_t tok_set_print(const tok_set_t *set, dst_t dst)
+{
+	if (set == NULL) {
+		return 0;
+	}
+
+	size_t off = dst.off;
+
+	dst.off += dputs(dst, STRV("["));
+	for (uint c = 0; c < 256; c++) {
+		if (!tok_set_has(set, (byte)c)) {
+			continue;
+		}
+
+		uint to = c;
+		while (to < 255 && tok_set_has(set, (byte)(to + 1))) {
+			to++;
+		}
+
+		dst.off += tok_set_chr_print((byte)c, dst);
+		if (to - c >= 2) {
+			dst.off += dputs(dst, STRV("-"));
+			dst.off += tok_set_chr_print((byte)to, dst);
+		} else if (to > c) {
+			dst.off += tok_set_chr_print((byte)to, dst);
+		}
+		c = to;
+	}
+	dst.off += dputs(dst, STRV("]"));
+
+	return dst.off - off;
+}
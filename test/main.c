@@ -2,10 +2,12 @@
 #include "mem.h"
 #include "test.h"
 
+STEST(arena);
 STEST(bnf);
 STEST(cfg);
 STEST(cfg_prs);
 STEST(ebnf);
+STEST(egen);
 STEST(eprs);
 STEST(estx);
 STEST(lex);
@@ -17,10 +19,12 @@ STEST(tok);
 TEST(cparse)
 {
 	SSTART;
+	RUN(arena);
 	RUN(bnf);
 	RUN(cfg);
 	RUN(cfg_prs);
 	RUN(ebnf);
+	RUN(egen);
 	RUN(eprs);
 	RUN(estx);
 	RUN(lex);
@@ -0,0 +1,183 @@
+#include "arena.h"
+
+#include "file/cfg_prs.h"
+#include "log.h"
+#include "mem.h"
+#include "test.h"
+
+TEST(arena_init_free)
+{
+	START;
+
+	arena_t arena = {0};
+
+	EXPECT_NULL(arena_init(NULL, 0, ALLOC_STD));
+	EXPECT_PTR(arena_init(&arena, 64, ALLOC_STD), &arena);
+	EXPECT_EQ(arena.chunk_size, 64);
+
+	arena_free(NULL);
+	arena_free(&arena);
+
+	END;
+}
+
+TEST(arena_alloc)
+{
+	START;
+
+	arena_t arena = {0};
+	arena_init(&arena, 64, ALLOC_STD);
+
+	EXPECT_NULL(arena_alloc(NULL, 1));
+
+	byte *a = arena_alloc(&arena, 1);
+	byte *b = arena_alloc(&arena, 20);
+	byte *c = arena_alloc(&arena, 1);
+	EXPECT_NOT_NULL(a);
+	EXPECT_EQ(b - a, 16);
+	EXPECT_EQ(c - b, 32);
+
+	byte *d = arena_alloc(&arena, 16);
+	EXPECT_EQ(arena.cur != arena.first, 1);
+	EXPECT_EQ(arena.used, 16);
+
+	byte *e = arena_alloc(&arena, 100);
+	EXPECT_NOT_NULL(d);
+	EXPECT_NOT_NULL(e);
+	EXPECT_EQ(arena.used, 112);
+
+	mem_oom(1);
+	log_set_quiet(0, 1);
+	EXPECT_NULL(arena_alloc(&arena, 1));
+	log_set_quiet(0, 0);
+	mem_oom(0);
+
+	arena_free(&arena);
+
+	END;
+}
+
+TEST(arena_reset)
+{
+	START;
+
+	arena_t arena = {0};
+	arena_init(&arena, 64, ALLOC_STD);
+
+	arena_reset(NULL);
+	arena_reset(&arena);
+
+	byte *a = arena_alloc(&arena, 64);
+	byte *b = arena_alloc(&arena, 128);
+
+	arena_reset(&arena);
+
+	EXPECT_PTR(arena_alloc(&arena, 64), a);
+	EXPECT_PTR(arena_alloc(&arena, 128), b);
+
+	arena_reset(&arena);
+
+	mem_oom(1);
+	EXPECT_PTR(arena_alloc(&arena, 32), a);
+	EXPECT_PTR(arena_alloc(&arena, 48), b);
+	mem_oom(0);
+
+	arena_free(&arena);
+
+	END;
+}
+
+TEST(arena_to_alloc)
+{
+	START;
+
+	arena_t arena = {0};
+	arena_init(&arena, 64, ALLOC_STD);
+
+	alloc_t alloc = arena_to_alloc(&arena);
+
+	byte *a = alloc_alloc(&alloc, 8);
+	byte *b = alloc_alloc(&alloc, 8);
+	EXPECT_EQ(b - a, 16);
+
+	a[0] = 1;
+	EXPECT_PTR(alloc.realloc(&alloc, b, 8, 32), b);
+	EXPECT_EQ(arena.used, 48);
+
+	byte *c = alloc.realloc(&alloc, a, 8, 16);
+	EXPECT_EQ(c - b, 32);
+	EXPECT_EQ(c[0], 1);
+
+	alloc_free(&alloc, c, 16);
+	EXPECT_EQ(arena.used, 64);
+
+	arena_free(&arena);
+
+	END;
+}
+
+TEST(arena_parse)
+{
+	START;
+
+	arena_t arena = {0};
+	arena_init(&arena, 4096, ALLOC_STD);
+
+	alloc_t alloc = arena_to_alloc(&arena);
+
+	strv_t str = STRV("int = 1\n"
+			  "\n"
+			  "[tbl]\n"
+			  "str = \"str\"\n"
+			  "arr = [1, 2]\n");
+
+	arena_chunk_t *first = NULL;
+	for (int i = 0; i < 2; i++) {
+		cfg_prs_t prs = {0};
+		EXPECT_PTR(cfg_prs_init(&prs, alloc), &prs);
+
+		lex_t lex = {0};
+		lex_init(&lex, 1, 16, alloc);
+		EXPECT_EQ(lex_tokenize(&lex, str, STRV(__FILE__), __LINE__), 0);
+
+		eprs_t eprs = {0};
+		eprs_init(&eprs, 16, alloc);
+		eprs_node_t root;
+		EXPECT_EQ(eprs_parse(&eprs, &lex, &prs.estx, prs.file, &root, DST_NONE()), 0);
+
+		cfg_t cfg = {0};
+		cfg_init(&cfg, 1, 1, alloc);
+		cfg_var_t var;
+		EXPECT_EQ(cfg_prs_parse(&prs, str, &cfg, &var, DST_NONE()), 0);
+
+		char buf[256] = {0};
+		cfg_print(&cfg, var, DST_BUF(buf));
+		EXPECT_STR(buf, str.data);
+
+		// nothing is freed one by one, the second parse refills the chunks of the first one
+		if (i == 0) {
+			first = arena.first;
+		} else {
+			EXPECT_PTR(arena.first, first);
+		}
+
+		arena_reset(&arena);
+	}
+
+	arena_free(&arena);
+
+	END;
+}
+
+STEST(arena)
+{
+	SSTART;
+
+	RUN(arena_init_free);
+	RUN(arena_alloc);
+	RUN(arena_reset);
+	RUN(arena_to_alloc);
+	RUN(arena_parse);
+
+	SEND;
+}
@@ -20,6 +20,43 @@ TEST(cfg_prs_init_free)
 	END;
 }
 
+TESTP(cfg_prs_estx, cfg_prs_t *prs)
+{
+	START;
+
+	EXPECT_NULL(cfg_prs_estx(NULL, ALLOC_STD));
+
+	estx_t estx = {0};
+	EXPECT_EQ(cfg_prs_estx(&estx, ALLOC_STD), &estx);
+	EXPECT_EQ(estx_optimize(&estx), 0);
+	EXPECT_EQ(estx_analyze(&estx, prs->file, DST_NONE()), 0);
+
+	size_t size = estx_save(&estx, NULL, 0);
+	EXPECT_EQ(estx_save(&prs->estx, NULL, 0), size);
+
+	// Fails when the grammar changed without regenerating cfg_prs_estx.h
+	char *exp_tbl = mem_alloc(size);
+	char *tbl     = mem_alloc(size);
+	estx_save(&estx, exp_tbl, size);
+	estx_save(&prs->estx, tbl, size);
+	EXPECT_EQ(strv_eq(STRVN(tbl, size), STRVN(exp_tbl, size)), 1);
+	mem_free(tbl, size);
+	mem_free(exp_tbl, size);
+
+	char exp[4096] = {0};
+	char buf[4096] = {0};
+	estx_print(&estx, DST_BUF(exp));
+	estx_print(&prs->estx, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+	estx_print_info(&estx, DST_BUF(exp));
+	estx_print_info(&prs->estx, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+
+	estx_free(&estx);
+
+	END;
+}
+
 TESTP(cfg_prs_null, cfg_prs_t *prs)
 {
 	START;
@@ -30,15 +67,15 @@ TESTP(cfg_prs_null, cfg_prs_t *prs)
 	strv_t str  = STRV("");
 	strv_t str2 = STRV("int0 = 1\n");
 
-	uint cap = prs->lex.toks.cap;
+	uint cap = prs->ctx.lex.toks.cap;
 
 	EXPECT_EQ(cfg_prs_parse(NULL, STRV_NULL, NULL, NULL, DST_NONE()), 1);
 	EXPECT_EQ(cfg_prs_parse(prs, STRV_NULL, NULL, NULL, DST_NONE()), 1);
 	EXPECT_EQ(cfg_prs_parse(prs, str, NULL, NULL, DST_NONE()), 1);
 	mem_oom(1);
-	prs->lex.toks.cap = 0;
+	prs->ctx.lex.toks.cap = 0;
 	EXPECT_EQ(cfg_prs_parse(prs, str2, &cfg, NULL, DST_NONE()), 1);
-	prs->lex.toks.cap = cap;
+	prs->ctx.lex.toks.cap = cap;
 	mem_oom(0);
 	EXPECT_EQ(cfg_prs_parse(prs, str, &cfg, NULL, DST_NONE()), 0);
 
@@ -301,6 +338,118 @@ TESTP(cfg_prs_test, cfg_prs_t *prs)
 	END;
 }
 
+TESTP(cfg_prs_batch, cfg_prs_t *prs)
+{
+	START;
+
+	cfg_prs_ctx_t ctx = {0};
+	EXPECT_NULL(cfg_prs_ctx_init(NULL, ALLOC_STD));
+	mem_oom(1);
+	EXPECT_NULL(cfg_prs_ctx_init(&ctx, ALLOC_STD));
+	mem_oom(0);
+	cfg_prs_ctx_init(&ctx, ALLOC_STD);
+
+	cfg_t cfgs[2] = {0};
+	cfg_init(&cfgs[0], 1, 1, ALLOC_STD);
+	cfg_init(&cfgs[1], 1, 1, ALLOC_STD);
+
+	strv_t strs[] = {
+		STRV("int = 1\n"),
+		STRV("str = \"str\"\n"),
+	};
+	cfg_var_t roots[2];
+
+	EXPECT_EQ(cfg_prs_parse_batch(NULL, &ctx, strs, 2, cfgs, roots, DST_NONE()), 1);
+	EXPECT_EQ(cfg_prs_parse_batch(prs, NULL, strs, 2, cfgs, roots, DST_NONE()), 1);
+	EXPECT_EQ(cfg_prs_parse_batch(prs, &ctx, NULL, 2, cfgs, roots, DST_NONE()), 1);
+	EXPECT_EQ(cfg_prs_parse_batch(prs, &ctx, strs, 2, NULL, roots, DST_NONE()), 1);
+	EXPECT_EQ(cfg_prs_parse_batch(prs, &ctx, strs, 2, cfgs, roots, DST_NONE()), 0);
+
+	char buf[64] = {0};
+	cfg_print(&cfgs[0], roots[0], DST_BUF(buf));
+	EXPECT_STR(buf, "int = 1\n");
+	cfg_print(&cfgs[1], roots[1], DST_BUF(buf));
+	EXPECT_STR(buf, "str = \"str\"\n");
+
+	cfg_free(&cfgs[0]);
+	cfg_free(&cfgs[1]);
+	cfg_prs_ctx_free(&ctx);
+	cfg_prs_ctx_free(NULL);
+
+	END;
+}
+
+static void cfg_prs_split_run(eprs_piece_t *pieces, uint cnt, void *priv)
+{
+	uint *runs = priv;
+	for (uint i = cnt; i > 0; i--) {
+		eprs_parse_piece(&pieces[i - 1]);
+	}
+	(*runs)++;
+}
+
+TESTP(cfg_prs_split, cfg_prs_t *prs)
+{
+	START;
+
+	cfg_prs_ctx_t ctx = {0};
+	cfg_prs_ctx_init(&ctx, ALLOC_STD);
+
+	cfg_t cfg = {0};
+	cfg_init(&cfg, 1, 1, ALLOC_STD);
+
+	strv_t str = STRV("int = 0\n"
+			  "\n"
+			  "[tbl]\n"
+			  "int = 1\n"
+			  "str = \"str\"\n"
+			  "arr:\n"
+			  "\"val1\"\n"
+			  "\"val2\"\n"
+			  "\n"
+			  "lit = lit_LIT\n"
+			  "obj = {str = \"str\", int = 1}\n"
+			  "int += 2\n"
+			  "\n"
+			  "[tbll]\n"
+			  "int = 3\n");
+
+	cfg_var_t root;
+	char exp[1024] = {0};
+	char buf[1024] = {0};
+	EXPECT_EQ(cfg_prs_parse_ctx(prs, &ctx, str, &cfg, &root, DST_STD()), 0);
+	cfg_print(&cfg, root, DST_BUF(exp));
+
+	cfg_prs_ctx_set_split(NULL, 4, NULL, NULL);
+	cfg_prs_ctx_set_split(&ctx, 4, NULL, NULL);
+	EXPECT_EQ(ctx.eprs.pieces_cnt, 4);
+	cfg_free(&cfg);
+	cfg_init(&cfg, 1, 1, ALLOC_STD);
+	EXPECT_EQ(cfg_prs_parse_ctx(prs, &ctx, str, &cfg, &root, DST_STD()), 0);
+	cfg_print(&cfg, root, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+	EXPECT_EQ(ctx.pieces[1].end > ctx.pieces[1].start, 1);
+
+	uint runs = 0;
+	cfg_prs_ctx_set_split(&ctx, CFG_PRS_PIECES + 1, cfg_prs_split_run, &runs);
+	EXPECT_EQ(ctx.eprs.pieces_cnt, CFG_PRS_PIECES);
+	cfg_free(&cfg);
+	cfg_init(&cfg, 1, 1, ALLOC_STD);
+	EXPECT_EQ(cfg_prs_parse_ctx(prs, &ctx, str, &cfg, &root, DST_STD()), 0);
+	mem_set(buf, 0, sizeof(buf));
+	cfg_print(&cfg, root, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+	EXPECT_EQ(runs, 1);
+
+	cfg_prs_ctx_set_split(&ctx, 0, NULL, NULL);
+	EXPECT_NULL(ctx.eprs.pieces);
+
+	cfg_free(&cfg);
+	cfg_prs_ctx_free(&ctx);
+
+	END;
+}
+
 STEST(cfg_prs)
 {
 	SSTART;
@@ -308,6 +457,7 @@ STEST(cfg_prs)
 	RUN(cfg_prs_init_free);
 	cfg_prs_t prs = {0};
 	cfg_prs_init(&prs, ALLOC_STD);
+	RUNP(cfg_prs_estx, &prs);
 	RUNP(cfg_prs_null, &prs);
 	RUNP(cfg_prs_fail, &prs);
 	RUNP(cfg_prs_root, &prs);
@@ -318,6 +468,8 @@ STEST(cfg_prs)
 	RUNP(cfg_prs_arr_two, &prs);
 	RUNP(cfg_prs_tbl, &prs);
 	RUNP(cfg_prs_test, &prs);
+	RUNP(cfg_prs_batch, &prs);
+	RUNP(cfg_prs_split, &prs);
 	cfg_prs_free(&prs);
 	SEND;
 }
@@ -35,30 +35,44 @@ TEST(ebnf_get_stx)
 	mem_oom(0);
 	EXPECT_NOT_NULL(ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE()));
 
-	char buf[1024] = {0};
-	EXPECT_EQ(stx_print(&ebnf.stx, DST_BUF(buf)), 851);
+	char buf[2048] = {0};
+	EXPECT_EQ(stx_print(&ebnf.stx, DST_BUF(buf)), 1550);
 	EXPECT_STR(buf,
 		   "<file> ::= <ebnf> EOF\n"
 		   "<ebnf> ::= <rules>\n"
 		   "<rules> ::= <rule> <rules> | <rule>\n"
-		   "<rule> ::= <rname> <spaces> '=' <space> <alt> NL\n"
+		   "<rule> ::= <attrs> <rname> <spaces> '=' <space> <alt> NL | <rname> <spaces> '=' <space> <alt> NL\n"
+		   "<attrs> ::= <attr> <attrs> | <attr>\n"
 		   "<rname> ::= LOWER <rchars> | LOWER\n"
 		   "<spaces> ::= <space> <spaces> | <space>\n"
 		   "<space> ::= ' '\n"
 		   "<alt> ::= <concat> <space> '|' <space> <alt> | <concat>\n"
+		   "<attr> ::= '@' <rname> <space>\n"
 		   "<rchars> ::= <rchar> <rchars> | <rchar>\n"
 		   "<rchar> ::= LOWER | '_'\n"
 		   "<concat> ::= <factor> <space> <concat> | <factor>\n"
 		   "<factor> ::= <term> <opt> | <term> <rep> | <term> <opt-rep> | <term>\n"
-		   "<term> ::= <literal> | <token> | <rname> | <group>\n"
+		   "<term> ::= <literal> | <token> | <list> | <rname> | <group> | <set> | <cut>\n"
 		   "<opt> ::= '?'\n"
 		   "<rep> ::= '+'\n"
 		   "<opt-rep> ::= '*'\n"
 		   "<literal> ::= \"'\" <tdouble> \"'\" | '\"' <tsingle> '\"'\n"
 		   "<token> ::= UPPER <token> | UPPER\n"
+		   "<list> ::= 'list(' <alt> ', ' <lsep> ', ' <lmin> <lkeep> ')' | 'list(' <alt> ', ' <lsep> ', ' <lmin> ')'\n"
 		   "<group> ::= '(' <alt> ')'\n"
+		   "<set> ::= '[' <sitems> ']'\n"
+		   "<cut> ::= '~'\n"
 		   "<tdouble> ::= <cdouble> <tdouble> | <cdouble>\n"
 		   "<tsingle> ::= <csingle> <tsingle> | <csingle>\n"
+		   "<lsep> ::= <alt>\n"
+		   "<lmin> ::= DIGIT <lmin> | DIGIT\n"
+		   "<lkeep> ::= ', keep'\n"
+		   "<sitems> ::= <sitem> <sitems> | <sitem>\n"
+		   "<sitem> ::= <schar> <srange> | <schar>\n"
+		   "<schar> ::= '\\' SYMBOL | ALPHA | DIGIT | QUOTE | ' ' | <ssym>\n"
+		   "<srange> ::= '-' <schar>\n"
+		   "<ssym> ::= '!' | '#' | '$' | '%' | '&' | '(' | ')' | '*' | '+' | ',' | '-' | '.' | '/' | ':' | ';' | '<' | '=' | '>' | "
+		   "'?' | '@' | '[' | '^' | '_' | '`' | '{' | '|' | '}' | '~'\n"
 		   "<cdouble> ::= <char> | '\"'\n"
 		   "<csingle> ::= <char> | \"'\"\n"
 		   "<char> ::= ALPHA | DIGIT | SYMBOL | ' '\n");
@@ -242,6 +256,138 @@ TEST(estx_from_ebnf)
 	END;
 }
 
+TEST(estx_from_ebnf_attrs)
+{
+	START;
+
+	ebnf_t ebnf = {0};
+	ebnf_init(&ebnf, ALLOC_STD);
+	ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_t new_stx = {0};
+	estx_init(&new_stx, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("file = word EOF\n@lex word = LOWER+\n"), STRV(__FILE__), __LINE__);
+	prs_node_t prs_root;
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+	estx_node_t root, word;
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &new_stx, &root), 0);
+	EXPECT_EQ(estx_find_rule(&new_stx, STRV("word"), &word), 0);
+	EXPECT_EQ(estx_get_node(&new_stx, word)->flags, ESTX_RULE_FLAG_LEX);
+
+	char buf[64] = {0};
+	estx_print(&new_stx, DST_BUF(buf));
+	EXPECT_STR(buf,
+		   "file = word EOF\n"
+		   "@lex word = LOWER+\n");
+
+	estx_free(&new_stx);
+	estx_init(&new_stx, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("@lex @abc word = LOWER+\n"), STRV(__FILE__), __LINE__);
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &new_stx, &root), 1);
+	log_set_quiet(0, 0);
+
+	estx_free(&new_stx);
+	prs_free(&prs);
+	lex_free(&lex);
+	ebnf_free(&ebnf);
+
+	END;
+}
+
+TEST(estx_from_ebnf_set)
+{
+	START;
+
+	ebnf_t ebnf = {0};
+	ebnf_init(&ebnf, ALLOC_STD);
+	ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_t new_stx = {0};
+	estx_init(&new_stx, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("file = [a-z_\\]'-]+ EOF\n"), STRV(__FILE__), __LINE__);
+	prs_node_t prs_root;
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+	estx_node_t root;
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &new_stx, &root), 0);
+
+	char buf[64] = {0};
+	estx_print(&new_stx, DST_BUF(buf));
+	EXPECT_STR(buf, "file = ['\\-\\]_a-z]+ EOF\n");
+
+	estx_free(&new_stx);
+	estx_init(&new_stx, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("file = [z-a0]\n"), STRV(__FILE__), __LINE__);
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &new_stx, &root), 1);
+	log_set_quiet(0, 0);
+
+	estx_free(&new_stx);
+	prs_free(&prs);
+	lex_free(&lex);
+	ebnf_free(&ebnf);
+
+	END;
+}
+
+TEST(estx_from_ebnf_list)
+{
+	START;
+
+	ebnf_t ebnf = {0};
+	ebnf_init(&ebnf, ALLOC_STD);
+	ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_t new_stx = {0};
+	estx_init(&new_stx, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("file = list(item, ', ', 12) EOF\nitem = list(DIGIT, '-' | '+', 0, keep)?\n"), STRV(__FILE__), __LINE__);
+	prs_node_t prs_root;
+	prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+	estx_node_t root;
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &new_stx, &root), 0);
+
+	char buf[128] = {0};
+	estx_print(&new_stx, DST_BUF(buf));
+	EXPECT_STR(buf,
+		   "file = list(item, ', ', 12) EOF\n"
+		   "item = list(DIGIT, '-' | '+', 0, keep)?\n");
+
+	estx_free(&new_stx);
+	prs_free(&prs);
+	lex_free(&lex);
+	ebnf_free(&ebnf);
+
+	END;
+}
+
 TEST(estx_from_ebnf_custom)
 {
 	START;
@@ -299,8 +445,7 @@ TEST(estx_from_ebnf_custom)
 	estx_node_t root;
 
 	log_set_quiet(0, 1);
-	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, file, &new_stx, &root), 0);
-	EXPECT_EQ(root, 0);
+	EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, file, &new_stx, &root), 1);
 	log_set_quiet(0, 0);
 
 	estx_free(&new_stx);
@@ -317,6 +462,9 @@ STEST(ebnf)
 	RUN(ebnf_init_free);
 	RUN(ebnf_get_stx);
 	RUN(estx_from_ebnf);
+	RUN(estx_from_ebnf_attrs);
+	RUN(estx_from_ebnf_set);
+	RUN(estx_from_ebnf_list);
 	RUN(estx_from_ebnf_custom);
 
 	SEND;
@@ -0,0 +1,401 @@
+#include "egen.h"
+
+#include "file/cfg_prs.h"
+#include "log.h"
+#include "mem.h"
+#include "test.h"
+
+int cfgg_parse(eprs_t *eprs, const lex_t *lex, eprs_node_t *root);
+
+#include "t_egen_cfg.h"
+
+static int egen_count(const char *buf, strv_t str)
+{
+	int cnt = 0;
+	for (size_t i = 0; buf[i]; i++) {
+		size_t j = 0;
+		while (j < str.len && buf[i + j] == str.data[j]) {
+			j++;
+		}
+		cnt += j == str.len;
+	}
+
+	return cnt;
+}
+
+// Counts the functions defined more than once
+static int egen_dups(const char *buf)
+{
+	int dups = 0;
+	for (size_t i = 0; buf[i]; i++) {
+		if ((i > 0 && buf[i - 1] != '\n') || egen_count(&buf[i], STRV("static int ")) == 0) {
+			continue;
+		}
+
+		size_t len = 0;
+		while (buf[i + len] && buf[i + len] != '\n') {
+			len++;
+		}
+
+		if (buf[i + len] == '\n' && buf[i + len + 1] == '{' && egen_count(buf, STRVN(&buf[i], len + 2)) > 1) {
+			dups++;
+		}
+	}
+
+	return dups;
+}
+
+TEST(egen_c_invalid)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	estx_node_t rule, num, ops, term;
+	estx_rule(&estx, STRV("expr"), &rule);
+	estx_rule(&estx, STRV("num"), &num);
+	estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &ops);
+	estx_term_expr(&estx, num, ops, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, rule, term);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, num, term);
+
+	char buf[64] = {0};
+	EXPECT_EQ(egen_c(NULL, rule, STRV("expr"), DST_BUF(buf)), 0);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(egen_c(&estx, term, STRV("expr"), DST_BUF(buf)), 0);
+	EXPECT_EQ(egen_c(&estx, rule, STRV("expr"), DST_BUF(buf)), 0);
+	log_set_quiet(0, 0);
+	EXPECT_STR(buf, "");
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(egen_c)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	estx_node_t list, item, terms, term;
+	estx_rule(&estx, STRV("list"), &list);
+	estx_rule(&estx, STRV("item"), &item);
+
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_cut(&estx, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_lit(&estx, STRV(",'"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_group(&estx, terms, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, list, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_LOWER, ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, terms, term);
+	tok_set_t set = {0};
+	tok_set_add(&set, '0', '9');
+	estx_term_set(&estx, &set, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_alt(&estx, terms, &term);
+	estx_add_term(&estx, item, term);
+
+	char *buf = mem_alloc(8192);
+	EXPECT_EQ(egen_c(&estx, list, STRV("list"), DST_BUFN(buf, 8192)) > 0, 1);
+	EXPECT_EQ(egen_dups(buf), 0);
+	EXPECT_EQ(egen_count(buf, STRV("static int list_rule_list(eprs_t *eprs, uint *off, eprs_node_t node);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("static int list_rule_item(eprs_t *eprs, uint *off, eprs_node_t node);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (eprs_node_rule(eprs, 1, &child) || list_rule_item(eprs, off, child)) {\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\t*cut = 1;\n")), 1);
+	EXPECT_EQ(egen_count(buf,
+			     STRV("\tif (list_chr(eprs->lex, *off, ',') ||\n"
+				  "\t    list_chr(eprs->lex, *off + 1, '\\'')) {\n")),
+		  1);
+	EXPECT_EQ(egen_count(buf, STRV("\treturn list_lit(eprs, off, node, 2);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\treturn list_tok(eprs, off, node, TOK_EOF);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\treturn list_tok(eprs, off, node, TOK_LOWER);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\t\t0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x03,\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (list_set(eprs->lex, *off, set)) {\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (val.len != 1) {\n\t\treturn 1;\n\t}\n\n\tbyte c = (byte)val.data[0];\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tint ret = list_term_5(eprs, off, node, &attempt);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tint ret = list_term_9(eprs, off, node, &attempt);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (ret) {\n\t\t*off = cur;\n\t\treturn 1;\n\t}\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\talt = 0;\n")), 3);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (alt) {\n\t\treturn 1;\n\t}\n")), 2);
+	EXPECT_EQ(egen_count(buf, STRV("\teprs_set_span(eprs, node, cur, *off - cur);\n")), 2);
+	EXPECT_EQ(egen_count(buf, STRV("int list_parse(eprs_t *eprs, const lex_t *lex, eprs_node_t *root)\n")), 1);
+	EXPECT_EQ(egen_count(buf,
+			     STRV("\tif (eprs_node_rule(eprs, 0, &node) || list_rule_list(eprs, &off, node) || off != lex->toks.cnt) {\n")),
+		  1);
+	mem_free(buf, 8192);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(egen_c_rules)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	estx_node_t file, word, item, none, terms, term;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("word"), &word);
+	estx_rule(&estx, STRV("item"), &item);
+	estx_rule(&estx, STRV("none"), &none);
+	estx_rule_set_flags(&estx, word, ESTX_RULE_FLAG_LEX);
+	estx_rule_set_flags(&estx, item, ESTX_RULE_FLAG_INLINE);
+
+	estx_term_rule(&estx, word, ESTX_TERM_OCC_OPT, &terms);
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_rule(&estx, none, ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, word, term);
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, item, term);
+
+	char *buf = mem_alloc(8192);
+	EXPECT_EQ(egen_c(&estx, file, STRV("rules"), DST_BUFN(buf, 8192)) > 0, 1);
+	EXPECT_EQ(egen_dups(buf), 0);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (ret) {\n\t\t*off = cur;\n\t\treturn 0;\n\t}\n")), 2);
+	EXPECT_EQ(egen_count(buf,
+			     STRV("\teprs->recognize = 1;\n"
+				  "\tint ret\t\t= rules_term_8(eprs, off, node, &cut);\n"
+				  "\teprs->recognize = recog;\n")),
+		  1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (rules_rule_item(eprs, off, node)) {\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\teprs_set_span(eprs, node, cur, *off - cur);\n")), 2);
+	EXPECT_EQ(egen_count(buf,
+			     STRV("static int rules_rule_none(eprs_t *eprs, uint *off, eprs_node_t node)\n"
+				  "{\n"
+				  "\t(void)eprs;\n"
+				  "\t(void)off;\n"
+				  "\t(void)node;\n"
+				  "\treturn 1;\n"
+				  "}\n")),
+		  1);
+	mem_free(buf, 8192);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(egen_c_optimize)
+{
+	START;
+
+	estx_t estx = {0};
+	cfg_prs_estx(&estx, ALLOC_STD);
+	EXPECT_EQ(estx_optimize(&estx), 0);
+
+	estx_node_t file;
+	estx_find_rule(&estx, STRV("file"), &file);
+
+	char *buf = mem_alloc(65536);
+	mem_oom(1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(egen_c(&estx, file, STRV("cfg"), DST_BUFN(buf, 65536)), 0);
+	log_set_quiet(0, 0);
+	mem_oom(0);
+	EXPECT_EQ(egen_c(&estx, file, STRV("cfg"), DST_BUFN(buf, 65536)) > 0, 1);
+	EXPECT_EQ(egen_dups(buf), 0);
+	EXPECT_EQ(egen_count(buf, STRV("static int cfg_rule_file(eprs_t *eprs, uint *off, eprs_node_t node)\n{")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("static int cfg_rule_str(eprs_t *eprs, uint *off, eprs_node_t node)\n{")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("cfg_rule_cfg(")), 0);
+	EXPECT_EQ(egen_count(buf, STRV("cfg_rule_c(")), 0);
+	mem_free(buf, 65536);
+
+	estx_free(&estx);
+
+	END;
+}
+
+static uint egen_hash(strv_t str)
+{
+	uint hash = 2166136261u;
+	for (size_t i = 0; i < str.len; i++) {
+		hash = (hash ^ (byte)str.data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+// The parser in t_egen_cfg.h is generated with tools/cfg_gen.c and has to build the same trees as eprs_parse
+TEST(egen_c_cfg)
+{
+	START;
+
+	estx_t estx = {0};
+	cfg_prs_estx(&estx, ALLOC_STD);
+	estx_optimize(&estx);
+
+	estx_node_t file;
+	estx_find_rule(&estx, STRV("file"), &file);
+
+	// Fails when the grammar changed without regenerating t_egen_cfg.h
+	char *code = mem_alloc(65536);
+	size_t len = egen_c(&estx, file, STRV("cfgg"), DST_BUFN(code, 65536));
+	EXPECT_EQ(egen_hash(STRVN(code, len)), CFGG_HASH);
+	mem_free(code, 65536);
+
+	lex_t lex = {0};
+	lex_init(&lex, 1, 64, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 64, ALLOC_STD);
+	eprs_t gen = {0};
+	eprs_init(&gen, 64, ALLOC_STD);
+
+	strv_t strs[] = {
+		STRV(""),
+		STRV("int = 1\n"
+		     "str = \"a b\"\n"
+		     "lit = a:b\n"),
+		STRV("arr = [1, \"a\", [2]]\n"
+		     "obj = {a = 1, b += c}\n"),
+		STRV("a += 1\n"
+		     "b -= 2\n"
+		     "c ?= 3\n"),
+		STRV("arr:\n"
+		     "1\n"
+		     "\"a\"\n"
+		     "\n"),
+		STRV("\"str\"\n"
+		     "[tbl]\n"
+		     "int = 1\n"
+		     "\n"
+		     "[+tbl:name=tbl1]\n"
+		     "a = b\n"),
+		STRV("int = \n"),
+		STRV("[tbl\n"),
+	};
+
+	char exp[2048] = {0};
+	char buf[2048] = {0};
+	for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+		lex_tokenize(&lex, strs[i], STRV(__FILE__), __LINE__);
+
+		eprs_node_t root, gen_root;
+		int ret = eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE());
+		EXPECT_EQ(cfgg_parse(&gen, &lex, &gen_root), ret);
+		if (ret == 0) {
+			eprs_print(&eprs, root, DST_BUF(exp));
+			eprs_print(&gen, gen_root, DST_BUF(buf));
+			EXPECT_STR(buf, exp);
+		}
+	}
+
+	EXPECT_EQ(cfgg_parse(NULL, &lex, NULL), 1);
+	EXPECT_EQ(cfgg_parse(&gen, NULL, NULL), 1);
+
+	eprs_free(&gen);
+	eprs_free(&eprs);
+	lex_free(&lex);
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(egen_c_list)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 4, ALLOC_STD);
+
+	estx_node_t nums, keep, elem, sep, term;
+	estx_rule(&estx, STRV("nums"), &nums);
+	estx_rule(&estx, STRV("keep"), &keep);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_REP, &elem);
+	estx_term_lit(&estx, STRV(","), ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 2, 0, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, nums, term);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &elem);
+	estx_term_lit(&estx, STRV(","), ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 0, 1, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, keep, term);
+
+	char *buf = mem_alloc(8192);
+	EXPECT_EQ(egen_c(&estx, nums, STRV("nums"), DST_BUFN(buf, 8192)) > 0, 1);
+	EXPECT_EQ(egen_dups(buf), 0);
+	EXPECT_EQ(egen_count(buf, STRV("\tuint cnt       = 0;\n")), 1);
+	EXPECT_EQ(egen_count(buf,
+			     STRV("\t\t\teprs->recognize = 1;\n"
+				  "\t\t\tret             = nums_term_3(eprs, off, node, &attempt);\n")),
+		  1);
+	EXPECT_EQ(egen_count(buf, STRV("\t\t\tret = nums_occ_2(eprs, off, node, &attempt);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (cnt < 2) {\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("keep_")), 0);
+	EXPECT_EQ(egen_c(&estx, keep, STRV("keep"), DST_BUFN(buf, 8192)) > 0, 1);
+	EXPECT_EQ(egen_count(buf, STRV("\t\t\tret = keep_term_6(eprs, off, node, &attempt);\n")), 1);
+	EXPECT_EQ(egen_count(buf, STRV("\tif (cnt < ")), 0);
+	EXPECT_EQ(egen_count(buf, STRV("nums_")), 0);
+	mem_free(buf, 8192);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(egen_estx)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 2, ALLOC_STD);
+
+	estx_node_t rule, term;
+	estx_rule(&estx, STRV("a"), &rule);
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, rule, term);
+
+	char buf[512] = {0};
+	EXPECT_EQ(egen_estx(NULL, STRV("tbl"), ALLOC_STD, DST_BUF(buf)), 0);
+	mem_oom(1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(egen_estx(&estx, STRV("tbl"), ALLOC_STD, DST_BUF(buf)), 0);
+	log_set_quiet(0, 0);
+	mem_oom(0);
+	EXPECT_EQ(egen_estx(&estx, STRV("tbl"), ALLOC_STD, DST_BUF(buf)), 394);
+	EXPECT_STR(buf,
+		   "static const unsigned char tbl[58] = {\n"
+		   "\t0x45, 0x53, 0x54, 0x58, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,\n"
+		   "\t0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x61, 0x04, 0x00, 0x00,\n"
+		   "\t0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x61, 0x01, 0x00,\n"
+		   "\t0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,\n"
+		   "};\n");
+
+	estx_free(&estx);
+
+	END;
+}
+
+STEST(egen)
+{
+	SSTART;
+
+	RUN(egen_c_invalid);
+	RUN(egen_c);
+	RUN(egen_c_rules);
+	RUN(egen_c_optimize);
+	RUN(egen_c_cfg);
+	RUN(egen_c_list);
+	RUN(egen_estx);
+
+	SEND;
+}
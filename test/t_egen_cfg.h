@@ -0,0 +1,1923 @@
+#ifndef T_EGEN_CFG_H
+#define T_EGEN_CFG_H
+
+// Generated with tools/cfg_gen.c from cfg_prs_estx, do not edit
+#include "eprs.h"
+
+static inline int cfgg_chr(const lex_t *lex, uint off, char c)
+{
+	tok_t tok = lex_get_tok(lex, off);
+	if (tok.type & (1 << TOK_EOF)) {
+		return 1;
+	}
+
+	strv_t val = lex_get_tok_val(lex, tok);
+	return val.len != 1 || val.data[0] != c;
+}
+
+static inline int cfgg_set(const lex_t *lex, uint off, const byte *set)
+{
+	tok_t tok = lex_get_tok(lex, off);
+	if (tok.type & (1 << TOK_EOF)) {
+		return 1;
+	}
+
+	strv_t val = lex_get_tok_val(lex, tok);
+	if (val.len != 1) {
+		return 1;
+	}
+
+	byte c = (byte)val.data[0];
+	return !(set[c >> 3] >> (c & 7) & 1);
+}
+
+static inline int cfgg_tok(eprs_t *eprs, uint *off, eprs_node_t node, tok_type_t type)
+{
+	tok_t tok = lex_get_tok(eprs->lex, *off);
+	if (!(tok.type & (1 << type))) {
+		return 1;
+	}
+
+	eprs_node_t child;
+	eprs_node_tok(eprs, (tok_t){.type = type, .start = tok.start, .len = tok.len}, &child);
+	eprs_add_node(eprs, node, child);
+	*off += tok.len;
+	return 0;
+}
+
+static inline int cfgg_lit(eprs_t *eprs, uint *off, eprs_node_t node, uint len)
+{
+	eprs_node_t child;
+	eprs_node_lit(eprs, *off, len, &child);
+	eprs_add_node(eprs, node, child);
+	*off += len;
+	return 0;
+}
+
+static int cfgg_rule_file(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_tv(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_tbl(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_kv(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_key(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_vals(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_val(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_int(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_str(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_lit(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_arr(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_obj(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_mode(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_name(eprs_t *eprs, uint *off, eprs_node_t node);
+static int cfgg_rule_ent(eprs_t *eprs, uint *off, eprs_node_t node);
+
+static int cfgg_term_106(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 5, &child) || cfgg_rule_tv(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_107(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_105(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_106(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_107(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_occ_105(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_105(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_105(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_108(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 10, &child) || cfgg_rule_tbl(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_occ_108(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_108(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 0;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_108(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_110(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_111(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 10, &child) || cfgg_rule_tbl(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_109(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_110(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_111(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_occ_109(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_109(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_109(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_104(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_occ_105(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_108(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_109(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_2(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_104(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_3(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_EOF);
+}
+
+static int cfgg_term_4(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_2(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_3(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_file(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_4(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_18(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 17, &child) || cfgg_rule_kv(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_96(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 19, &child) || cfgg_rule_key(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_97(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ':')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_98(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_99(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 23, &child) || cfgg_rule_vals(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_occ_99(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_99(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 0;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_99(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_100(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_27(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_96(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_97(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_98(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_99(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_100(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_29(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 28, &child) || cfgg_rule_val(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_30(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int alt;
+
+	alt = 0;
+	if (cfgg_term_18(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_27(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_29(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+
+	return 1;
+}
+
+static int cfgg_rule_tv(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_30(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_79(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '[')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_81(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 80, &child) || cfgg_rule_name(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_82(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ']')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_83(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_85(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 84, &child) || cfgg_rule_ent(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_86(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_79(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_81(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_82(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_83(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_85(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_tbl(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_86(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_67(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 19, &child) || cfgg_rule_key(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_68(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ' ')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_70(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 69, &child) || cfgg_rule_mode(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_occ_70(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_70(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 0;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_70(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_71(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '=') ||
+	    cfgg_chr(eprs->lex, *off + 1, ' ')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 2);
+}
+
+static int cfgg_term_72(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 28, &child) || cfgg_rule_val(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_73(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_67(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_68(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_70(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_71(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_72(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_kv(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_73(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_34(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00,
+		0xfe, 0xff, 0xff, 0x07, 0xfe, 0xff, 0xff, 0x07,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_occ_34(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_34(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_34(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_rule_key(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur  = *off;
+	int cut   = 0;
+	int recog = eprs->recognize;
+
+	eprs->recognize = 1;
+	int ret		= cfgg_occ_34(eprs, off, node, &cut);
+	eprs->recognize = recog;
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_31(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 28, &child) || cfgg_rule_val(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_32(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_33(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	uint cnt       = 0;
+
+	for (;;) {
+		uint at     = *off;
+		uint at_cnt = eprs->nodes.cnt;
+		int attempt = 0;
+		int ret     = 0;
+
+		if (cnt > 0) {
+			int recog       = eprs->recognize;
+			eprs->recognize = 1;
+			ret             = cfgg_term_32(eprs, off, node, &attempt);
+			eprs->recognize = recog;
+		}
+		if (ret == 0) {
+			ret = cfgg_term_31(eprs, off, node, &attempt);
+		}
+
+		if (ret) {
+			eprs_reset(eprs, at_cnt);
+			*off = at;
+			if (attempt) {
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			}
+			break;
+		}
+
+		if (cnt++ > 0 && *off == at) {
+			break;
+		}
+	}
+
+	if (cnt < 1) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_vals(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_33(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_36(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 35, &child) || cfgg_rule_int(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_37(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '"')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_39(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 38, &child) || cfgg_rule_str(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_40(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '"')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_41(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_37(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_39(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_40(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_43(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 42, &child) || cfgg_rule_lit(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_44(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '[')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_46(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 45, &child) || cfgg_rule_arr(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_occ_46(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_46(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 0;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_46(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_47(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ']')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_48(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_44(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_46(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_47(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_49(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '{')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_51(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 50, &child) || cfgg_rule_obj(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_occ_51(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_51(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 0;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_51(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_52(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, '}')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_53(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_49(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_51(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_52(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_term_54(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int alt;
+
+	alt = 0;
+	if (cfgg_term_36(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_41(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_43(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_48(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+	if (alt) {
+		return 1;
+	}
+
+	alt = 0;
+	if (cfgg_term_53(eprs, off, node, &alt) == 0) {
+		return 0;
+	}
+	eprs_reset(eprs, nodes_cnt);
+	*off = cur;
+
+	return 1;
+}
+
+static int cfgg_rule_val(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_54(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_55(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_DIGIT);
+}
+
+static int cfgg_occ_55(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_55(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_55(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_rule_int(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur  = *off;
+	int cut   = 0;
+	int recog = eprs->recognize;
+
+	eprs->recognize = 1;
+	int ret		= cfgg_occ_55(eprs, off, node, &cut);
+	eprs->recognize = recog;
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_112(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0xfb, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_57(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_112(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_occ_57(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_57(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_57(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_rule_str(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur  = *off;
+	int cut   = 0;
+	int recog = eprs->recognize;
+
+	eprs->recognize = 1;
+	int ret		= cfgg_occ_57(eprs, off, node, &cut);
+	eprs->recognize = recog;
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_58(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x03,
+		0xfe, 0xff, 0xff, 0x87, 0xfe, 0xff, 0xff, 0x07,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_term_59(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x07,
+		0xfe, 0xff, 0xff, 0x87, 0xfe, 0xff, 0xff, 0x07,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_occ_59(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_59(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_59(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_term_60(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_58(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_occ_59(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_lit(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur  = *off;
+	int cut   = 0;
+	int recog = eprs->recognize;
+
+	eprs->recognize = 1;
+	int ret		= cfgg_term_60(eprs, off, node, &cut);
+	eprs->recognize = recog;
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_61(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 28, &child) || cfgg_rule_val(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_62(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ',') ||
+	    cfgg_chr(eprs->lex, *off + 1, ' ')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 2);
+}
+
+static int cfgg_term_63(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	uint cnt       = 0;
+
+	for (;;) {
+		uint at     = *off;
+		uint at_cnt = eprs->nodes.cnt;
+		int attempt = 0;
+		int ret     = 0;
+
+		if (cnt > 0) {
+			int recog       = eprs->recognize;
+			eprs->recognize = 1;
+			ret             = cfgg_term_62(eprs, off, node, &attempt);
+			eprs->recognize = recog;
+		}
+		if (ret == 0) {
+			ret = cfgg_term_61(eprs, off, node, &attempt);
+		}
+
+		if (ret) {
+			eprs_reset(eprs, at_cnt);
+			*off = at;
+			if (attempt) {
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			}
+			break;
+		}
+
+		if (cnt++ > 0 && *off == at) {
+			break;
+		}
+	}
+
+	if (cnt < 1) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_arr(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_63(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_64(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 17, &child) || cfgg_rule_kv(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_65(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	if (cfgg_chr(eprs->lex, *off, ',') ||
+	    cfgg_chr(eprs->lex, *off + 1, ' ')) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 2);
+}
+
+static int cfgg_term_66(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	uint cnt       = 0;
+
+	for (;;) {
+		uint at     = *off;
+		uint at_cnt = eprs->nodes.cnt;
+		int attempt = 0;
+		int ret     = 0;
+
+		if (cnt > 0) {
+			int recog       = eprs->recognize;
+			eprs->recognize = 1;
+			ret             = cfgg_term_65(eprs, off, node, &attempt);
+			eprs->recognize = recog;
+		}
+		if (ret == 0) {
+			ret = cfgg_term_64(eprs, off, node, &attempt);
+		}
+
+		if (ret) {
+			eprs_reset(eprs, at_cnt);
+			*off = at;
+			if (attempt) {
+				eprs_reset(eprs, nodes_cnt);
+				*off = cur;
+				return 1;
+			}
+			break;
+		}
+
+		if (cnt++ > 0 && *off == at) {
+			break;
+		}
+	}
+
+	if (cnt < 1) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_rule_obj(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_66(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_77(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x28, 0x00, 0x80,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_rule_mode(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_term_77(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_87(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	static const byte set[32] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x68, 0xff, 0xa7,
+		0xfe, 0xff, 0xff, 0x87, 0xfe, 0xff, 0xff, 0x07,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	if (cfgg_set(eprs->lex, *off, set)) {
+		return 1;
+	}
+
+	return cfgg_lit(eprs, off, node, 1);
+}
+
+static int cfgg_occ_87(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_87(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_87(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_rule_name(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur  = *off;
+	int cut   = 0;
+	int recog = eprs->recognize;
+
+	eprs->recognize = 1;
+	int ret		= cfgg_occ_87(eprs, off, node, &cut);
+	eprs->recognize = recog;
+
+	if (ret) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+static int cfgg_term_102(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint nodes_cnt = eprs->nodes.cnt;
+	eprs_node_t child;
+	if (eprs_node_rule(eprs, 5, &child) || cfgg_rule_tv(eprs, off, child)) {
+		eprs_reset(eprs, nodes_cnt);
+		return 1;
+	}
+
+	eprs_add_node(eprs, node, child);
+	return 0;
+}
+
+static int cfgg_term_103(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	return cfgg_tok(eprs, off, node, TOK_NL);
+}
+
+static int cfgg_term_91(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+
+	if (cfgg_term_102(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	if (cfgg_term_103(eprs, off, node, cut)) {
+		eprs_reset(eprs, nodes_cnt);
+		*off = cur;
+		return 1;
+	}
+
+	return 0;
+}
+
+static int cfgg_occ_91(eprs_t *eprs, uint *off, eprs_node_t node, int *cut)
+{
+	(void)cut;
+	uint cur       = *off;
+	uint nodes_cnt = eprs->nodes.cnt;
+	int attempt    = 0;
+
+	int ret = cfgg_term_91(eprs, off, node, &attempt);
+	if (ret && attempt) {
+		*off = cur;
+		return 1;
+	}
+
+	while (ret == 0) {
+		if (cur == *off) {
+			break;
+		}
+		cur     = *off;
+		attempt = 0;
+		ret     = cfgg_term_91(eprs, off, node, &attempt);
+		if (ret && attempt) {
+			eprs_reset(eprs, nodes_cnt);
+			return 1;
+		}
+	}
+
+	*off = cur;
+	return 0;
+}
+
+static int cfgg_rule_ent(eprs_t *eprs, uint *off, eprs_node_t node)
+{
+	uint cur = *off;
+	int cut  = 0;
+
+	if (cfgg_occ_91(eprs, off, node, &cut)) {
+		*off = cur;
+		return 1;
+	}
+
+	eprs_set_span(eprs, node, cur, *off - cur);
+	return 0;
+}
+
+int cfgg_parse(eprs_t *eprs, const lex_t *lex, eprs_node_t *root)
+{
+	if (eprs == NULL || lex == NULL) {
+		return 1;
+	}
+
+	eprs->lex = lex;
+	eprs_reset(eprs, 0);
+
+	uint off = 0;
+	eprs_node_t node;
+	if (eprs_node_rule(eprs, 0, &node) || cfgg_rule_file(eprs, &off, node) || off != lex->toks.cnt) {
+		return 1;
+	}
+
+	if (root) {
+		*root = node;
+	}
+
+	return 0;
+}
+
+#define CFGG_HASH 0x1d3de97bu
+
+#endif
@@ -198,6 +198,57 @@ TEST(eprs_get_rule)
 	END;
 }
 
+TEST(eprs_get_node_rule)
+{
+	START;
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 2, ALLOC_STD);
+
+	eprs_node_t lit, rule;
+	eprs_node_lit(&eprs, 0, 0, &lit);
+	eprs_node_rule(&eprs, 3, &rule);
+
+	estx_node_t id = 0;
+
+	EXPECT_EQ(eprs_get_node_rule(NULL, rule, NULL), 1);
+	EXPECT_EQ(eprs_get_node_rule(&eprs, eprs.nodes.cnt, NULL), 1);
+	EXPECT_EQ(eprs_get_node_rule(&eprs, lit, &id), 1);
+	EXPECT_EQ(eprs_get_node_rule(&eprs, rule, NULL), 0);
+	EXPECT_EQ(eprs_get_node_rule(&eprs, rule, &id), 0);
+	EXPECT_EQ(id, 3);
+
+	eprs_free(&eprs);
+
+	END;
+}
+
+TEST(eprs_set_span)
+{
+	START;
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 2, ALLOC_STD);
+
+	eprs_node_t lit, rule;
+	eprs_node_lit(&eprs, 0, 0, &lit);
+	eprs_node_rule(&eprs, 3, &rule);
+
+	EXPECT_EQ(eprs_set_span(NULL, rule, 0, 0), 1);
+	EXPECT_EQ(eprs_set_span(&eprs, eprs.nodes.cnt, 0, 0), 1);
+	EXPECT_EQ(eprs_set_span(&eprs, lit, 0, 0), 1);
+	EXPECT_EQ(eprs_set_span(&eprs, rule, 2, 3), 0);
+
+	tok_t str = {0};
+	EXPECT_EQ(eprs_get_str(&eprs, rule, &str), 0);
+	EXPECT_EQ(str.start, 2);
+	EXPECT_EQ(str.len, 3);
+
+	eprs_free(&eprs);
+
+	END;
+}
+
 TEST(eprs_get_str)
 {
 	START;
@@ -226,6 +277,7 @@ TEST(eprs_get_str)
 	str.len = 0;
 	log_set_quiet(0, 1);
 	EXPECT_EQ(eprs_get_str(&eprs, root, &str), 0);
+	EXPECT_EQ(eprs_get_str(&eprs, node, &str), 1);
 	log_set_quiet(0, 0);
 
 	EXPECT_EQ(str.start, 0);
@@ -697,6 +749,112 @@ TEST(eprs_parse_group_failed)
 	END;
 }
 
+TEST(eprs_parse_set)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("a_=x");
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), __LINE__ - 2);
+
+	estx_t estx = {0};
+	estx_init(&estx, 4, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 4, ALLOC_STD);
+
+	tok_set_t name = {0};
+	tok_set_add(&name, 'a', 'z');
+	tok_set_add(&name, '_', '_');
+	tok_set_t digit = {0};
+	tok_set_add(&digit, '0', '9');
+
+	estx_node_t rule;
+	estx_rule(&estx, STRV("rule"), &rule);
+	estx_node_t terms, term;
+	estx_term_set(&estx, &name, ESTX_TERM_OCC_REP, &terms);
+	estx_term_lit(&estx, STRV("="), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_set(&estx, &digit, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, rule, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, NULL, DST_BUF(buf)), 1);
+	EXPECT_STR(buf + sizeof(__FILE__ ":000:0: ") - 1,
+		   "error: in rule 'rule': expected [0-9], got 'x'\n"
+		   "a_=x\n"
+		   "   ^\n");
+
+	lex_free(&lex);
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, STRV("a_=1"), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 42);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─'a'\n"
+		   "├─'_'\n"
+		   "├─'='\n"
+		   "└─'1'\n");
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
+TEST(eprs_parse_group_reset)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("aba");
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), __LINE__ - 2);
+
+	estx_t estx = {0};
+	estx_init(&estx, 4, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 4, ALLOC_STD);
+
+	estx_node_t rule;
+	estx_rule(&estx, STRV("rule"), &rule);
+	estx_node_t terms, term;
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_node_t group;
+	estx_term_group(&estx, terms, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &group);
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, group, term);
+	estx_term_con(&estx, group, &term);
+	estx_add_term(&estx, rule, term);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, &root, DST_NONE()), 0);
+
+	char buf[64] = {0};
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 32);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─'a'\n"
+		   "├─'b'\n"
+		   "└─'a'\n");
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
 TEST(eprs_parse_group)
 {
 	START;
@@ -870,6 +1028,80 @@ TEST(eprs_parse_rep)
 	END;
 }
 
+TEST(eprs_parse_list)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("1, 2, x");
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), __LINE__ - 2);
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 8, ALLOC_STD);
+
+	estx_node_t rule, item, elem, sep, list, term;
+	estx_rule(&estx, STRV("rule"), &rule);
+	estx_rule(&estx, STRV("item"), &item);
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &elem);
+	estx_term_lit(&estx, STRV(", "), ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 2, 0, ESTX_TERM_OCC_ONE, &list);
+	estx_add_term(&estx, rule, list);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, item, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, NULL, DST_BUF(buf)), 1);
+	EXPECT_STR(buf + sizeof(__FILE__ ":0000:0: ") - 1,
+		   "error: in rule 'item': expected DIGIT, got 'x'\n"
+		   "1, 2, x\n"
+		   "      ^\n");
+
+	lex_free(&lex);
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, STRV("1"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, NULL, DST_NONE()), 1);
+
+	lex_free(&lex);
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, STRV("1, 2, 3"), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 81);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "│ └─DIGIT(1)\n"
+		   "├─1\n"
+		   "│ └─DIGIT(2)\n"
+		   "└─1\n"
+		   "  └─DIGIT(3)\n");
+
+	estx_get_node(&estx, list)->val.list.keep = 1;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, rule, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 103);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "│ └─DIGIT(1)\n"
+		   "├─', '\n"
+		   "├─1\n"
+		   "│ └─DIGIT(2)\n"
+		   "├─', '\n"
+		   "└─1\n"
+		   "  └─DIGIT(3)\n");
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
 TEST(eprs_parse_name)
 {
 	START;
@@ -913,6 +1145,11 @@ TEST(eprs_parse_name)
 		   "└─2\n"
 		   "  └─'b'\n");
 
+	tok_t str = {0};
+	EXPECT_EQ(eprs_get_str(&eprs, root, &str), 0);
+	EXPECT_EQ(str.start, 0);
+	EXPECT_EQ(str.len, 1);
+
 	eprs_free(&eprs);
 	lex_free(&lex);
 	estx_free(&estx);
@@ -1130,6 +1367,1222 @@ TEST(eprs_parse_ebnf)
 	END;
 }
 
+TEST(eprs_parse_errs)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("a\n"
+			  "b\n"
+			  "a\n"
+			  "c\n");
+	lex_init(&lex, 0, 8, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), 0);
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 8, ALLOC_STD);
+
+	estx_node_t file, line;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("line"), &line);
+
+	estx_node_t terms, term;
+	estx_term_rule(&estx, line, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_NL, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, line, term);
+
+	eprs_err_t errs[4] = {0};
+	uint errs_cnt	   = 0;
+
+	EXPECT_EQ(eprs_parse_errs(NULL, NULL, NULL, 0, NULL, 0, &errs_cnt, DST_NONE()), 1);
+	EXPECT_EQ(eprs_parse_errs(&eprs, &lex, &estx, file, errs, 1, &errs_cnt, DST_NONE()), 1);
+	EXPECT_EQ(errs_cnt, 1);
+	EXPECT_EQ(errs[0].tok, 2);
+
+	EXPECT_EQ(eprs_parse_errs(&eprs, &lex, &estx, file, errs, 4, &errs_cnt, DST_NONE()), 1);
+	EXPECT_EQ(errs_cnt, 2);
+	EXPECT_EQ(errs[0].rule, file);
+	EXPECT_EQ(errs[0].tok, 2);
+	EXPECT_EQ(errs[1].rule, file);
+	EXPECT_EQ(errs[1].tok, 6);
+	EXPECT_PTR(eprs.lex, &lex);
+
+	char buf[256] = {0};
+	EXPECT_EQ(eprs_print_err(NULL, errs[0], DST_BUF(buf)), 0);
+	eprs_print_err(&eprs, errs[1], DST_BUF(buf));
+	EXPECT_STR(buf,
+		   __FILE__ ":3:0: error: in rule 'file': expected EOF, got 'c'\n"
+		   "c\n"
+		   "^\n");
+
+	lex_tokenize(&lex, STRV("a\n"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse_errs(&eprs, &lex, &estx, file, errs, 4, &errs_cnt, DST_NONE()), 0);
+	EXPECT_EQ(errs_cnt, 0);
+
+	lex_add_word(&lex, STRV("bb"), NULL);
+	lex_tokenize(&lex,
+		     STRV("a\n"
+			  "bb\n"
+			  "a\n"
+			  "c\n"),
+		     STRV(__FILE__),
+		     0);
+	EXPECT_EQ(eprs_parse_errs(&eprs, &lex, &estx, file, errs, 4, &errs_cnt, DST_NONE()), 1);
+	EXPECT_EQ(errs_cnt, 2);
+	EXPECT_EQ(errs[0].tok, 2);
+	EXPECT_EQ(errs[1].tok, 6);
+	eprs_print_err(&eprs, errs[1], DST_BUF(buf));
+	EXPECT_STR(buf,
+		   __FILE__ ":3:0: error: in rule 'file': expected EOF, got 'c'\n"
+		   "c\n"
+		   "^\n");
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
+TEST(eprs_reparse)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 16, ALLOC_STD);
+	lex_tokenize(&lex, STRV("ab\ncd\nef\n"), STRV(__FILE__), 0);
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 16, ALLOC_STD);
+
+	eprs_t full = {0};
+	eprs_init(&full, 16, ALLOC_STD);
+
+	estx_node_t file, line;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("line"), &line);
+
+	estx_node_t terms, term;
+	estx_term_rule(&estx, line, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_tok(&estx, TOK_ALPHA, ESTX_TERM_OCC_REP, &terms);
+	estx_term_tok(&estx, TOK_NL, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, line, term);
+
+	eprs_node_t root;
+	char exp[1024] = {0};
+	char act[1024] = {0};
+
+	EXPECT_EQ(eprs_reparse(NULL, &lex, file, (eprs_edit_t){0}, &root, DST_NONE()), 1);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){0}, &root, DST_NONE()), 1);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+
+	lex_tokenize(&lex, STRV("ab\nxyz\nef\n"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){.start = 3, .old_len = 2, .new_len = 3}, &root, DST_NONE()), 0);
+	eprs_print(&eprs, root, DST_BUF(act));
+	EXPECT_EQ(eprs_parse(&full, &lex, &estx, file, &root, DST_NONE()), 0);
+	eprs_print(&full, root, DST_BUF(exp));
+	EXPECT_STR(act, exp);
+
+	eprs_node_t child, last = root;
+	void *data;
+	eprs_node_foreach(&eprs.nodes, root, child, data)
+	{
+		if (eprs_get_rule(&eprs, child, line, NULL) == 0) {
+			last = child;
+		}
+	}
+
+	tok_t str = {0};
+	eprs_get_str(&eprs, last, &str);
+	EXPECT_EQ(str.start, 7);
+	EXPECT_EQ(str.len, 3);
+
+	lex_tokenize(&lex, STRV("ab\nx1z\nef\n"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){.start = 4, .old_len = 1, .new_len = 1}, &root, DST_NONE()), 1);
+
+	lex_tokenize(&lex, STRV("ab\nxyz\nef\n"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){.start = 4, .old_len = 1, .new_len = 1}, &root, DST_NONE()), 0);
+
+	lex_tokenize(&lex, STRV("a1\nxyz\nef\n"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){.start = 0, .old_len = 0, .new_len = 0}, &root, DST_NONE()), 0);
+
+	eprs_free(&full);
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
+TEST(eprs_parse_expr)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 16, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 32, ALLOC_STD);
+
+	estx_node_t file, expr, num;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("expr"), &expr);
+	estx_rule(&estx, STRV("num"), &num);
+
+	estx_node_t terms, term, ops, op, sub;
+	estx_term_rule(&estx, expr, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &ops);
+	estx_op(&estx, STRV("-"), ESTX_OP_LEFT, 1, &sub);
+	estx_add_term(&estx, ops, sub);
+	estx_op(&estx, STRV("*"), ESTX_OP_LEFT, 2, &op);
+	estx_add_term(&estx, ops, op);
+	estx_op(&estx, STRV("^"), ESTX_OP_RIGHT, 3, &op);
+	estx_add_term(&estx, ops, op);
+	estx_op(&estx, STRV("-"), ESTX_OP_PREFIX, 4, &op);
+	estx_add_term(&estx, ops, op);
+	estx_term_expr(&estx, num, ops, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, expr, term);
+
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, num, term);
+
+	lex_tokenize(&lex, STRV("1+2*-3^4^5-6"), STRV(__FILE__), 0);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+
+	char buf[512] = {0};
+	eprs_print(&eprs, root, DST_BUF(buf));
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(1)\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(2)\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(3)\n"
+		   "│ ├─op(-)\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(4)\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(5)\n"
+		   "│ ├─op(^)\n"
+		   "│ ├─op(^)\n"
+		   "│ ├─op(*)\n"
+		   "│ ├─op(+)\n"
+		   "│ ├─2\n"
+		   "│ │ └─DIGIT(6)\n"
+		   "│ └─op(-)\n"
+		   "└─EOF()\n");
+
+	eprs_node_t node, child, last = root;
+	void *data;
+	eprs_get_rule(&eprs, root, expr, &node);
+	eprs_node_foreach(&eprs.nodes, node, child, data)
+	{
+		if (eprs_get_op(&eprs, child, NULL) == 0 && last == root) {
+			last = child;
+		}
+	}
+
+	estx_node_t got;
+	EXPECT_EQ(eprs_get_op(NULL, last, &got), 1);
+	EXPECT_EQ(eprs_get_op(&eprs, root, &got), 1);
+	EXPECT_EQ(eprs_get_op(&eprs, last, &got), 0);
+	EXPECT_EQ(got, op);
+
+	tok_t str = {0};
+	EXPECT_EQ(eprs_get_str(&eprs, last, &str), 0);
+	EXPECT_EQ(str.start, 4);
+	EXPECT_EQ(str.len, 1);
+
+	lex_tokenize(&lex, STRV("1+"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 1);
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
+TEST(eprs_reparse_expr)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 16, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 32, ALLOC_STD);
+
+	estx_node_t file, expr, num;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("expr"), &expr);
+	estx_rule(&estx, STRV("num"), &num);
+
+	estx_node_t terms, term, ops, op;
+	estx_term_rule(&estx, expr, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &ops);
+	estx_op(&estx, STRV("*"), ESTX_OP_LEFT, 2, &op);
+	estx_add_term(&estx, ops, op);
+	estx_term_expr(&estx, num, ops, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, expr, term);
+
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, num, term);
+
+	lex_tokenize(&lex, STRV("1+2*3+4*5+6"), STRV(__FILE__), 0);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+
+	// Operands before the edit are reused without looking at their tokens again, the operator nodes added after them do not hide them
+	lex_tokenize(&lex, STRV("1+2*a+b*5+7"), STRV(__FILE__), 0);
+	EXPECT_EQ(eprs_reparse(&eprs, &lex, file, (eprs_edit_t){.start = 10, .old_len = 1, .new_len = 1}, &root, DST_NONE()), 0);
+
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
+static void eprs_split_run(eprs_piece_t *pieces, uint cnt, void *priv)
+{
+	uint *runs = priv;
+	for (uint i = cnt; i > 0; i--) {
+		eprs_parse_piece(&pieces[i - 1]);
+	}
+	(*runs)++;
+}
+
+static int eprs_event_print(const eprs_t *eprs, eprs_event_t event, void *priv)
+{
+	dst_t *dst = priv;
+	switch (event.type) {
+	case EPRS_EVENT_ENTER: {
+		strv_t name = strvbuf_get(&eprs->estx->strs, estx_get_node(eprs->estx, event.id)->val.name);
+		dst->off += dputf(*dst, "<%.*s ", name.len, name.data);
+		break;
+	}
+	case EPRS_EVENT_EXIT: dst->off += dputs(*dst, STRV(">")); break;
+	default: dst->off += dputs(*dst, lex_get_tok_val(eprs->lex, event.tok)); break;
+	}
+	return dst->off > 100;
+}
+
+TEST(eprs_recognize)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (item ';')* EOF\n"
+				   "item = key '=' val | key ':' val\n"
+				   "key  = LOWER+\n"
+				   "val  = DIGIT+\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	EXPECT_EQ(eprs_recognize(NULL, &lex, &estx, file, DST_NONE()), 1);
+
+	lex_tokenize(&lex, STRV("a=1;bc:2;"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_recognize(&eprs, &lex, &estx, file, DST_NONE()), 0);
+	EXPECT_EQ(eprs.nodes.cnt, 0);
+	EXPECT_EQ(eprs.memo_hits, 2);
+	EXPECT_EQ(eprs.recognize, 0);
+
+	char buf[128] = {0};
+	lex_tokenize(&lex, STRV("a=1;b"), STRV("t.txt"), 0);
+	EXPECT_EQ(eprs_recognize(&eprs, &lex, &estx, file, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:5: error: in rule 'item': expected ':', got ''\n"
+		   "a=1;b\n"
+		   "     ^\n");
+	EXPECT_EQ(eprs.nodes.cnt, 0);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_two_phase)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (item ';')* (item '.')? EOF\n"
+				   "item = key '=' val | key ':' val | key\n"
+				   "key  = LOWER+\n"
+				   "val  = DIGIT+\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	EXPECT_EQ(eprs_parse_two_phase(NULL, &lex, &estx, file, NULL, DST_NONE()), 1);
+
+	lex_tokenize(&lex, STRV("a=1;bc:2;d;e."), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	char exp[1024] = {0};
+	char buf[1024] = {0};
+
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	size_t len = eprs_print(&eprs, root, DST_BUF(exp));
+
+	EXPECT_EQ(eprs_parse_two_phase(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs.guided, 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), len);
+	EXPECT_STR(buf, exp);
+
+	lex_tokenize(&lex, STRV("a=1;b"), STRV("t.txt"), 0);
+	EXPECT_EQ(eprs_parse_two_phase(&eprs, &lex, &estx, file, &root, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:5: error: in rule 'file': expected '.', got ''\n"
+		   "a=1;b\n"
+		   "     ^\n");
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_chr_rep)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = key ':' DIGIT* 'x'? (' ' | '-')+ EOF\n"
+				   "key  = (ALPHA | '.')+\n"
+				   "eof  = (LOWER | EOF)*\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("a.b:12x -"), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	char buf[1024] = {0};
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 144);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "│ ├─ALPHA(a)\n"
+		   "│ ├─'.'\n"
+		   "│ └─ALPHA(b)\n"
+		   "├─':'\n"
+		   "├─DIGIT(1)\n"
+		   "├─DIGIT(2)\n"
+		   "├─'x'\n"
+		   "├─' '\n"
+		   "├─'-'\n"
+		   "└─EOF()\n");
+	EXPECT_EQ(eprs.nodes.cnt, 12);
+	EXPECT_EQ(eprs.chrs_cnt, 4);
+
+	EXPECT_EQ(eprs_recognize(&eprs, &lex, &estx, file, DST_NONE()), 0);
+	EXPECT_EQ(eprs.chrs_cnt, 4);
+
+	lex_tokenize(&lex, STRV("a.b.c.d:1234567890x -  --"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs.nodes.cnt, 28);
+	EXPECT_EQ(eprs.chrs_cnt, 4);
+
+	{
+		eprs_t oom = {0};
+		eprs_init(&oom, 100, ALLOC_STD);
+
+		mem_oom(1);
+		log_set_quiet(0, 1);
+		EXPECT_EQ(eprs_parse(&oom, &lex, &estx, file, &root, DST_NONE()), 0);
+		log_set_quiet(0, 0);
+		mem_oom(0);
+		EXPECT_EQ(oom.nodes.cnt, 28);
+		EXPECT_EQ(oom.chrs_cnt, 0);
+
+		eprs_free(&oom);
+	}
+
+	estx_node_t eof;
+	estx_find_rule(&estx, STRV("eof"), &eof);
+	lex_tokenize(&lex, STRV("ab"), STRV(__FILE__), __LINE__);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, eof, &root, DST_NONE()), 0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 45);
+	EXPECT_STR(buf,
+		   "16\n"
+		   "├─LOWER(a)\n"
+		   "├─LOWER(b)\n"
+		   "└─EOF()\n");
+	EXPECT_EQ(eprs.nodes.cnt, 4);
+
+	dst_t dst = DST_BUF(buf);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, eof, eprs_event_print, &dst, DST_NONE()), 0);
+	log_set_quiet(0, 0);
+	EXPECT_STR(buf, "<eof ab>");
+
+	lex_tokenize(&lex, STRV("a.b:12y"), STRV("t.txt"), 0);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:6: error: in rule 'file': expected '-', got 'y'\n"
+		   "a.b:12y\n"
+		   "      ^\n");
+
+	lex_tokenize(&lex, STRV(":1 "), STRV("t.txt"), 0);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:0: error: in rule 'key': expected '.', got ':'\n"
+		   ":1 \n"
+		   "^\n");
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_lex)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (word ' ' | c ',')* EOF\n"
+				   "@lex word = c+\n"
+				   "c    = LOWER | '_'\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	char buf[256] = {0};
+	estx_print(&estx, DST_BUF(buf));
+	EXPECT_STR(buf,
+		   "file = (word ' ' | c ',')* EOF\n"
+		   "@lex word = c+\n"
+		   "c = LOWER | '_'\n");
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("ab a,c_ "), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 87);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "├─' '\n"
+		   "├─5\n"
+		   "│ └─LOWER(a)\n"
+		   "├─','\n"
+		   "├─1\n"
+		   "├─' '\n"
+		   "└─EOF()\n");
+
+	tok_t str = {0};
+	eprs_get_str(&eprs, 1, &str);
+	EXPECT_STRN(lex_get_tok_val(&lex, str).data, "ab", 2);
+
+	char exp[256] = {0};
+	eprs_print(&eprs, root, DST_BUF(exp));
+	EXPECT_EQ(eprs_parse_two_phase(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	eprs_print(&eprs, root, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+
+	dst_t dst = DST_BUF(buf);
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 0);
+	EXPECT_STR(buf, "<file <word > <c a>,<word > >");
+
+	estx_node_t word;
+	estx_find_rule(&estx, STRV("word"), &word);
+	lex_tokenize(&lex, STRV("ab_"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, word, &root, DST_NONE()), 0);
+	str = (tok_t){0};
+	EXPECT_EQ(eprs_get_str(&eprs, root, &str), 0);
+	EXPECT_EQ(str.start, 0);
+	EXPECT_EQ(str.len, 3);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_inline)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (pair ';' | key '!')* EOF\n"
+				   "@inline pair = key '=' key\n"
+				   "key  = LOWER\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	char buf[256] = {0};
+	estx_print(&estx, DST_BUF(buf));
+	EXPECT_STR(buf,
+		   "file = (pair ';' | key '!')* EOF\n"
+		   "@inline pair = key '=' key\n"
+		   "key = LOWER\n");
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	lex_tokenize(&lex, STRV("a=b;c!"), STRV(__FILE__), __LINE__);
+
+	eprs_node_t root;
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 125);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─5\n"
+		   "│ └─LOWER(a)\n"
+		   "├─'='\n"
+		   "├─5\n"
+		   "│ └─LOWER(b)\n"
+		   "├─';'\n"
+		   "├─5\n"
+		   "│ └─LOWER(c)\n"
+		   "├─'!'\n"
+		   "└─EOF()\n");
+
+	char exp[256] = {0};
+	eprs_print(&eprs, root, DST_BUF(exp));
+	EXPECT_EQ(eprs_parse_two_phase(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	eprs_print(&eprs, root, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+
+	dst_t dst = DST_BUF(buf);
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 0);
+	EXPECT_STR(buf, "<file <key a>=<key b>;<key c>!>");
+
+	lex_tokenize(&lex, STRV("a=b;c="), STRV("t.txt"), 0);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:6: error: in rule 'key': expected LOWER, got ''\n"
+		   "a=b;c=\n"
+		   "      ^\n");
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_analyzed)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = item* EOF\n"
+				   "item = num | word | '[' item* ']' | ' '\n"
+				   "num  = DIGIT+\n"
+				   "word = LOWER+\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	char data[512] = {0};
+	estx_t plain   = {0};
+	estx_init(&plain, 10, ALLOC_STD);
+	estx_load(&plain, data, estx_save(&estx, data, sizeof(data)));
+
+	char buf[512] = {0};
+	EXPECT_EQ(estx_analyze(&estx, file, DST_BUF(buf)), 0);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	strv_t srcs[] = {STRV("ab [1 [c]] 2"), STRV("ab [1 c"), STRV("ab ]")};
+
+	char exp[512] = {0};
+	for (uint i = 0; i < sizeof(srcs) / sizeof(strv_t); i++) {
+		lex_tokenize(&lex, srcs[i], STRV("t.txt"), 0);
+
+		eprs_node_t root;
+		int ret = eprs_parse(&eprs, &lex, &plain, file, &root, DST_BUF(exp));
+		if (ret == 0) {
+			eprs_print(&eprs, root, DST_BUF(exp));
+		}
+
+		EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_BUF(buf)), ret);
+		if (ret == 0) {
+			eprs_print(&eprs, root, DST_BUF(buf));
+		}
+		EXPECT_STR(buf, exp);
+	}
+
+	EXPECT_STR(buf,
+		   "t.txt:0:3: error: in rule 'file': expected EOF, got ']'\n"
+		   "ab ]\n"
+		   "   ^\n");
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&plain);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_events)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (item ';')* EOF\n"
+				   "item = key '=' val | key ':' val\n"
+				   "key  = LOWER+\n"
+				   "val  = DIGIT+\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	char buf[128] = {0};
+	dst_t dst     = DST_BUF(buf);
+
+	lex_tokenize(&lex, STRV("a=1;bc:2;"), STRV(__FILE__), __LINE__);
+
+	EXPECT_EQ(eprs_parse_events(NULL, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 1);
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, NULL, &dst, DST_NONE()), 1);
+
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	uint nodes_cnt = eprs.nodes.cnt;
+
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 0);
+	EXPECT_STR(buf, "<file <item <key a>=<val 1>>;<item <key bc>:<val 2>>;>");
+	EXPECT_EQ(eprs.nodes.cnt < nodes_cnt, 1);
+
+	lex_tokenize(&lex, STRV("a=1;b"), STRV(__FILE__), __LINE__);
+	dst.off = 0;
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 1);
+
+	lex_tokenize(&lex, STRV("a=1;a=1;a=1;a=1;a=1;a=1;a=1;a=1;a=1;a=1;a=1;a=1;"), STRV(__FILE__), __LINE__);
+	dst.off = 0;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(eprs_parse_events(&eprs, &lex, &estx, file, eprs_event_print, &dst, DST_NONE()), 1);
+	log_set_quiet(0, 0);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_cut)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file  = ('a' ~ 'b' | 'a' 'c' | 'd') EOF\n"
+				   "scope = (item | 'a' 'c') EOF\n"
+				   "item  = 'a' ~ 'b'\n"
+				   "list  = ('a' ~ 'b')* 'a' 'c' EOF\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+		estx_node_t estx_root;
+		EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &estx_root), 0);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	estx_node_t file, scope, list;
+	estx_find_rule(&estx, STRV("file"), &file);
+	estx_find_rule(&estx, STRV("scope"), &scope);
+	estx_find_rule(&estx, STRV("list"), &list);
+
+	lex_tokenize(&lex, STRV("ab"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	lex_tokenize(&lex, STRV("d"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	lex_tokenize(&lex, STRV("ac"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 1);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, scope, NULL, DST_NONE()), 0);
+	lex_tokenize(&lex, STRV("abac"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, list, NULL, DST_NONE()), 1);
+	lex_tokenize(&lex, STRV("abab"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, list, NULL, DST_NONE()), 1);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_memo)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	estx_node_t file;
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = (pair 'x' | pair 'y' | pair 'z' | 'q') EOF\n"
+				   "pair = 'a' 'a'\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+		estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &file);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	eprs_node_t root;
+	char buf[256] = {0};
+
+	lex_tokenize(&lex, STRV("aax"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_stores, 1);
+	EXPECT_EQ(eprs.memo_hits, 0);
+
+	lex_tokenize(&lex, STRV("aaz"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_stores, 2);
+	EXPECT_EQ(eprs.memo_hits, 1);
+	EXPECT_EQ(eprs_print(&eprs, root, DST_BUF(buf)), 60);
+	EXPECT_STR(buf,
+		   "0\n"
+		   "├─1\n"
+		   "│ ├─'a'\n"
+		   "│ └─'a'\n"
+		   "├─'z'\n"
+		   "└─EOF()\n");
+
+	lex_tokenize(&lex, STRV("q"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_stores, 1);
+	EXPECT_EQ(eprs.memo_hits, 2);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_memo_cut)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	estx_t estx = {0};
+	estx_init(&estx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 100, ALLOC_STD);
+
+	{
+		ebnf_t ebnf = {0};
+		ebnf_init(&ebnf, ALLOC_STD);
+		ebnf_get_stx(&ebnf, ALLOC_STD, DST_NONE());
+
+		uint line   = __LINE__ + 1;
+		strv_t sbnf = STRV("file = stmt* EOF\n"
+				   "stmt = pair ~ ';' | pair ','\n"
+				   "lead = ('x' ~ stmt* | 'x' 'y') EOF\n"
+				   "back = ('x' stmt* | 'x' 'y') EOF\n"
+				   "pair = 'a' 'a'\n");
+		lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+		prs_node_t prs_root;
+		prs_parse(&prs, &lex, &ebnf.stx, ebnf.file, &prs_root, DST_NONE());
+
+		estx_node_t estx_root;
+		EXPECT_EQ(estx_from_ebnf(&ebnf, &prs, prs_root, &estx, &estx_root), 0);
+
+		ebnf_free(&ebnf);
+	}
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 10, ALLOC_STD);
+
+	estx_node_t file, lead, back;
+	estx_find_rule(&estx, STRV("file"), &file);
+	estx_find_rule(&estx, STRV("lead"), &lead);
+	estx_find_rule(&estx, STRV("back"), &back);
+
+	char src[1 + 100 * 3] = {0};
+	src[0]		      = 'x';
+	for (int i = 0; i < 100; i++) {
+		src[1 + i * 3]	   = 'a';
+		src[1 + i * 3 + 1] = 'a';
+		src[1 + i * 3 + 2] = ';';
+	}
+
+	// Nothing returns before a repeated statement once it started, so the memo does not grow with the statements
+	lex_tokenize(&lex, STRVN(&src[1], 300), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, NULL, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_stores, 202);
+	EXPECT_EQ(eprs.memo_cnt, 10);
+
+	// An open alternative around the statements keeps every entry, until a cut commits it
+	lex_tokenize(&lex, STRVN(src, sizeof(src)), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, back, NULL, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_cnt, 202);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, lead, NULL, DST_NONE()), 0);
+	EXPECT_EQ(eprs.memo_cnt, 10);
+
+	eprs_free(&eprs);
+	prs_free(&prs);
+	estx_free(&estx);
+	lex_free(&lex);
+
+	END;
+}
+
+TEST(eprs_parse_split)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("a\n"
+			  "a\n"
+			  "b\n"
+			  "a\n"
+			  "a\n");
+	lex_init(&lex, 0, 16, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), 0);
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	eprs_t eprs = {0};
+	eprs_init(&eprs, 16, ALLOC_STD);
+
+	eprs_t seq = {0};
+	eprs_init(&seq, 16, ALLOC_STD);
+
+	eprs_piece_t pieces[5] = {0};
+	for (uint i = 0; i < 5; i++) {
+		eprs_init(&pieces[i].eprs, 16, ALLOC_STD);
+	}
+
+	estx_node_t file, lines, line;
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("lines"), &lines);
+	estx_rule(&estx, STRV("line"), &line);
+
+	estx_node_t terms, term, group;
+	estx_term_rule(&estx, lines, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_rule(&estx, line, ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, lines, term);
+
+	estx_term_tok(&estx, TOK_NL, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_group(&estx, terms, ESTX_TERM_OCC_OPT, &group);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_add_term(&estx, terms, group);
+	estx_term_tok(&estx, TOK_NL, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, line, term);
+
+	EXPECT_EQ(estx_rule_set_flags(NULL, lines, ESTX_RULE_FLAG_SPLIT), 1);
+	EXPECT_EQ(estx_rule_set_flags(&estx, term, ESTX_RULE_FLAG_SPLIT), 1);
+	EXPECT_EQ(estx_rule_set_flags(&estx, lines, ESTX_RULE_FLAG_SPLIT), 0);
+
+	eprs_set_split(NULL, pieces, 5, NULL, NULL);
+	eprs_set_split(&eprs, pieces, 5, NULL, NULL);
+
+	eprs_node_t root;
+	char exp[1024] = {0};
+	char act[1024] = {0};
+
+	EXPECT_EQ(eprs_parse(&seq, &lex, &estx, file, &root, DST_NONE()), 0);
+	eprs_print(&seq, root, DST_BUF(exp));
+
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	eprs_print(&eprs, root, DST_BUF(act));
+	EXPECT_STR(act, exp);
+	EXPECT_EQ(pieces[1].start, 2);
+	EXPECT_EQ(pieces[1].end, 4);
+	EXPECT_EQ(pieces[1].off, 6);
+
+	uint runs = 0;
+	eprs_set_split(&eprs, pieces, 2, eprs_split_run, &runs);
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_NONE()), 0);
+	mem_set(act, 0, sizeof(act));
+	eprs_print(&eprs, root, DST_BUF(act));
+	EXPECT_STR(act, exp);
+	EXPECT_EQ(runs, 1);
+
+	lex_tokenize(&lex, STRV("a\nc\na\n"), STRV(__FILE__), 0);
+	char buf[256] = {0};
+	EXPECT_EQ(eprs_parse(&seq, &lex, &estx, file, &root, DST_BUF(buf)), 1);
+	mem_set(act, 0, sizeof(act));
+	EXPECT_EQ(eprs_parse(&eprs, &lex, &estx, file, &root, DST_BUF(act)), 1);
+	EXPECT_STR(act, buf);
+
+	for (uint i = 0; i < 5; i++) {
+		eprs_free(&pieces[i].eprs);
+	}
+	eprs_free(&seq);
+	estx_free(&estx);
+	lex_free(&lex);
+	eprs_free(&eprs);
+
+	END;
+}
+
 TEST(eprs_parse)
 {
 	SSTART;
@@ -1148,13 +2601,28 @@ TEST(eprs_parse)
 	RUN(eprs_parse_con);
 	RUN(eprs_parse_group_failed);
 	RUN(eprs_parse_group);
+	RUN(eprs_parse_group_reset);
+	RUN(eprs_parse_set);
 	RUN(eprs_parse_opt);
 	RUN(eprs_parse_rep_failed);
 	RUN(eprs_parse_rep_loop);
 	RUN(eprs_parse_rep);
+	RUN(eprs_parse_list);
 	RUN(eprs_parse_name);
 	RUN(eprs_parse_cache);
 	RUN(eprs_parse_ebnf);
+	RUN(eprs_parse_expr);
+	RUN(eprs_reparse_expr);
+	RUN(eprs_recognize);
+	RUN(eprs_parse_two_phase);
+	RUN(eprs_parse_chr_rep);
+	RUN(eprs_parse_lex);
+	RUN(eprs_parse_inline);
+	RUN(eprs_parse_analyzed);
+	RUN(eprs_parse_events);
+	RUN(eprs_parse_cut);
+	RUN(eprs_parse_memo);
+	RUN(eprs_parse_memo_cut);
 
 	SEND;
 }
@@ -1203,8 +2671,13 @@ STEST(eprs)
 	RUN(eprs_add_node);
 	RUN(eprs_remove_node);
 	RUN(eprs_get_rule);
+	RUN(eprs_get_node_rule);
+	RUN(eprs_set_span);
 	RUN(eprs_get_str);
 	RUN(eprs_parse);
+	RUN(eprs_parse_errs);
+	RUN(eprs_parse_split);
+	RUN(eprs_reparse);
 	RUN(eprs_print);
 
 	SEND;
@@ -259,6 +259,136 @@ TEST(estx_term_group)
 	END;
 }
 
+TEST(estx_term_expr)
+{
+	START;
+
+	estx_t estx = {0};
+	log_set_quiet(0, 1);
+	estx_init(&estx, 0, ALLOC_STD);
+	log_set_quiet(0, 0);
+
+	estx_node_t rule, op, term;
+	estx_rule(&estx, STRV("num"), &rule);
+
+	EXPECT_EQ(estx_op(NULL, STRV("+"), ESTX_OP_LEFT, 1, NULL), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_op(&estx, STRV(""), ESTX_OP_LEFT, 1, NULL), 1);
+	log_set_quiet(0, 0);
+	mem_oom(1);
+	EXPECT_EQ(estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, NULL), 1);
+	mem_oom(0);
+	EXPECT_EQ(estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &op), 0);
+	EXPECT_STRN(estx_data_lit(&estx, estx_get_node(&estx, op)).data, "+", 1);
+
+	EXPECT_EQ(estx_term_expr(NULL, rule, op, ESTX_TERM_OCC_ONE, NULL), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_term_expr(&estx, op, op, ESTX_TERM_OCC_ONE, NULL), 1);
+	EXPECT_EQ(estx_term_expr(&estx, rule, rule, ESTX_TERM_OCC_ONE, NULL), 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_term_expr(&estx, rule, op, ESTX_TERM_OCC_ONE, NULL), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(estx_term_expr(&estx, rule, op, ESTX_TERM_OCC_ONE, &term), 0);
+	EXPECT_EQ(term, 2);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_term_cut)
+{
+	START;
+
+	estx_t estx = {0};
+	log_set_quiet(0, 1);
+	estx_init(&estx, 0, ALLOC_STD);
+	log_set_quiet(0, 0);
+
+	estx_node_t term;
+
+	EXPECT_EQ(estx_term_cut(NULL, NULL), 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_term_cut(&estx, NULL), 1);
+	mem_oom(0);
+	EXPECT_EQ(estx_term_cut(&estx, &term), 0);
+	EXPECT_EQ(term, 0);
+	EXPECT_EQ(estx_get_node(&estx, term)->type, ESTX_TERM_CUT);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_term_set)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 1, ALLOC_STD);
+
+	tok_set_t set = {0};
+	tok_set_add(&set, '0', '9');
+
+	estx_node_t term;
+
+	EXPECT_EQ(estx_term_set(NULL, &set, ESTX_TERM_OCC_ONE, NULL), 1);
+	EXPECT_EQ(estx_term_set(&estx, NULL, ESTX_TERM_OCC_ONE, NULL), 1);
+	log_set_quiet(0, 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_term_set(&estx, &set, ESTX_TERM_OCC_ONE, NULL), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(estx_term_set(&estx, &set, ESTX_TERM_OCC_REP, &term), 0);
+	EXPECT_EQ(term, 0);
+	EXPECT_EQ(estx_get_node(&estx, term)->type, ESTX_TERM_SET);
+
+	EXPECT_NULL(estx_data_set(NULL, estx_get_node(&estx, term)));
+	EXPECT_EQ(tok_set_has(estx_data_set(&estx, estx_get_node(&estx, term)), '5'), 1);
+	EXPECT_EQ(tok_set_has(estx_data_set(&estx, estx_get_node(&estx, term)), 'a'), 0);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_term_list)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 2, ALLOC_STD);
+
+	estx_node_t elem, sep, term;
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &elem);
+	estx_term_lit(&estx, STRV(","), ESTX_TERM_OCC_ONE, &sep);
+
+	EXPECT_EQ(estx_term_list(NULL, elem, sep, 1, 0, ESTX_TERM_OCC_ONE, NULL), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_term_list(&estx, elem, 2, 1, 0, ESTX_TERM_OCC_ONE, NULL), 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_term_list(&estx, elem, sep, 1, 0, ESTX_TERM_OCC_ONE, NULL), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(estx_term_list(&estx, elem, sep, 1, 1, ESTX_TERM_OCC_OPT, &term), 0);
+	EXPECT_EQ(term, 2);
+
+	const estx_node_data_t *data = estx_get_node(&estx, term);
+	EXPECT_EQ(data->type, ESTX_TERM_LIST);
+	EXPECT_EQ(data->val.list.terms, elem);
+	EXPECT_EQ(data->val.list.min, 1);
+	EXPECT_EQ(data->val.list.keep, 1);
+
+	estx_node_t next;
+	list_get_next(&estx.nodes, elem, &next);
+	EXPECT_EQ(next, sep);
+
+	estx_free(&estx);
+
+	END;
+}
+
 TEST(estx_find_rule)
 {
 	START;
@@ -284,6 +414,45 @@ TEST(estx_find_rule)
 	END;
 }
 
+TEST(estx_find_rule_many)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 128, ALLOC_STD);
+
+	char name[8] = {0};
+	for (int i = 0; i < 12; i++) {
+		estx_rule(&estx, STRVN(name, dputf(DST_BUF(name), "r%d", i)), NULL);
+	}
+
+	mem_oom(1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_rule(&estx, STRV("r12"), NULL), 1);
+	log_set_quiet(0, 0);
+	mem_oom(0);
+
+	for (int i = 12; i < 100; i++) {
+		estx_rule(&estx, STRVN(name, dputf(DST_BUF(name), "r%d", i)), NULL);
+	}
+
+	estx_node_t rule;
+	EXPECT_EQ(estx_rule(&estx, STRV("r5"), &rule), 0);
+	EXPECT_EQ(rule, 100);
+
+	estx_node_t got;
+	EXPECT_EQ(estx_find_rule(&estx, STRV("r5"), &got), 0);
+	EXPECT_EQ(got, 5);
+	EXPECT_EQ(estx_find_rule(&estx, STRV("r99"), &got), 0);
+	EXPECT_EQ(got, 99);
+	EXPECT_EQ(estx_find_rule(&estx, STRV("r100"), &got), 1);
+	EXPECT_EQ(estx.rules_cnt, 100);
+
+	estx_free(&estx);
+
+	END;
+}
+
 TEST(estx_get_node)
 {
 	START;
@@ -575,6 +744,191 @@ TEST(estx_print_group)
 	END;
 }
 
+TEST(estx_print_expr)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	estx_node_t rule, num, ops, op, term;
+
+	estx_rule(&estx, STRV("expr"), &rule);
+	estx_rule(&estx, STRV("num"), &num);
+	estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &ops);
+	estx_op(&estx, STRV("^"), ESTX_OP_RIGHT, 2, &op);
+	estx_add_term(&estx, ops, op);
+	estx_op(&estx, STRV("'"), ESTX_OP_PREFIX, 3, &op);
+	estx_add_term(&estx, ops, op);
+	estx_term_expr(&estx, num, ops, ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, rule, term);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, num, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(estx_print(&estx, DST_BUF(buf)), 65);
+	EXPECT_STR(buf,
+		   "expr = num('+' 1 left | '^' 2 right | \"'\" 3 prefix)?\n"
+		   "num = DIGIT\n");
+	EXPECT_EQ(estx_print_tree(&estx, DST_BUF(buf)), 104);
+	EXPECT_STR(buf,
+		   "<expr>\n"
+		   "└─expr <num>?\n"
+		   "  ├─'+' 1 left\n"
+		   "  ├─'^' 2 right\n"
+		   "  └─\"'\" 3 prefix\n"
+		   "\n"
+		   "<num>\n"
+		   "└─DIGIT\n");
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_print_cut)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 4, ALLOC_STD);
+
+	estx_node_t rule, terms, term;
+
+	estx_rule(&estx, STRV("cut"), &rule);
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_cut(&estx, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, rule, term);
+
+	char buf[128] = {0};
+	EXPECT_EQ(estx_print(&estx, DST_BUF(buf)), 16);
+	EXPECT_STR(buf, "cut = 'a' ~ 'b'\n");
+	EXPECT_EQ(estx_print_tree(&estx, DST_BUF(buf)), 50);
+	EXPECT_STR(buf,
+		   "<cut>\n"
+		   "└─con\n"
+		   "  ├─'a'\n"
+		   "  ├─~\n"
+		   "  └─'b'\n");
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_print_set)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 4, ALLOC_STD);
+
+	tok_set_t set = {0};
+	tok_set_add(&set, 'a', 'z');
+	tok_set_add(&set, '-', '-');
+
+	estx_node_t rule, term;
+
+	estx_rule(&estx, STRV("set"), &rule);
+	estx_term_set(&estx, &set, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, rule, term);
+
+	char buf[128] = {0};
+	EXPECT_EQ(estx_print(&estx, DST_BUF(buf)), 15);
+	EXPECT_STR(buf, "set = [\\-a-z]*\n");
+	EXPECT_EQ(estx_print_tree(&estx, DST_BUF(buf)), 21);
+	EXPECT_STR(buf,
+		   "<set>\n"
+		   "└─[\\-a-z]*\n");
+
+	char data[256] = {0};
+	size_t size = estx_save(&estx, data, sizeof(data));
+
+	estx_t load = {0};
+	estx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(estx_load(&load, data, size), 0);
+	EXPECT_EQ(estx_print(&load, DST_BUF(buf)), 15);
+	EXPECT_STR(buf, "set = [\\-a-z]*\n");
+	estx_free(&load);
+
+	data[size - 4 - 8 - 32 - 4] = 31;
+	estx_init(&load, 1, ALLOC_STD);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	estx_free(&load);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_print_list)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 8, ALLOC_STD);
+
+	estx_node_t rule, elem, sep, term;
+
+	estx_rule(&estx, STRV("list"), &rule);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_REP, &elem);
+	estx_term_lit(&estx, STRV(", "), ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 2, 0, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, rule, term);
+
+	estx_rule(&estx, STRV("keep"), &rule);
+	estx_term_tok(&estx, TOK_LOWER, ESTX_TERM_OCC_ONE, &elem);
+	estx_term_lit(&estx, STRV("-"), ESTX_TERM_OCC_OPT, &sep);
+	estx_term_list(&estx, elem, sep, 0, 1, ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, rule, term);
+
+	char buf[128] = {0};
+	EXPECT_EQ(estx_print(&estx, DST_BUF(buf)), 64);
+	EXPECT_STR(buf,
+		   "list = list(DIGIT+, ', ', 2)\n"
+		   "keep = list(LOWER, '-'?, 0, keep)?\n");
+	EXPECT_EQ(estx_print_tree(&estx, DST_BUF(buf)), 105);
+	EXPECT_STR(buf,
+		   "<list>\n"
+		   "└─list(2)\n"
+		   "  ├─DIGIT+\n"
+		   "  └─', '\n"
+		   "\n"
+		   "<keep>\n"
+		   "└─list(0, keep)?\n"
+		   "  ├─LOWER\n"
+		   "  └─'-'?\n");
+
+	char data[256] = {0};
+	size_t size = estx_save(&estx, data, sizeof(data));
+
+	estx_t load = {0};
+	estx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(estx_load(&load, data, size), 0);
+	EXPECT_EQ(estx_print(&load, DST_BUF(buf)), 64);
+	EXPECT_STR(buf,
+		   "list = list(DIGIT+, ', ', 2)\n"
+		   "keep = list(LOWER, '-'?, 0, keep)?\n");
+	estx_free(&load);
+
+	data[size - 4 - 8 * 4 - 4] = 2;
+	estx_init(&load, 1, ALLOC_STD);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	estx_free(&load);
+
+	estx_free(&estx);
+
+	END;
+}
+
 TEST(estx_print_empty_rules)
 {
 	START;
@@ -699,6 +1053,359 @@ TEST(estx_print_unknown_term)
 	END;
 }
 
+TEST(estx_save_load)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	estx_node_t rule, num, ops, op, terms, alt, term;
+
+	estx_rule(&estx, STRV("expr"), &rule);
+	estx_rule(&estx, STRV("num"), &num);
+	estx_rule_set_flags(&estx, num, ESTX_RULE_FLAG_SPLIT);
+	estx_op(&estx, STRV("+"), ESTX_OP_LEFT, 1, &ops);
+	estx_op(&estx, STRV("'"), ESTX_OP_PREFIX, 2, &op);
+	estx_add_term(&estx, ops, op);
+	estx_term_expr(&estx, num, ops, ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, rule, term);
+	estx_term_lit(&estx, STRV("0x"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_cut(&estx, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &alt);
+	estx_term_rule(&estx, rule, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_group(&estx, terms, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, alt, term);
+	estx_term_alt(&estx, alt, &term);
+	estx_add_term(&estx, num, term);
+
+	size_t size = estx_save(&estx, NULL, 0);
+	EXPECT_EQ(size, 283);
+
+	char data[512] = {0};
+	EXPECT_EQ(estx_save(NULL, data, sizeof(data)), 0);
+	EXPECT_EQ(estx_save(&estx, data, 4), size);
+	EXPECT_EQ(estx_save(&estx, data, sizeof(data)), size);
+
+	estx_t load = {0};
+	estx_init(&load, 1, ALLOC_STD);
+
+	EXPECT_EQ(estx_load(NULL, data, size), 1);
+	EXPECT_EQ(estx_load(&load, NULL, size), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, 8), 1);
+	log_set_quiet(0, 0);
+	estx_free(&load);
+	estx_init(&load, 1, ALLOC_STD);
+	data[0] = 0;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	estx_save(&estx, data, sizeof(data));
+	data[4] = 3;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	data[4] = 2;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size - 1), 1);
+	log_set_quiet(0, 0);
+	estx_free(&load);
+	estx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(estx_load(&load, data, size), 0);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+
+	char buf[256] = {0};
+	char exp[256] = {0};
+	estx_print(&estx, DST_BUF(exp));
+	EXPECT_EQ(estx_print(&load, DST_BUF(buf)), 69);
+	EXPECT_STR(buf, exp);
+	estx_print_tree(&estx, DST_BUF(exp));
+	estx_print_tree(&load, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+	EXPECT_EQ(estx_get_node(&load, num)->flags, ESTX_RULE_FLAG_SPLIT);
+
+	estx_free(&load);
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_analyze)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	estx_node_t file, list, item, dead, terms, term, alt;
+
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("list"), &list);
+	estx_rule(&estx, STRV("item"), &item);
+	estx_rule(&estx, STRV("dead"), &dead);
+
+	estx_term_rule(&estx, list, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_lit(&estx, STRV(","), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &alt);
+	estx_term_group(&estx, alt, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &term);
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &terms);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, list, term);
+
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_REP, &terms);
+	estx_term_lit(&estx, STRV("x"), ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_alt(&estx, terms, &term);
+	estx_add_term(&estx, item, term);
+
+	estx_term_cut(&estx, &terms);
+	estx_term_lit(&estx, STRV("y"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, dead, term);
+
+	char buf[512] = {0};
+	EXPECT_EQ(estx_analyze(NULL, file, DST_BUF(buf)), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_analyze(&estx, term, DST_BUF(buf)), 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_analyze(&estx, file, DST_BUF(buf)), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(estx_print_info(&estx, DST_BUF(buf)), 0);
+
+	EXPECT_EQ(estx_analyze(&estx, file, DST_BUF(buf)), 0);
+	EXPECT_STR(buf, "warning: rule 'dead' is unreachable\n");
+
+	EXPECT_EQ(estx_print_info(NULL, DST_BUF(buf)), 0);
+	EXPECT_EQ(estx_print_info(&estx, DST_BUF(buf)), 174);
+	EXPECT_STR(buf,
+		   "file: nullable first: DIGIT|EOF ',' 'x' follow: EOF\n"
+		   "list: nullable first: DIGIT ',' 'x' follow: EOF\n"
+		   "item: nullable first: DIGIT 'x' follow: EOF ','\n"
+		   "dead: first: 'y' follow: \n");
+
+	EXPECT_NULL(estx_get_info(NULL, file));
+	EXPECT_NULL(estx_get_info(&estx, estx.nodes.cnt));
+	const estx_info_t *info = estx_get_info(&estx, terms);
+	EXPECT_EQ(info->rule, dead);
+	EXPECT_EQ(info->nullable, 1);
+	EXPECT_EQ(info->cut, 1);
+	info = estx_get_info(&estx, term);
+	EXPECT_EQ(info->nullable, 0);
+	EXPECT_EQ(info->cut, 1);
+	EXPECT_EQ(info->has_exp, 1);
+	EXPECT_EQ(info->exp_rule, dead);
+
+	char data[4096] = {0};
+	size_t size = estx_save(&estx, data, sizeof(data));
+	EXPECT_EQ(size, 2083);
+
+	estx_t load = {0};
+	estx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(estx_load(&load, data, size), 0);
+	char exp[512] = {0};
+	estx_print_info(&estx, DST_BUF(exp));
+	EXPECT_EQ(estx_print_info(&load, DST_BUF(buf)), 174);
+	EXPECT_STR(buf, exp);
+	info = estx_get_info(&load, term);
+	EXPECT_EQ(info->cut, 1);
+	EXPECT_EQ(info->has_exp, 1);
+	EXPECT_EQ(info->exp_rule, dead);
+	estx_free(&load);
+
+	data[size - 4] = 64;
+	estx_init(&load, 1, ALLOC_STD);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(estx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	estx_free(&load);
+
+	EXPECT_EQ(estx_toks_has(NULL, (tok_t){.type = 1 << TOK_DIGIT}, STRV("1")), 0);
+	EXPECT_EQ(estx_toks_has(&estx_get_info(&estx, item)->first, (tok_t){.type = 1 << TOK_DIGIT}, STRV("1")), 1);
+	EXPECT_EQ(estx_toks_has(&estx_get_info(&estx, item)->first, (tok_t){.type = 1 << TOK_LOWER}, STRV("x")), 1);
+	EXPECT_EQ(estx_toks_has(&estx_get_info(&estx, item)->first, (tok_t){.type = 1 << TOK_LOWER}, STRV("y")), 0);
+	EXPECT_EQ(estx_toks_has(&estx_get_info(&estx, item)->first, (tok_t){.type = 1 << TOK_WORD}, STRV("xx")), 0);
+
+	estx_term_cut(&estx, NULL);
+	EXPECT_NULL(estx_get_info(&estx, file));
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_analyze_list)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	estx_node_t file, item, opt, elem, sep, terms, term, list;
+
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("item"), &item);
+	estx_rule(&estx, STRV("opt"), &opt);
+
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &elem);
+	estx_term_lit(&estx, STRV(","), ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 2, 0, ESTX_TERM_OCC_ONE, &list);
+	estx_term_tok(&estx, TOK_EOF, ESTX_TERM_OCC_ONE, &term);
+	terms = list;
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_tok(&estx, TOK_DIGIT, ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, item, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_OPT, &elem);
+	estx_term_rule(&estx, opt, ESTX_TERM_OCC_ONE, &sep);
+	estx_term_list(&estx, elem, sep, 1, 0, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, opt, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(estx_analyze(&estx, file, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "error: in rule 'opt': left recursion\n"
+		   "warning: rule 'opt' is unreachable\n");
+
+	EXPECT_EQ(estx_print_info(&estx, DST_BUF(buf)), 103);
+	EXPECT_STR(buf,
+		   "file: first: DIGIT follow: EOF\n"
+		   "item: first: DIGIT follow: EOF ','\n"
+		   "opt: nullable first: 'a' follow: 'a'\n");
+
+	const estx_info_t *info = estx_get_info(&estx, list);
+	EXPECT_EQ(info->nullable, 0);
+	EXPECT_EQ(info->has_exp, 1);
+	EXPECT_EQ(info->exp_rule, item);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_analyze_invalid)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	estx_node_t rec, loop, terms, term;
+
+	estx_rule(&estx, STRV("rec"), &rec);
+	estx_rule(&estx, STRV("loop"), &loop);
+
+	estx_term_rule(&estx, rec, ESTX_TERM_OCC_ONE, &terms);
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &terms);
+	estx_term_rule(&estx, loop, ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_alt(&estx, terms, &term);
+	estx_add_term(&estx, rec, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_OPT, &terms);
+	estx_term_group(&estx, terms, ESTX_TERM_OCC_OPT | ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, loop, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(estx_analyze(&estx, rec, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "error: in rule 'rec': left recursion\n"
+		   "error: in rule 'loop': repeated term can match nothing\n");
+	EXPECT_EQ(estx_get_info(&estx, rec)->left_rec, 1);
+	EXPECT_EQ(estx_get_info(&estx, loop)->left_rec, 0);
+
+	estx_free(&estx);
+
+	END;
+}
+
+TEST(estx_optimize)
+{
+	START;
+
+	estx_t estx = {0};
+	estx_init(&estx, 16, ALLOC_STD);
+
+	estx_node_t file, item, word, sub, terms, term;
+
+	estx_rule(&estx, STRV("file"), &file);
+	estx_rule(&estx, STRV("item"), &item);
+	estx_rule(&estx, STRV("word"), &word);
+	estx_rule(&estx, STRV("sub"), &sub);
+	estx_rule_set_flags(&estx, item, ESTX_RULE_FLAG_INLINE);
+	estx_rule_set_flags(&estx, word, ESTX_RULE_FLAG_LEX);
+
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_term_lit(&estx, STRV("c"), ESTX_TERM_OCC_ONE, &terms);
+	estx_add_term(&estx, term, terms);
+	estx_term_con(&estx, term, &term);
+	estx_term_group(&estx, term, ESTX_TERM_OCC_ONE, &term);
+	estx_term_rule(&estx, item, ESTX_TERM_OCC_ONE, &terms);
+	estx_add_term(&estx, terms, term);
+	estx_term_rule(&estx, word, ESTX_TERM_OCC_REP, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, file, term);
+
+	estx_term_lit(&estx, STRV("x"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_lit(&estx, STRV("y"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_alt(&estx, terms, &term);
+	estx_add_term(&estx, item, term);
+
+	estx_term_lit(&estx, STRV("a"), ESTX_TERM_OCC_ONE, &terms);
+	estx_term_lit(&estx, STRV("b"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_rule(&estx, sub, ESTX_TERM_OCC_OPT, &term);
+	estx_add_term(&estx, terms, term);
+	estx_term_con(&estx, terms, &term);
+	estx_add_term(&estx, word, term);
+
+	estx_term_lit(&estx, STRV("c"), ESTX_TERM_OCC_ONE, &term);
+	estx_add_term(&estx, sub, term);
+
+	EXPECT_EQ(estx_optimize(NULL), 1);
+	log_set_quiet(0, 1);
+	mem_oom(1);
+	EXPECT_EQ(estx_optimize(&estx), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+
+	EXPECT_EQ(estx_optimize(&estx), 0);
+
+	char buf[256] = {0};
+	EXPECT_EQ(estx_print(&estx, DST_BUF(buf)), 82);
+	EXPECT_STR(buf,
+		   "file = ([xy]) 'b' 'c' word+\n"
+		   "@inline item = [xy]\n"
+		   "@lex word = 'ab' ('c')?\n"
+		   "sub = 'c'\n");
+
+	estx_free(&estx);
+
+	END;
+}
+
 STEST(estx)
 {
 	SSTART;
@@ -713,7 +1420,12 @@ STEST(estx)
 	RUN(estx_term_alt);
 	RUN(estx_term_con);
 	RUN(estx_term_group);
+	RUN(estx_term_expr);
+	RUN(estx_term_cut);
+	RUN(estx_term_set);
+	RUN(estx_term_list);
 	RUN(estx_find_rule);
+	RUN(estx_find_rule_many);
 	RUN(estx_get_node);
 	RUN(estx_data_lit);
 	RUN(estx_add_term);
@@ -725,10 +1437,19 @@ STEST(estx)
 	RUN(estx_print_alt);
 	RUN(estx_print_con);
 	RUN(estx_print_group);
+	RUN(estx_print_expr);
+	RUN(estx_print_cut);
+	RUN(estx_print_set);
+	RUN(estx_print_list);
 	RUN(estx_print_empty_rules);
 	RUN(estx_print_invalid_rule);
 	RUN(estx_print_invalid_alt);
 	RUN(estx_print_unknown_term);
+	RUN(estx_save_load);
+	RUN(estx_analyze);
+	RUN(estx_analyze_list);
+	RUN(estx_analyze_invalid);
+	RUN(estx_optimize);
 
 	SEND;
 }
@@ -263,6 +263,7 @@ TEST(prs_get_str)
 	tok_t str = {0};
 	log_set_quiet(0, 1);
 	EXPECT_EQ(prs_get_str(&prs, root, &str), 0);
+	EXPECT_EQ(prs_get_str(&prs, node, &str), 1);
 	log_set_quiet(0, 0);
 
 	EXPECT_EQ(str.start, 0);
@@ -749,6 +750,11 @@ TEST(prs_parse_cache)
 		   "│   └─'a'\n"
 		   "└─EOF()\n");
 
+	tok_t str = {0};
+	EXPECT_EQ(prs_get_str(&prs, root, &str), 0);
+	EXPECT_EQ(str.start, 0);
+	EXPECT_EQ(str.len, 1);
+
 	prs_free(&prs);
 	lex_free(&lex);
 	stx_free(&stx);
@@ -756,6 +762,174 @@ TEST(prs_parse_cache)
 	END;
 }
 
+static void prs_batch_cb_rets(const prs_t *prs, uint index, int ret, prs_node_t root, void *priv)
+{
+	(void)prs;
+	(void)root;
+	int *rets   = priv;
+	rets[index] = ret;
+}
+
+TEST(prs_parse_batch)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_set_src(&lex, STRV_NULL, STRV(__FILE__), 0);
+
+	stx_t stx = {0};
+	stx_init(&stx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 16, ALLOC_STD);
+
+	stx_node_t file, ra;
+	stx_rule(&stx, STRV("file"), &file);
+	stx_rule(&stx, STRV("ra"), &ra);
+
+	stx_node_t term;
+	stx_term_rule(&stx, ra, &term);
+	stx_add_term(&stx, file, term);
+	stx_term_tok(&stx, TOK_EOF, &term);
+	stx_add_term(&stx, file, term);
+
+	stx_term_lit(&stx, STRV("a"), &term);
+	stx_add_term(&stx, ra, term);
+
+	strv_t srcs[] = {STRV("a"), STRV("b"), STRV("a")};
+	int rets[3]   = {0};
+
+	EXPECT_EQ(prs_parse_batch(NULL, &lex, &stx, file, srcs, 3, NULL, NULL, DST_NONE()), 1);
+	EXPECT_EQ(prs_parse_batch(&prs, &lex, &stx, file, NULL, 3, NULL, NULL, DST_NONE()), 1);
+	EXPECT_EQ(prs_parse_batch(&prs, &lex, &stx, file, NULL, 0, NULL, NULL, DST_NONE()), 0);
+	EXPECT_EQ(prs_parse_batch(&prs, &lex, &stx, file, srcs, 3, prs_batch_cb_rets, rets, DST_NONE()), 1);
+	EXPECT_EQ(rets[0], 0);
+	EXPECT_EQ(rets[1], 1);
+	EXPECT_EQ(rets[2], 0);
+	EXPECT_EQ(prs.parse_fail_gen, 3);
+
+	prs.parse_fail_gen = (uint)-1;
+	EXPECT_EQ(prs_parse_batch(&prs, &lex, &stx, file, srcs, 1, NULL, NULL, DST_NONE()), 0);
+	EXPECT_EQ(prs.parse_fail_gen, 1);
+
+	strv_t fails[] = {STRV("b"), STRV("a"), STRV("ab")};
+	char buf[256]  = {0};
+	lex_set_src(&lex, STRV_NULL, STRV("t.txt"), 0);
+	EXPECT_EQ(prs_parse_batch(&prs, &lex, &stx, file, fails, 3, NULL, NULL, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:0: error: expected 'a'\n"
+		   "b\n"
+		   "^\n"
+		   "t.txt:0:1: error: expected EOF\n"
+		   "ab\n"
+		   " ^\n");
+
+	prs_free(&prs);
+	lex_free(&lex);
+	stx_free(&stx);
+
+	END;
+}
+
+TEST(prs_recognize)
+{
+	START;
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	stx_t stx = {0};
+	stx_init(&stx, 10, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 16, ALLOC_STD);
+
+	stx_node_t file, ra;
+	stx_rule(&stx, STRV("file"), &file);
+	stx_rule(&stx, STRV("ra"), &ra);
+
+	stx_node_t term;
+	stx_term_rule(&stx, ra, &term);
+	stx_add_term(&stx, file, term);
+	stx_term_tok(&stx, TOK_EOF, &term);
+	stx_add_term(&stx, file, term);
+
+	stx_term_lit(&stx, STRV("a"), &term);
+	stx_add_term(&stx, ra, term);
+
+	EXPECT_EQ(prs_recognize(NULL, &lex, &stx, file, DST_NONE()), 1);
+
+	lex_tokenize(&lex, STRV("a"), STRV(__FILE__), __LINE__);
+	EXPECT_EQ(prs_recognize(&prs, &lex, &stx, file, DST_NONE()), 0);
+	EXPECT_EQ(prs.nodes.cnt, 0);
+	EXPECT_EQ(prs.recognize, 0);
+
+	char buf[128] = {0};
+	lex_tokenize(&lex, STRV("b"), STRV("t.txt"), 0);
+	EXPECT_EQ(prs_recognize(&prs, &lex, &stx, file, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:0: error: expected 'a'\n"
+		   "b\n"
+		   "^\n");
+	EXPECT_EQ(prs.nodes.cnt, 0);
+
+	prs_free(&prs);
+	lex_free(&lex);
+	stx_free(&stx);
+
+	END;
+}
+
+TEST(prs_parse_two_phase)
+{
+	START;
+
+	bnf_t bnf = {0};
+	bnf_init(&bnf, ALLOC_STD);
+	bnf_get_stx(&bnf);
+
+	lex_t lex = {0};
+	lex_init(&lex, 0, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 256, ALLOC_STD);
+
+	EXPECT_EQ(prs_parse_two_phase(NULL, &lex, &bnf.stx, bnf.file, NULL, DST_NONE()), 1);
+
+	uint line   = __LINE__ + 1;
+	strv_t sbnf = STRV("<file> ::= <ab> EOF\n"
+			   "<ab>   ::= 'a' <ab> | 'b'\n");
+	lex_tokenize(&lex, sbnf, STRV(__FILE__), line);
+
+	prs_node_t root;
+	char exp[2048] = {0};
+	char buf[2048] = {0};
+
+	EXPECT_EQ(prs_parse(&prs, &lex, &bnf.stx, bnf.file, &root, DST_NONE()), 0);
+	EXPECT_EQ(prs.diag.backtracks > 0, 1);
+	size_t len = prs_print(&prs, root, DST_BUF(exp));
+
+	EXPECT_EQ(prs_parse_two_phase(&prs, &lex, &bnf.stx, bnf.file, &root, DST_NONE()), 0);
+	EXPECT_EQ(prs.diag.backtracks, 0);
+	EXPECT_EQ(prs.guided, 0);
+	EXPECT_EQ(prs_print(&prs, root, DST_BUF(buf)), len);
+	EXPECT_STR(buf, exp);
+
+	lex_tokenize(&lex, STRV("<file> ::= "), STRV("t.txt"), 0);
+	EXPECT_EQ(prs_parse_two_phase(&prs, &lex, &bnf.stx, bnf.file, &root, DST_BUF(buf)), 1);
+	EXPECT_STR(buf,
+		   "t.txt:0:11: error: expected '<'\n"
+		   "<file> ::= \n"
+		   "           ^\n");
+
+	prs_free(&prs);
+	lex_free(&lex);
+	bnf_free(&bnf);
+
+	END;
+}
+
 TEST(prs_parse_bnf)
 {
 	START;
@@ -835,6 +1009,92 @@ TEST(prs_parse_bnf)
 	END;
 }
 
+TEST(prs_parse_set_unexpected)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("a-");
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), __LINE__ - 2);
+
+	stx_t stx = {0};
+	stx_init(&stx, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 256, ALLOC_STD);
+
+	tok_set_t set = {0};
+	tok_set_add(&set, 'a', 'z');
+	tok_set_add(&set, '_', '_');
+
+	stx_node_t rule;
+	stx_rule(&stx, STRV("rule"), &rule);
+	stx_node_t term;
+	stx_term_set(&stx, &set, &term);
+	stx_add_term(&stx, rule, term);
+	stx_term_set(&stx, &set, &term);
+	stx_add_term(&stx, rule, term);
+
+	char buf[256] = {0};
+	EXPECT_EQ(prs_parse(&prs, &lex, &stx, rule, NULL, DST_BUF(buf)), 1);
+
+	EXPECT_STR(buf + sizeof(__FILE__ ":0000:") - 1,
+		   "1: error: expected [_a-z]\n"
+		   "a-\n"
+		   " ^\n");
+
+	stx_free(&stx);
+	lex_free(&lex);
+	prs_free(&prs);
+
+	END;
+}
+
+TEST(prs_parse_set)
+{
+	START;
+
+	lex_t lex  = {0};
+	strv_t src = STRV("a_");
+	lex_init(&lex, 0, 1, ALLOC_STD);
+	lex_tokenize(&lex, src, STRV(__FILE__), __LINE__ - 2);
+
+	stx_t stx = {0};
+	stx_init(&stx, 1, ALLOC_STD);
+
+	prs_t prs = {0};
+	prs_init(&prs, 256, ALLOC_STD);
+
+	tok_set_t set = {0};
+	tok_set_add(&set, 'a', 'z');
+	tok_set_add(&set, '_', '_');
+
+	stx_node_t rule;
+	stx_rule(&stx, STRV("rule"), &rule);
+	stx_node_t term;
+	stx_term_set(&stx, &set, &term);
+	stx_add_term(&stx, rule, term);
+	stx_term_set(&stx, &set, &term);
+	stx_add_term(&stx, rule, term);
+
+	prs_node_t root;
+	EXPECT_EQ(prs_parse(&prs, &lex, &stx, rule, &root, DST_NONE()), 0);
+
+	char buf[64] = {0};
+	EXPECT_EQ(prs_print(&prs, root, DST_BUF(buf)), 25);
+	EXPECT_STR(buf,
+		   "rule\n"
+		   "├─'a'\n"
+		   "└─'_'\n");
+
+	stx_free(&stx);
+	lex_free(&lex);
+	prs_free(&prs);
+
+	END;
+}
+
 TEST(prs_parse)
 {
 	SSTART;
@@ -847,12 +1107,17 @@ TEST(prs_parse)
 	RUN(prs_parse_literal_unexpected_end);
 	RUN(prs_parse_literal_unexpected);
 	RUN(prs_parse_literal);
+	RUN(prs_parse_set_unexpected);
+	RUN(prs_parse_set);
 	RUN(prs_parse_or_l);
 	RUN(prs_parse_or_r);
 	RUN(prs_parse_or_unexpected);
 	RUN(prs_parse_empty_syntax);
 	RUN(prs_parse_cache_alloc_failure);
 	RUN(prs_parse_cache);
+	RUN(prs_parse_batch);
+	RUN(prs_recognize);
+	RUN(prs_parse_two_phase);
 	RUN(prs_parse_bnf);
 
 	SEND;
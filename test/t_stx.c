@@ -200,6 +200,65 @@ TEST(stx_term_or)
 	END;
 }
 
+TEST(stx_term_set)
+{
+	START;
+
+	stx_t stx = {0};
+	stx_init(&stx, 1, ALLOC_STD);
+
+	tok_set_t set = {0};
+	tok_set_add(&set, 'a', 'z');
+	tok_set_add(&set, '_', '_');
+
+	stx_node_t rule, term;
+	stx_rule(&stx, STRV("name"), &rule);
+
+	EXPECT_EQ(stx_term_set(NULL, &set, &term), 1);
+	EXPECT_EQ(stx_term_set(&stx, NULL, &term), 1);
+	log_set_quiet(0, 1);
+	mem_oom(1);
+	EXPECT_EQ(stx_term_set(&stx, &set, &term), 1);
+	mem_oom(0);
+	log_set_quiet(0, 0);
+	EXPECT_EQ(stx_term_set(&stx, &set, &term), 0);
+	stx_add_term(&stx, rule, term);
+
+	EXPECT_NULL(stx_data_set(NULL, stx_get_node(&stx, term)));
+	EXPECT_NULL(stx_data_set(&stx, stx_get_node(&stx, rule)));
+	EXPECT_EQ(tok_set_has(stx_data_set(&stx, stx_get_node(&stx, term)), '_'), 1);
+	EXPECT_EQ(tok_set_has(stx_data_set(&stx, stx_get_node(&stx, term)), '-'), 0);
+
+	char buf[64] = {0};
+	EXPECT_EQ(stx_print(&stx, DST_BUF(buf)), 18);
+	EXPECT_STR(buf, "<name> ::= [_a-z]\n");
+	EXPECT_EQ(stx_print_tree(&stx, DST_BUF(buf)), 20);
+	EXPECT_STR(buf,
+		   "<name>\n"
+		   "└─[_a-z]\n");
+
+	char data[256] = {0};
+	size_t size = stx_save(&stx, data, sizeof(data));
+
+	stx_t load = {0};
+	stx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(stx_load(&load, data, size), 0);
+	EXPECT_EQ(stx_print(&load, DST_BUF(buf)), 18);
+	EXPECT_STR(buf, "<name> ::= [_a-z]\n");
+	stx_free(&load);
+
+	data[size - 8 - 32 - 4] = 31;
+	stx_init(&load, 1, ALLOC_STD);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	stx_free(&load);
+
+	stx_free(&stx);
+
+	END;
+}
+
 TEST(stx_find_rule)
 {
 	START;
@@ -225,6 +284,45 @@ TEST(stx_find_rule)
 	END;
 }
 
+TEST(stx_find_rule_many)
+{
+	START;
+
+	stx_t stx = {0};
+	stx_init(&stx, 128, ALLOC_STD);
+
+	char name[8] = {0};
+	for (int i = 0; i < 12; i++) {
+		stx_rule(&stx, STRVN(name, dputf(DST_BUF(name), "r%d", i)), NULL);
+	}
+
+	mem_oom(1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_rule(&stx, STRV("r12"), NULL), 1);
+	log_set_quiet(0, 0);
+	mem_oom(0);
+
+	for (int i = 12; i < 100; i++) {
+		stx_rule(&stx, STRVN(name, dputf(DST_BUF(name), "r%d", i)), NULL);
+	}
+
+	stx_node_t rule;
+	EXPECT_EQ(stx_rule(&stx, STRV("r5"), &rule), 0);
+	EXPECT_EQ(rule, 100);
+
+	stx_node_t got;
+	EXPECT_EQ(stx_find_rule(&stx, STRV("r5"), &got), 0);
+	EXPECT_EQ(got, 5);
+	EXPECT_EQ(stx_find_rule(&stx, STRV("r99"), &got), 0);
+	EXPECT_EQ(got, 99);
+	EXPECT_EQ(stx_find_rule(&stx, STRV("r100"), &got), 1);
+	EXPECT_EQ(stx.rules_cnt, 100);
+
+	stx_free(&stx);
+
+	END;
+}
+
 TEST(stx_get_node)
 {
 	START;
@@ -625,6 +723,75 @@ TEST(stx_print_invalid_rule)
 	END;
 }
 
+TEST(stx_save_load)
+{
+	START;
+
+	stx_t stx = {0};
+	stx_init(&stx, 16, ALLOC_STD);
+
+	stx_node_t rule, item, l, r;
+
+	stx_rule(&stx, STRV("list"), &rule);
+	stx_rule(&stx, STRV("item"), &item);
+	stx_term_rule(&stx, item, &l);
+	stx_term_lit(&stx, STRV(","), &r);
+	stx_rule_add_arr_sep(&stx, rule, l, r);
+	stx_term_lit(&stx, STRV("a"), &l);
+	stx_term_tok(&stx, TOK_DIGIT, &r);
+	stx_rule_add_or(&stx, item, 2, l, r);
+
+	size_t size = stx_save(&stx, NULL, 0);
+	EXPECT_EQ(size, 150);
+
+	char data[512] = {0};
+	EXPECT_EQ(stx_save(NULL, data, sizeof(data)), 0);
+	EXPECT_EQ(stx_save(&stx, data, 4), size);
+	EXPECT_EQ(stx_save(&stx, data, sizeof(data)), size);
+
+	stx_t load = {0};
+	stx_init(&load, 1, ALLOC_STD);
+
+	EXPECT_EQ(stx_load(NULL, data, size), 1);
+	EXPECT_EQ(stx_load(&load, NULL, size), 1);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, 8), 1);
+	log_set_quiet(0, 0);
+	data[0] = 0;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	stx_save(&stx, data, sizeof(data));
+	data[4] = 2;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+	data[4] = 1;
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, size - 1), 1);
+	log_set_quiet(0, 0);
+	stx_free(&load);
+	stx_init(&load, 1, ALLOC_STD);
+	EXPECT_EQ(stx_load(&load, data, size), 0);
+	log_set_quiet(0, 1);
+	EXPECT_EQ(stx_load(&load, data, size), 1);
+	log_set_quiet(0, 0);
+
+	char buf[256] = {0};
+	char exp[256] = {0};
+	stx_print(&stx, DST_BUF(exp));
+	EXPECT_EQ(stx_print(&load, DST_BUF(buf)), 61);
+	EXPECT_STR(buf, exp);
+	stx_print_tree(&stx, DST_BUF(exp));
+	stx_print_tree(&load, DST_BUF(buf));
+	EXPECT_STR(buf, exp);
+
+	stx_free(&load);
+	stx_free(&stx);
+
+	END;
+}
+
 STEST(stx)
 {
 	SSTART;
@@ -637,7 +804,9 @@ STEST(stx)
 	RUN(stx_term_lit_oom);
 	RUN(stx_term_tok);
 	RUN(stx_term_or);
+	RUN(stx_term_set);
 	RUN(stx_find_rule);
+	RUN(stx_find_rule_many);
 	RUN(stx_get_node);
 	RUN(stx_data_lit);
 	RUN(stx_add_term);
@@ -650,6 +819,7 @@ STEST(stx)
 	RUN(stx_print_tree);
 	RUN(stx_print_empty_rule);
 	RUN(stx_print_invalid_rule);
+	RUN(stx_save_load);
 
 	SEND;
 }
@@ -25,12 +25,52 @@ TEST(tok_type_enum)
 	END;
 }
 
+TEST(tok_set_add)
+{
+	START;
+
+	tok_set_t set = {0};
+
+	tok_set_add(NULL, 'a', 'z');
+	tok_set_add(&set, 'a', 'c');
+	tok_set_add(&set, 0xff, 0xff);
+
+	EXPECT_EQ(tok_set_has(NULL, 'a'), 0);
+	EXPECT_EQ(tok_set_has(&set, 'a'), 1);
+	EXPECT_EQ(tok_set_has(&set, 'c'), 1);
+	EXPECT_EQ(tok_set_has(&set, 'd'), 0);
+	EXPECT_EQ(tok_set_has(&set, 0xff), 1);
+
+	END;
+}
+
+TEST(tok_set_print)
+{
+	START;
+
+	tok_set_t set = {0};
+	tok_set_add(&set, 'a', 'z');
+	tok_set_add(&set, '0', '1');
+	tok_set_add(&set, '-', '-');
+	tok_set_add(&set, ']', ']');
+	tok_set_add(&set, '\n', '\n');
+
+	char buf[64] = {0};
+	EXPECT_EQ(tok_set_print(NULL, DST_BUF(buf)), 0);
+	EXPECT_EQ(tok_set_print(&set, DST_BUF(buf)), 15);
+	EXPECT_STR(buf, "[\\x0a\\-01\\]a-z]");
+
+	END;
+}
+
 STEST(tok)
 {
 	SSTART;
 
 	RUN(tok_type_print);
 	RUN(tok_type_enum);
+	RUN(tok_set_add);
+	RUN(tok_set_print);
 
 	SEND;
 }
@@ -0,0 +1,106 @@
+#include "egen.h"
+#include "file/cfg_prs.h"
+#include "mem.h"
+
+// Prints the files generated from the cfg grammar, they have to be regenerated whenever the grammar in cfg_prs_estx changes. Link
+// it against cparse and cutils and run it from the repository root:
+//
+//	cfg_gen estx > src/file/cfg_prs_estx.h
+//	cfg_gen c > test/t_egen_cfg.h
+//
+// The cfg_prs_estx and egen_c_cfg tests regenerate both and fail when the checked-in files differ.
+
+static int arg_eq(const char *arg, strv_t str)
+{
+	size_t len = 0;
+	while (arg[len]) {
+		len++;
+	}
+
+	return strv_eq(STRVN(arg, len), str);
+}
+
+// The table holds the analysis of the grammar too, so cfg_prs_init only has to load it
+static int gen_estx(estx_t *estx, estx_node_t file)
+{
+	if (estx_analyze(estx, file, DST_NONE())) {
+		return 1;
+	}
+
+	dputs(DST_STD(),
+	      STRV("#ifndef CFG_PRS_ESTX_H\n"
+		   "#define CFG_PRS_ESTX_H\n"
+		   "\n"
+		   "// Generated with tools/cfg_gen.c from cfg_prs_estx, do not edit\n"));
+
+	if (egen_estx(estx, STRV("cfg_prs_estx_tbl"), ALLOC_STD, DST_STD()) == 0) {
+		return 1;
+	}
+
+	dputs(DST_STD(), STRV("\n#endif\n"));
+	return 0;
+}
+
+// FNV-1a, egen_c_cfg computes the same hash to find out whether the header is stale
+static uint gen_hash(strv_t str)
+{
+	uint hash = 2166136261u;
+	for (size_t i = 0; i < str.len; i++) {
+		hash = (hash ^ (byte)str.data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+// The parser is compiled into the tests, which compare its trees with the ones of eprs_parse
+static int gen_c(const estx_t *estx, estx_node_t file)
+{
+	size_t size = 65536;
+	char *buf   = mem_alloc(size);
+	if (buf == NULL) {
+		return 1;
+	}
+
+	size_t len = egen_c(estx, file, STRV("cfgg"), DST_BUFN(buf, size));
+	if (len == 0 || len >= size) {
+		mem_free(buf, size);
+		return 1;
+	}
+
+	dputs(DST_STD(),
+	      STRV("#ifndef T_EGEN_CFG_H\n"
+		   "#define T_EGEN_CFG_H\n"
+		   "\n"
+		   "// Generated with tools/cfg_gen.c from cfg_prs_estx, do not edit\n"));
+	dputs(DST_STD(), STRVN(buf, len));
+	dputf(DST_STD(), "\n#define CFGG_HASH 0x%08xu\n", gen_hash(STRVN(buf, len)));
+	dputs(DST_STD(), STRV("\n#endif\n"));
+
+	mem_free(buf, size);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	c_print_init();
+
+	if (argc != 2 || !(arg_eq(argv[1], STRV("estx")) || arg_eq(argv[1], STRV("c")))) {
+		dputs(DST_STD(), STRV("usage: cfg_gen estx|c\n"));
+		return 1;
+	}
+
+	estx_t estx = {0};
+	if (cfg_prs_estx(&estx, ALLOC_STD) == NULL) {
+		return 1;
+	}
+
+	estx_node_t file;
+	int ret = estx_optimize(&estx) || estx_find_rule(&estx, STRV("file"), &file);
+	if (ret == 0) {
+		ret = arg_eq(argv[1], STRV("estx")) ? gen_estx(&estx, file) : gen_c(&estx, file);
+	}
+
+	estx_free(&estx);
+
+	return ret;
+}